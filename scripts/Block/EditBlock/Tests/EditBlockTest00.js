@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2011-2013 by Andrew Mustun. All rights reserved.
+ * 
+ * This file is part of the QCAD project.
+ *
+ * QCAD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QCAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QCAD.
+ */
+// File        : scripts/Block/EditBlock/Tests/EditBlockTest00.js
+// Description : block references stay indexed correctly after a block
+//               is edited in a drawing whose spatial index was loaded
+//               from the spatial index cache
+
+include('scripts/Pro/Developer/TestingDashboard/TdbTest.js');
+
+function EditBlockTest00() {
+    TdbTest.call(this, 'scripts/Block/EditBlock/Tests/EditBlockTest00.js');
+}
+
+EditBlockTest00.prototype = new TdbTest();
+
+EditBlockTest00.prototype.test00 = function() {
+    qDebug('running EditBlockTest00.test00()...');
+    var cache = RSettings.getBoolValue("SpatialIndex/Cache", false);
+    RSettings.setValue("SpatialIndex/Cache", true);
+
+    // first import writes the cache file:
+    this.setUp();
+    this.importFile('scripts/Block/EditBlock/Tests/data/blockref.dxf');
+    this.tearDown();
+
+    // second import loads the spatial index from the cache file:
+    this.setUp();
+    this.importFile('scripts/Block/EditBlock/Tests/data/blockref.dxf');
+
+    var di = EAction.getDocumentInterface();
+    var doc = di.getDocument();
+    var blockId = doc.getBlockId("B");
+    var refIds = doc.queryBlockReferences(blockId);
+    if (refIds.length!==1) {
+        throw new Error("EditBlockTest00: expected one block reference");
+    }
+
+    // move the line of block B from 0..10 to 100..110:
+    var ids = doc.queryBlockEntities(blockId);
+    var entity = doc.queryEntity(ids[0]);
+    entity.move(new RVector(100, 0));
+    di.applyOperation(new RModifyObjectOperation(entity));
+
+    var found = doc.queryIntersectedEntitiesXY(new RBox(new RVector(104, -1), new RVector(106, 1)));
+    if (found.indexOf(refIds[0])===-1) {
+        throw new Error("EditBlockTest00: block reference not found at new position");
+    }
+    found = doc.queryIntersectedEntitiesXY(new RBox(new RVector(4, -1), new RVector(6, 1)));
+    if (found.indexOf(refIds[0])!==-1) {
+        throw new Error("EditBlockTest00: block reference found at old position");
+    }
+
+    this.tearDown();
+    RSettings.setValue("SpatialIndex/Cache", cache);
+    qDebug('finished EditBlockTest00.test00()');
+};
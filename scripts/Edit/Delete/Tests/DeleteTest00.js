@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2011-2013 by Andrew Mustun. All rights reserved.
+ * 
+ * This file is part of the QCAD project.
+ *
+ * QCAD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QCAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QCAD.
+ */
+// File        : scripts/Edit/Delete/Tests/DeleteTest00.js
+// Description : bounding box of the drawing shrinks when the only
+//               horizontal line is deleted
+
+include('scripts/Pro/Developer/TestingDashboard/TdbTest.js');
+
+function DeleteTest00() {
+    TdbTest.call(this, 'scripts/Edit/Delete/Tests/DeleteTest00.js');
+}
+
+DeleteTest00.prototype = new TdbTest();
+
+DeleteTest00.prototype.test00 = function() {
+    qDebug('running DeleteTest00.test00()...');
+    this.setUp();
+    this.importFile('scripts/Edit/Delete/Tests/data/hline.dxf');
+
+    var di = EAction.getDocumentInterface();
+    var doc = di.getDocument();
+
+    // drawing bounding box is defined by the horizontal line in X and
+    // by the vertical line in Y:
+    var box = doc.getBoundingBox();
+    if (!box.getMinimum().equalsFuzzy(new RVector(0, -5)) ||
+        !box.getMaximum().equalsFuzzy(new RVector(10, 5))) {
+        throw new Error("DeleteTest00: unexpected bounding box: " + box);
+    }
+
+    var ids = doc.queryAllEntities();
+    for (var i=0; i<ids.length; i++) {
+        var entity = doc.queryEntity(ids[i]);
+        if (RMath.fuzzyCompare(entity.getStartPoint().y, entity.getEndPoint().y)) {
+            di.applyOperation(new RDeleteObjectOperation(entity));
+        }
+    }
+
+    box = doc.getBoundingBox();
+    if (!box.getMinimum().equalsFuzzy(new RVector(5, -5)) ||
+        !box.getMaximum().equalsFuzzy(new RVector(5, 5))) {
+        throw new Error("DeleteTest00: bounding box not updated: " + box);
+    }
+
+    this.tearDown();
+    qDebug('finished DeleteTest00.test00()');
+};
@@ -112,7 +112,13 @@ NewFile.createMdiChild = function(fileName, nameFilter) {
 
     // create document:
     var storage = new RMemoryStorage();
-    var spatialIndex = new RSpatialIndexNavel();
+    var spatialIndex;
+    if (RSettings.getStringValue("SpatialIndex/Implementation", "Navel")==="Flat") {
+        spatialIndex = new RSpatialIndexFlat();
+    }
+    else {
+        spatialIndex = new RSpatialIndexNavel();
+    }
     var document = new RDocument(storage, spatialIndex);
     var documentInterface = new RDocumentInterface(document);
 
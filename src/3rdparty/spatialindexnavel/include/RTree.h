@@ -90,6 +90,20 @@ namespace SpatialIndex
 			RTreeVariant rv,
 			id_type& indexIdentifier
 		);
+		// QCAD: bulk load with a node fill factor that differs from the
+		// minimum load (fill factor) used for subsequent updates:
+		SIDX_DLL ISpatialIndex* createAndBulkLoadNewRTree(
+			BulkLoadMethod m,
+			IDataStream& stream,
+			IStorageManager& sm,
+			double fillFactor,
+			double bulkLoadFillFactor,
+			size_t indexCapacity,
+			size_t leafCapacity,
+			size_t dimension,
+			RTreeVariant rv,
+			id_type& indexIdentifier
+		);
 		SIDX_DLL ISpatialIndex* loadRTree(IStorageManager& in, id_type indexIdentifier);
 	}
 }
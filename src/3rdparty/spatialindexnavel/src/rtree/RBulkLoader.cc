@@ -57,10 +57,17 @@ bool ExternalSorter::Record::operator<(const Record& r) const
 	if (m_s != r.m_s)
 		throw Tools::IllegalStateException("ExternalSorter::Record::operator<: Incompatible sorting dimensions.");
 
-	if (m_r.m_pHigh[m_s] + m_r.m_pLow[m_s] < r.m_r.m_pHigh[m_s] + r.m_r.m_pLow[m_s])
-		return true;
-	else
-		return false;
+	// QCAD: ties (e.g. all entries at z=0) are ordered by the previous
+	// sorting dimensions, so that nodes in a degenerate dimension are
+	// still spatially coherent:
+	for (int s = static_cast<int>(m_s); s >= 0; --s)
+	{
+		double c1 = m_r.m_pHigh[s] + m_r.m_pLow[s];
+		double c2 = r.m_r.m_pHigh[s] + r.m_r.m_pLow[s];
+		if (c1 < c2) return true;
+		if (c2 < c1) return false;
+	}
+	return false;
 }
 
 void ExternalSorter::Record::storeToFile(Tools::TemporaryFile& f)
@@ -195,14 +195,62 @@ SpatialIndex::ISpatialIndex* SpatialIndex::RTree::createAndBulkLoadNewRTree(
 
 	SpatialIndex::RTree::BulkLoader bl;
 
-	switch (m)
-	{
-	case BLM_STR:
-		bl.bulkLoadUsingSTR(static_cast<RTree*>(tree), stream, bindex, bleaf, 500, 2000);
-		break;
-	default:
-		throw Tools::IllegalArgumentException("createAndBulkLoadNewRTree: Unknown bulk load method.");
-		break;
+	try
+	{
+		switch (m)
+		{
+		case BLM_STR:
+			bl.bulkLoadUsingSTR(static_cast<RTree*>(tree), stream, bindex, bleaf, 500, 2000);
+			break;
+		default:
+			throw Tools::IllegalArgumentException("createAndBulkLoadNewRTree: Unknown bulk load method.");
+			break;
+		}
+	}
+	catch (...)
+	{
+		delete tree;
+		throw;
+	}
+
+	return tree;
+}
+
+SpatialIndex::ISpatialIndex* SpatialIndex::RTree::createAndBulkLoadNewRTree(
+	BulkLoadMethod m,
+	IDataStream& stream,
+	SpatialIndex::IStorageManager& sm,
+	double fillFactor,
+	double bulkLoadFillFactor,
+	size_t indexCapacity,
+	size_t leafCapacity,
+	size_t dimension,
+	SpatialIndex::RTree::RTreeVariant rv,
+	id_type& indexIdentifier)
+{
+	SpatialIndex::ISpatialIndex* tree = createNewRTree(sm, fillFactor, indexCapacity, leafCapacity, dimension, rv, indexIdentifier);
+
+	size_t bindex = static_cast<size_t>(std::floor(static_cast<double>(indexCapacity * bulkLoadFillFactor)));
+	size_t bleaf = static_cast<size_t>(std::floor(static_cast<double>(leafCapacity * bulkLoadFillFactor)));
+
+	SpatialIndex::RTree::BulkLoader bl;
+
+	try
+	{
+		switch (m)
+		{
+		case BLM_STR:
+			bl.bulkLoadUsingSTR(static_cast<RTree*>(tree), stream, bindex, bleaf, 500, 2000);
+			break;
+		default:
+			throw Tools::IllegalArgumentException("createAndBulkLoadNewRTree: Unknown bulk load method.");
+			break;
+		}
+	}
+	catch (...)
+	{
+		delete tree;
+		throw;
 	}
 
 	return tree;
@@ -112,8 +112,12 @@ double RBlockReferenceData::getDistanceTo(const RVector& point,
         return RNANDOUBLE;
     }
 
-    QSet<REntity::Id> ids =
-        document->queryBlockEntities(referencedBlockId);
+    // only entities within range can be closer than range:
+    RBox queryBox;
+    if (range>0.0) {
+        queryBox = RBox(point, range);
+    }
+    QSet<REntity::Id> ids = queryBlockEntities(queryBox);
     QSet<REntity::Id>::iterator it;
     double minDist = RMAXDOUBLE;
     for (it = ids.begin(); it != ids.end(); it++) {
@@ -170,6 +174,69 @@ RBox RBlockReferenceData::getBoundingBox() const {
     return boundingBox;
 }
 
+/**
+ * \return Box used for the spatial index entry of this block reference.
+ * This is the box of the referenced block as kept by the document
+ * (see \ref RDocument::getBlockBoundingBox), mapped to this reference.
+ * Unlike \ref getBoundingBox, it does not require transforming all
+ * entities of the block and it is not affected by changes inside the
+ * block that leave the extent of the block unchanged.
+ */
+QList<RBox> RBlockReferenceData::getBoundingBoxes() const {
+    if (document == NULL) {
+        return QList<RBox>() << getBoundingBox();
+    }
+
+    return QList<RBox>() << mapBlockBox(document->getBlockBoundingBox(referencedBlockId));
+}
+
+/**
+ * \return The given box in the coordinate system of the referenced block
+ * mapped to the coordinate system of this block reference. The result
+ * contains the transformed box but might be larger if the block
+ * reference is rotated.
+ */
+RBox RBlockReferenceData::mapBlockBox(const RBox& blockBox) const {
+    if (!blockBox.isValid() || document == NULL) {
+        return RBox();
+    }
+
+    QSharedPointer<RBlock> block = document->queryBlockDirect(referencedBlockId);
+    if (block.isNull()) {
+        return RBox();
+    }
+
+    QList<RVector> corners = blockBox.getCorners();
+    RVector::moveList(corners, -block->getOrigin());
+    RVector::scaleList(corners, scaleFactors);
+    RVector::rotateList(corners, rotation);
+    RVector::moveList(corners, position);
+
+    return RBox(RVector::getMinimum(corners), RVector::getMaximum(corners));
+}
+
+/**
+ * \return IDs of the entities of the referenced block that intersect
+ * with the given box (in the coordinate system of this block reference)
+ * or of all entities of the block if the box is invalid.
+ */
+QSet<REntity::Id> RBlockReferenceData::queryBlockEntities(const RBox& queryBox) const {
+    if (!queryBox.isValid() ||
+        fabs(scaleFactors.x)<RS::PointTolerance || fabs(scaleFactors.y)<RS::PointTolerance) {
+
+        return document->queryBlockEntities(referencedBlockId);
+    }
+
+    QList<RVector> corners = queryBox.getCorners2d();
+    RVector::moveList(corners, -position);
+    RVector::rotateList(corners, -rotation);
+    RVector::scaleList(corners, RVector(1.0/scaleFactors.x, 1.0/scaleFactors.y));
+
+    RBox queryBoxNeutral(RVector::getMinimum(corners), RVector::getMaximum(corners));
+
+    return document->queryIntersectedEntitiesXY(queryBoxNeutral, true, true, referencedBlockId);
+}
+
 /**
  * \return The entity with the given ID, transformed according to
  *     the transformation of this block reference.
@@ -297,20 +364,7 @@ QList<QSharedPointer<RShape> > RBlockReferenceData::getShapes(const RBox& queryB
     }
 
     // query entities in query box that are part of the block definition:
-    QSet<REntity::Id> ids;
-    if (queryBox.isValid()) {
-        QList<RVector> corners = queryBox.getCorners2d();
-        RVector::moveList(corners, -position);
-        RVector::rotateList(corners, -rotation);
-        RVector::scaleList(corners, RVector(1.0/scaleFactors.x, 1.0/scaleFactors.y));
-
-        RBox queryBoxNeutral(RVector::getMinimum(corners), RVector::getMaximum(corners));
-
-        ids = document->queryIntersectedEntitiesXY(queryBoxNeutral, true, true, referencedBlockId);
-    }
-    else {
-        ids = document->queryBlockEntities(referencedBlockId);
-    }
+    QSet<REntity::Id> ids = queryBlockEntities(queryBox);
 
     QSet<REntity::Id>::iterator it;
     for (it = ids.begin(); it != ids.end(); it++) {
@@ -48,6 +48,11 @@ public:
             const RVector& position, const RVector& scaleFactors, double angle);
 
     virtual RBox getBoundingBox() const;
+    virtual QList<RBox> getBoundingBoxes() const;
+    /**
+     * \nonscriptable
+     */
+    RBox mapBlockBox(const RBox& blockBox) const;
 
     virtual QList<RVector> getInternalReferencePoints(
         RS::ProjectionRenderingHint hint = RS::RenderTop) const;
@@ -124,6 +129,9 @@ public:
     QSharedPointer<REntity> queryEntity(REntity::Id entityId) const;
     bool applyTransformationTo(REntity& entity) const;
 
+private:
+    QSet<REntity::Id> queryBlockEntities(const RBox& queryBox) const;
+
 private:
     mutable RBlock::Id referencedBlockId;
     RVector position;
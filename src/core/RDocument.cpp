@@ -16,11 +16,15 @@
  * You should have received a copy of the GNU General Public License
  * along with QCAD.
  */
+#include <QtAlgorithms>
+#include <QDataStream>
+
 #include "RBox.h"
 #include "RDebug.h"
 #include "RDocument.h"
 #include "RLinkedStorage.h"
 #include "RMath.h"
+#include "RMemoryPool.h"
 #include "RMemoryStorage.h"
 #include "RSettings.h"
 #include "RSpatialIndexSimple.h"
@@ -31,6 +35,104 @@
 
 RDocument* RDocument::clipboard = NULL;
 
+namespace {
+
+/**
+ * Internal. Filters out entities that are undone, not on the given block,
+ * on a frozen layer, references to a frozen block, on a locked layer
+ * (unless \c includeLockedLayers is true) or of a type in \c filter.
+ *
+ * \return True if the given entity can be the result of a query.
+ */
+bool isQueryCandidate(const RDocument& document, const REntity& entity,
+        bool includeLockedLayers, RBlock::Id blockId,
+        const QList<RS::EntityType>& filter) {
+
+    // undone:
+    if (entity.isUndone()) {
+        return false;
+    }
+
+    // not on current or given block:
+    if (entity.getBlockId() != blockId) {
+        return false;
+    }
+
+    // layer is off:
+    if (document.isLayerFrozen(entity.getLayerId())) {
+        return false;
+    }
+
+    // referenced block is off:
+    const RBlockReferenceEntity* blockRef = dynamic_cast<const RBlockReferenceEntity*>(&entity);
+    if (blockRef!=NULL) {
+        RBlock::Id refBlockId = blockRef->getReferencedBlockId();
+        if (refBlockId!=RBlock::INVALID_ID) {
+            QSharedPointer<RBlock> block = document.queryBlockDirect(refBlockId);
+            if (!block.isNull() && block->isFrozen()) {
+                return false;
+            }
+        }
+    }
+
+    // layer is locked:
+    if (!includeLockedLayers) {
+        if (document.isLayerLocked(entity.getLayerId())) {
+            return false;
+        }
+    }
+
+    // apply filter:
+    if (filter.contains(entity.getType())) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Internal. Exact distance between a position and the entities of a
+ * document, used for nearest neighbor queries of the spatial index.
+ * Entities that are no query candidates are ignored.
+ */
+class RClosestEntityDistance : public RSpatialIndexDistanceFunction {
+public:
+    RClosestEntityDistance(const RDocument& document, const RVector& position,
+        double range, bool draft, bool includeLockedLayers, RBlock::Id blockId)
+        : document(document), position(position), range(range), draft(draft),
+          includeLockedLayers(includeLockedLayers), blockId(blockId) {}
+
+    virtual double getDistance(int id, int pos) {
+        Q_UNUSED(pos)
+
+        // entities with multiple bounding boxes are visited once per box:
+        QHash<REntity::Id, double>::const_iterator it = distances.constFind(id);
+        if (it!=distances.constEnd()) {
+            return it.value();
+        }
+
+        double dist = RNANDOUBLE;
+        QSharedPointer<REntity> entity = document.queryEntityDirect(id);
+        if (!entity.isNull() &&
+            isQueryCandidate(document, *entity, includeLockedLayers, blockId, QList<RS::EntityType>())) {
+            dist = entity->getDistanceTo(position, true, range, draft);
+        }
+        distances.insert(id, dist);
+        return dist;
+    }
+
+private:
+    const RDocument& document;
+    RVector position;
+    double range;
+    bool draft;
+    bool includeLockedLayers;
+    RBlock::Id blockId;
+    QHash<REntity::Id, double> distances;
+};
+
+}
+
 
 /**
  * Creates a new document with the given storage as back-end.
@@ -43,8 +145,11 @@ RDocument::RDocument(
     RSpatialIndex& spatialIndex)
     : storage(storage),
       spatialIndex(spatialIndex),
-      transactionStack(*this) {
+      transactionStack(*this),
+      spatialIndexDisabled(false),
+      modelSpaceBlockId(RBlock::INVALID_ID) {
 
+    storage.setDocument(this);
     init();
 }
 
@@ -242,16 +347,22 @@ void RDocument::clear() {
     fileName = "";
     storage.clear();
     spatialIndex.clear();
+    deleteBlockSpatialIndices();
     transactionStack.reset();
     RS::Unit u = getUnit();
     init();
     setUnit(u);
+    commitSpatialIndex();
 }
 
 
 RDocument::~RDocument() {
     storage.doDelete();
+    deleteBlockSpatialIndices();
     spatialIndex.doDelete();
+
+    // entities of this document might have been allocated from the pool:
+    RMemoryPool::release();
 }
 
 void RDocument::setUnit(RS::Unit unit) {
@@ -416,26 +527,12 @@ RBlock::Id RDocument::getCurrentBlockId() {
 }
 
 void RDocument::setCurrentBlock(RBlock::Id blockId) {
-    RBlock::Id prevBlockId = getCurrentBlockId();
-
-    RLinkedStorage* ls = dynamic_cast<RLinkedStorage*>(&storage);
-
-    // remove references to block we're entering from spatial index:
-    if (ls==NULL) {
-        //qDebug() << "RDocument::setCurrentBlock: removing block: " << blockId;
-    }
-    removeBlockFromSpatialIndex(blockId);
-    //rebuildSpatialIndex(oldBlockId);
-
+    // references to the block we're entering are in the spatial indexes of
+    // other blocks and are updated as the block changes
+    // (see updateBlockBoundingBoxes):
     storage.setCurrentBlock(blockId);
 
-    // add references to block we're leaving to spatial index:
-    if (prevBlockId!=RBlock::INVALID_ID) {
-        if (ls==NULL) {
-            //qDebug() << "RDocument::setCurrentBlock: adding block back on: " << prevBlockId;
-        }
-        addBlockToSpatialIndex(prevBlockId, blockId);
-    }
+    commitSpatialIndex();
 }
 
 void RDocument::setCurrentBlock(const QString& blockName) {
@@ -576,12 +673,183 @@ const RStorage& RDocument::getStorage() const {
 }
 
 /**
- * \return Reference to the spatial index.
+ * \return Reference to the spatial index of the model space block.
  */
 RSpatialIndex& RDocument::getSpatialIndex() {
     return spatialIndex;
 }
 
+/**
+ * \return Reference to the spatial index that contains the entities of
+ * the given block. The index is created if the block has none yet.
+ */
+RSpatialIndex& RDocument::getSpatialIndexForBlock(RBlock::Id blockId) {
+    if (blockId==modelSpaceBlockId || blockId==RBlock::INVALID_ID) {
+        return spatialIndex;
+    }
+
+    QHash<RBlock::Id, RSpatialIndex*>::const_iterator it =
+        spatialIndicesByBlock.constFind(blockId);
+    if (it!=spatialIndicesByBlock.constEnd()) {
+        return *it.value();
+    }
+
+    RSpatialIndex* si = spatialIndex.create();
+    spatialIndicesByBlock.insert(blockId, si);
+    return *si;
+}
+
+/**
+ * \return Reference to the spatial index of the current block.
+ */
+RSpatialIndex& RDocument::getSpatialIndexForCurrentBlock() {
+    return getSpatialIndexForBlock(getCurrentBlockId());
+}
+
+/**
+ * Internal. Like \ref getSpatialIndexForBlock but never creates an index,
+ * so queries of blocks without entities don't leave empty indexes behind.
+ *
+ * \return Spatial index of the given block or NULL if the block has no
+ * entities in the index.
+ */
+RSpatialIndex* RDocument::findSpatialIndexForBlock(RBlock::Id blockId) const {
+    if (blockId==modelSpaceBlockId || blockId==RBlock::INVALID_ID) {
+        return &spatialIndex;
+    }
+
+    return spatialIndicesByBlock.value(blockId, NULL);
+}
+
+/**
+ * Completes the spatial indexes of this document after a change, by
+ * updating the references to blocks whose entities have changed.
+ * Called at the end of every transaction, undo and redo.
+ */
+void RDocument::commitSpatialIndex() {
+    updateBlockBoundingBoxes();
+}
+
+void RDocument::deleteBlockSpatialIndices() {
+    QHash<RBlock::Id, RSpatialIndex*>::iterator it;
+    for (it=spatialIndicesByBlock.begin(); it!=spatialIndicesByBlock.end(); ++it) {
+        it.value()->doDelete();
+    }
+    spatialIndicesByBlock.clear();
+    blockBoundingBoxes.clear();
+    changedBlocks.clear();
+}
+
+/**
+ * \return Bounding box of the entities of the given block in block
+ * coordinates. References to the block are indexed with this box,
+ * mapped through their insertion transformation. The box is computed
+ * once and kept until entities of the block change.
+ */
+RBox RDocument::getBlockBoundingBox(RBlock::Id blockId) {
+    if (blockId==RBlock::INVALID_ID) {
+        return RBox();
+    }
+
+    QHash<RBlock::Id, RBox>::const_iterator it = blockBoundingBoxes.constFind(blockId);
+    if (it!=blockBoundingBoxes.constEnd()) {
+        return it.value();
+    }
+
+    // placeholder for (invalid) recursive block references:
+    blockBoundingBoxes.insert(blockId, RBox());
+
+    RBox ret;
+    QSet<REntity::Id> ids = queryBlockEntities(blockId);
+    QSet<REntity::Id>::iterator eit;
+    for (eit=ids.begin(); eit!=ids.end(); ++eit) {
+        QSharedPointer<REntity> entity = queryEntityDirect(*eit);
+        if (entity.isNull() || entity->isUndone()) {
+            continue;
+        }
+
+        // nested block references contribute the box they are indexed with:
+        if (entity->getType()==RS::EntityBlockRef) {
+            QList<RBox> bbs = entity->getBoundingBoxes();
+            for (int i=0; i<bbs.size(); i++) {
+                ret.growToInclude(bbs[i]);
+            }
+        }
+        else {
+            ret.growToInclude(entity->getBoundingBox());
+        }
+    }
+
+    blockBoundingBoxes.insert(blockId, ret);
+    return ret;
+}
+
+/**
+ * Marks the bounding box of the given block for re-evaluation
+ * in \ref updateBlockBoundingBoxes.
+ */
+void RDocument::invalidateBlockBoundingBox(RBlock::Id blockId) {
+    if (blockBoundingBoxes.contains(blockId)) {
+        changedBlocks.insert(blockId);
+    }
+}
+
+/**
+ * Re-evaluates the bounding boxes of all blocks with changed entities.
+ * References to a block are only re-indexed if the bounding box of
+ * the block has actually changed. Re-indexing references may in turn
+ * change the boxes of the blocks that contain them.
+ */
+void RDocument::updateBlockBoundingBoxes() {
+    // every block box can change at most once per nesting level:
+    int maxIterations = blockBoundingBoxes.size() * blockBoundingBoxes.size() + 1;
+    int iterations = 0;
+
+    while (!changedBlocks.isEmpty()) {
+        if (++iterations>maxIterations) {
+            qWarning() << "RDocument::updateBlockBoundingBoxes: "
+                << "recursive block references";
+            changedBlocks.clear();
+            break;
+        }
+
+        RBlock::Id blockId = *changedBlocks.begin();
+        changedBlocks.erase(changedBlocks.begin());
+
+        if (!blockBoundingBoxes.contains(blockId)) {
+            continue;
+        }
+
+        RBox oldBox = blockBoundingBoxes.take(blockId);
+        if (queryBlockDirect(blockId).isNull()) {
+            continue;
+        }
+
+        RBox newBox = getBlockBoundingBox(blockId);
+        if (newBox==oldBox) {
+            continue;
+        }
+
+        QSet<REntity::Id> blockRefIds = queryBlockReferences(blockId);
+        QSet<REntity::Id>::iterator it;
+        for (it=blockRefIds.begin(); it!=blockRefIds.end(); ++it) {
+            QSharedPointer<RBlockReferenceEntity> blockRef =
+                queryEntityDirect(*it).dynamicCast<RBlockReferenceEntity>();
+            if (blockRef.isNull()) {
+                continue;
+            }
+
+            // remove entry that was added with the previous block box:
+            QList<RBox> bbs;
+            bbs.append(blockRef->getData().mapBlockBox(oldBox));
+            getSpatialIndexForBlock(blockRef->getBlockId()).removeFromIndex(blockRef->getId(), bbs);
+
+            blockRef->update();
+            addToSpatialIndex(blockRef);
+        }
+    }
+}
+
 
 
 /**
@@ -685,6 +953,27 @@ QSet<REntity::Id> RDocument::queryBlockReferences(RBlock::Id blockId) const {
     return storage.queryBlockReferences(blockId);
 }
 
+/**
+ * \return Number of entities on the given layer in all blocks.
+ */
+int RDocument::getLayerEntityCount(RLayer::Id layerId) const {
+    return storage.getLayerEntityCount(layerId);
+}
+
+/**
+ * \return Number of entities in the given block.
+ */
+int RDocument::getBlockEntityCount(RBlock::Id blockId) const {
+    return storage.getBlockEntityCount(blockId);
+}
+
+/**
+ * \return Number of entities of the given type in all blocks.
+ */
+int RDocument::getEntityTypeCount(RS::EntityType type) const {
+    return storage.getEntityTypeCount(type);
+}
+
 QSet<REntity::Id> RDocument::queryAllBlockReferences() const {
     return storage.queryAllBlockReferences();
 }
@@ -699,6 +988,10 @@ QSet<REntity::Id> RDocument::queryViewEntities(RView::Id viewId) const {
  * Queries the one entity that is closest to the given position and
  * within the given range (2d).
  *
+ * The spatial index is searched best-first: exact distances are only
+ * computed for entities whose bounding box is closer to the position
+ * than the closest entity found so far.
+ *
  * \param wcsPosition The position to which the entity has to be close (2d).
  * \param range The range in which to search.
  */
@@ -708,23 +1001,17 @@ REntity::Id RDocument::queryClosestXY(
     bool draft,
     bool includeLockedLayers) {
 
-    RVector rangeV(
-        range,
-        range
-    );
-
-    // find entities that are within given maximum distance
-    //   (approximation based on bounding boxes):
-    QSet<REntity::Id> candidates =
-        queryIntersectedEntitiesXY(
-            RBox(
-                wcsPosition - rangeV,
-                wcsPosition + rangeV
-            ),
-            true, includeLockedLayers
-        );
+    RSpatialIndex* si = findSpatialIndexForBlock(getCurrentBlockId());
+    if (si==NULL) {
+        return REntity::INVALID_ID;
+    }
 
-    return queryClosestXY(candidates, wcsPosition, range, draft);
+    RClosestEntityDistance distanceFunction(
+        *this, wcsPosition, range, draft, includeLockedLayers, getCurrentBlockId()
+    );
+    return si->queryNearestNeighborXY(
+        wcsPosition.x, wcsPosition.y, range+RS::PointTolerance, distanceFunction
+    ).first;
 }
 
 /**
@@ -773,7 +1060,34 @@ REntity::Id RDocument::queryClosestXY(
  *      given area.
  */
 QSet<REntity::Id> RDocument::queryContainedEntities(const RBox& box) {
-    return spatialIndex.queryContained(box).keys().toSet();
+    RSpatialIndex* si = findSpatialIndexForBlock(getCurrentBlockId());
+    if (si==NULL) {
+        return QSet<REntity::Id>();
+    }
+
+    // block references are indexed with boxes that can be larger than
+    // their actual bounding box, so candidates are all intersected entities:
+    QVector<QPair<int, int> > candidates;
+    si->queryIntersected(box, candidates);
+
+    QSet<REntity::Id> ret;
+    for (int i=0; i<candidates.size(); i++) {
+        REntity::Id id = candidates[i].first;
+        if (ret.contains(id)) {
+            continue;
+        }
+
+        QSharedPointer<const REntity> entity = queryEntityConst(id);
+        if (entity.isNull() || entity->isUndone()) {
+            continue;
+        }
+
+        if (box.contains(entity->getBoundingBox())) {
+            ret.insert(id);
+        }
+    }
+
+    return ret;
 }
 
 
@@ -781,13 +1095,49 @@ QSet<REntity::Id> RDocument::queryIntersectedEntitiesXY(
         const RBox& box, bool checkBoundingBoxOnly, bool includeLockedLayers, RBlock::Id blockId,
         const QList<RS::EntityType>& filter) {
 
-    return queryIntersectedShapesXY(box, checkBoundingBoxOnly, includeLockedLayers, blockId, filter).keys().toSet();
+    QVector<REntity::Id> ids;
+    queryIntersectedXY(box, checkBoundingBoxOnly, includeLockedLayers, blockId, filter, &ids, NULL);
+
+    QSet<REntity::Id> ret;
+    ret.reserve(ids.size());
+    for (int i=0; i<ids.size(); i++) {
+        ret.insert(ids[i]);
+    }
+    return ret;
+}
+
+/**
+ * Queries all entities which intersect with the given box and appends
+ * their IDs to \c result. Unlike the other query functions, no set or
+ * map is built, so the caller can reuse \c result for many queries.
+ */
+void RDocument::queryIntersectedEntitiesXY(
+        QVector<REntity::Id>& result,
+        const RBox& box, bool checkBoundingBoxOnly, bool includeLockedLayers, RBlock::Id blockId,
+        const QList<RS::EntityType>& filter) {
+
+    queryIntersectedXY(box, checkBoundingBoxOnly, includeLockedLayers, blockId, filter, &result, NULL);
 }
 
 QMap<REntity::Id, QSet<int> > RDocument::queryIntersectedShapesXY(
         const RBox& box, bool checkBoundingBoxOnly, bool includeLockedLayers, RBlock::Id blockId,
         const QList<RS::EntityType>& filter) {
 
+    QMap<REntity::Id, QSet<int> > res;
+    queryIntersectedXY(box, checkBoundingBoxOnly, includeLockedLayers, blockId, filter, NULL, &res);
+    return res;
+}
+
+/**
+ * Internal. Queries all entities which intersect with the given box.
+ * IDs of matching entities are appended to \c ids, matching entities and
+ * shapes are inserted into \c shapes (if not NULL).
+ */
+void RDocument::queryIntersectedXY(
+        const RBox& box, bool checkBoundingBoxOnly, bool includeLockedLayers, RBlock::Id blockId,
+        const QList<RS::EntityType>& filter,
+        QVector<REntity::Id>* ids, QMap<REntity::Id, QSet<int> >* shapes) {
+
     RBox boxExpanded = box;
     boxExpanded.c1.z = RMINDOUBLE;
     boxExpanded.c2.z = RMAXDOUBLE;
@@ -800,21 +1150,29 @@ QMap<REntity::Id, QSet<int> > RDocument::queryIntersectedShapesXY(
 
     // box is completely outside the bounding box of this document:
     if (usingCurrentBlock && boxExpanded.isOutside(getBoundingBox())) {
-        return QMap<REntity::Id, QSet<int> >();
+        return;
     }
 
-    QMap<REntity::Id, QSet<int> > candidates;
+    // (ID, position) pairs, position -1 if unknown:
+    QVector<QPair<int, int> > candidates;
 
     // box is completely inside the bounding box of this document:
     if (usingCurrentBlock && boxExpanded.contains(getBoundingBox())) {
-        QSet<REntity::Id> ids = queryAllEntities(false, false);
+        QSet<REntity::Id> all = queryAllEntities(false, false);
+        candidates.reserve(all.size());
         QSet<REntity::Id>::iterator it;
-        for (it=ids.begin(); it!=ids.end(); it++) {
-            candidates.insert(*it, QSet<int>());
+        for (it=all.begin(); it!=all.end(); it++) {
+            candidates.append(qMakePair(*it, -1));
         }
     }
     else {
-        candidates = spatialIndex.queryIntersected(boxExpanded);
+        RSpatialIndex* si = findSpatialIndexForBlock(blockId);
+        if (si==NULL) {
+            return;
+        }
+        si->queryIntersected(boxExpanded, candidates);
+        // entities with multiple matching shapes are adjacent after sorting:
+        qSort(candidates.begin(), candidates.end());
     }
 
     RBox boxFlattened = box;
@@ -827,79 +1185,64 @@ QMap<REntity::Id, QSet<int> > RDocument::queryIntersectedShapesXY(
     pl.appendVertex(RVector(boxFlattened.c1.x, boxFlattened.c2.y));
     pl.appendVertex(boxFlattened.c1);
 
-    // filter out entities that don't intersect with the given box
-    // or are not on the current block or are on a frozen layer:
-    QMap<REntity::Id, QSet<int> > res;
-    //QSet<REntity::Id> outsiders;
-    QMap<REntity::Id, QSet<int> >::iterator it;
-    for (it=candidates.begin(); it!=candidates.end(); ++it) {
-        QSharedPointer<REntity> entity = queryEntityDirect(it.key());
-        if (entity.isNull()) {
-            //outsiders.insert(*it);
-            continue;
+    int i = 0;
+    while (i<candidates.size()) {
+        REntity::Id id = candidates[i].first;
+        int next = i+1;
+        while (next<candidates.size() && candidates[next].first==id) {
+            next++;
         }
 
-        // undone:
-        if (entity->isUndone()) {
-            //outsiders.insert(*it);
-            continue;
-        }
-
-        // not on current or given block:
-        if (entity->getBlockId() != blockId) {
-            //outsiders.insert(*it);
-            continue;
-        }
-
-        // layer is off:
-        if (isLayerFrozen(entity->getLayerId())) {
-            //outsiders.insert(*it);
-            continue;
-        }
-
-        // referenced block is off:
-        QSharedPointer<RBlockReferenceEntity> blockRef = entity.dynamicCast<RBlockReferenceEntity>();
-        if (!blockRef.isNull()) {
-            RBlock::Id blockId = blockRef->getReferencedBlockId();
-            if (blockId!=RBlock::INVALID_ID) {
-                QSharedPointer<RBlock> block = queryBlockDirect(blockId);
-                if (!block.isNull() && block->isFrozen()) {
-                    //outsiders.insert(*it);
-                    continue;
+        if (isIntersectedXY(id, boxExpanded, pl, checkBoundingBoxOnly,
+                            includeLockedLayers, blockId, filter)) {
+            if (ids!=NULL) {
+                ids->append(id);
+            }
+            if (shapes!=NULL) {
+                QSet<int>& positions = (*shapes)[id];
+                for (int k=i; k<next; k++) {
+                    if (candidates[k].second!=-1) {
+                        positions.insert(candidates[k].second);
+                    }
                 }
             }
         }
 
-        // layer is locked:
-        if (!includeLockedLayers) {
-            if (isLayerLocked(entity->getLayerId())) {
-                //outsiders.insert(*it);
-                continue;
-            }
-        }
+        i = next;
+    }
+}
 
-        // apply filter:
-        if (filter.contains(entity->getType())) {
-            //outsiders.insert(*it);
-            continue;
-        }
+/**
+ * Internal. Filters out entities that don't intersect with the given box
+ * or are no query candidates.
+ *
+ * \return True if the given entity is part of the result of an
+ * intersection query.
+ */
+bool RDocument::isIntersectedXY(
+        REntity::Id entityId, const RBox& boxExpanded, const RPolyline& pl,
+        bool checkBoundingBoxOnly, bool includeLockedLayers, RBlock::Id blockId,
+        const QList<RS::EntityType>& filter) {
 
-        if (boxExpanded.contains(entity->getBoundingBox())) {
-            res[it.key()] = it.value();
-            continue;
-        }
+    QSharedPointer<REntity> entity = queryEntityDirect(entityId);
+    if (entity.isNull()) {
+        return false;
+    }
 
-        if (!checkBoundingBoxOnly &&
-            !entity->intersectsWith(pl)) {
-            //outsiders.insert(*it);
-            continue;
-        }
+    if (!isQueryCandidate(*this, *entity, includeLockedLayers, blockId, filter)) {
+        return false;
+    }
 
-        res[it.key()] = it.value();
+    if (boxExpanded.contains(entity->getBoundingBox())) {
+        return true;
     }
 
-    return res;
-    //return candidates - outsiders;
+    if (!checkBoundingBoxOnly &&
+        !entity->intersectsWith(pl)) {
+        return false;
+    }
+
+    return true;
 }
 
 
@@ -907,54 +1250,62 @@ QSet<REntity::Id> RDocument::queryContainedEntitiesXY(const RBox& box) {
     RBox boxExpanded = box;
     boxExpanded.c1.z = RMINDOUBLE;
     boxExpanded.c2.z = RMAXDOUBLE;
-    QSet<REntity::Id> candidates = spatialIndex.queryContained(boxExpanded).keys().toSet();
+    QVector<QPair<int, int> > candidates;
+    RSpatialIndex* si = findSpatialIndexForBlock(getCurrentBlockId());
+    if (si!=NULL) {
+        // block references are indexed with boxes that can be larger than
+        // their actual bounding box, so candidates are all intersected
+        // entities:
+        si->queryIntersected(boxExpanded, candidates);
+    }
+    // entities with multiple matching boxes are adjacent after sorting:
+    qSort(candidates.begin(), candidates.end());
 
     // filter out entities that are not on the current block
-    // or whoes entire bounding box is not inside this query box
-    // (e.g. block references which add multiple bounding boxes to the index):
-    QSet<REntity::Id> outsiders;
-    QSet<REntity::Id>::iterator it;
-    for (it=candidates.begin(); it!=candidates.end(); ++it) {
-        QSharedPointer<REntity> entity = queryEntity(*it);
+    // or whoes entire bounding box is not inside this query box:
+    QSet<REntity::Id> ret;
+    for (int i=0; i<candidates.size(); i++) {
+        REntity::Id id = candidates[i].first;
+        if (i>0 && candidates[i-1].first==id) {
+            continue;
+        }
+
+        QSharedPointer<const REntity> entity = queryEntityConst(id);
         if (entity.isNull()) {
-            outsiders.insert(*it);
             continue;
         }
 
         // undone:
         if (entity->isUndone()) {
-            outsiders.insert(*it);
             continue;
         }
 
         // not on current block:
         if (entity->getBlockId() != getCurrentBlockId()) {
-            outsiders.insert(*it);
             continue;
         }
 
         // layer is off:
         if (isLayerFrozen(entity->getLayerId())) {
-            outsiders.insert(*it);
             continue;
         }
 
         // block is off:
-        QSharedPointer<RBlockReferenceEntity> blockRef = entity.dynamicCast<RBlockReferenceEntity>();
+        QSharedPointer<const RBlockReferenceEntity> blockRef = entity.dynamicCast<const RBlockReferenceEntity>();
         if (!blockRef.isNull()) {
             if (isBlockFrozen(blockRef->getReferencedBlockId())) {
-                outsiders.insert(*it);
                 continue;
             }
         }
 
         if (!boxExpanded.contains(entity->getBoundingBox())) {
-            outsiders.insert(*it);
             continue;
         }
+
+        ret.insert(id);
     }
 
-    return candidates - outsiders;
+    return ret;
 }
 
 
@@ -1017,6 +1368,16 @@ QSharedPointer<RObject> RDocument::queryObjectDirect(RObject::Id objectId) const
     return storage.queryObjectDirect(objectId);
 }
 
+/**
+ * Queries the object with the given ID for read-only access (no cloning).
+ * Use \ref queryObject to get a copy that can be modified.
+ *
+ * \return Pointer to the object or NULL.
+ */
+QSharedPointer<const RObject> RDocument::queryObjectConst(RObject::Id objectId) const {
+    return storage.queryObjectConst(objectId);
+}
+
 QSharedPointer<RObject> RDocument::queryObjectByHandle(RObject::Handle objectHandle) const {
     return storage.queryObjectByHandle(objectHandle);
 }
@@ -1041,6 +1402,16 @@ QSharedPointer<REntity> RDocument::queryEntityDirect(REntity::Id entityId) const
     return storage.queryEntityDirect(entityId);
 }
 
+/**
+ * Queries the entity with the given ID for read-only access (no cloning).
+ * Use \ref queryEntity to get a copy that can be modified.
+ *
+ * \return Pointer to the entity or NULL.
+ */
+QSharedPointer<const REntity> RDocument::queryEntityConst(REntity::Id entityId) const {
+    return storage.queryEntityConst(entityId);
+}
+
 
 
 /**
@@ -1082,6 +1453,15 @@ QSharedPointer<RLayer> RDocument::queryLayerDirect(RLayer::Id layerId) const {
     return storage.queryLayerDirect(layerId);
 }
 
+/**
+ * Queries the layer with the given ID for read-only access (no cloning).
+ *
+ * \return Pointer to the layer or NULL.
+ */
+QSharedPointer<const RLayer> RDocument::queryLayerConst(RLayer::Id layerId) const {
+    return storage.queryLayerConst(layerId);
+}
+
 /**
  * Queries the layer with the given name.
  *
@@ -1095,6 +1475,15 @@ QSharedPointer<RBlock> RDocument::queryBlockDirect(RBlock::Id blockId) const {
     return storage.queryBlockDirect(blockId);
 }
 
+/**
+ * Queries the block with the given ID for read-only access (no cloning).
+ *
+ * \return Pointer to the block or NULL.
+ */
+QSharedPointer<const RBlock> RDocument::queryBlockConst(RBlock::Id blockId) const {
+    return storage.queryBlockConst(blockId);
+}
+
 QSharedPointer<RBlock> RDocument::queryBlock(RBlock::Id blockId) const {
     return storage.queryBlock(blockId);
 }
@@ -1244,14 +1633,22 @@ RBox RDocument::getSelectionBox() {
 }
 
 /**
- * Rebuilds the entire spatial index from scratch (e.g. when current
- * block is changed).
+ * Rebuilds the spatial indexes of all blocks from scratch, each
+ * in one bulk load.
  */
 void RDocument::rebuildSpatialIndex() {
-    spatialIndex.clear();
+    if (spatialIndexDisabled) {
+        return;
+    }
+
+    blockBoundingBoxes.clear();
+    changedBlocks.clear();
 
     QSet<REntity::Id> result = storage.queryAllEntities(false, true);
 
+    QHash<RBlock::Id, QList<int> > ids;
+    QHash<RBlock::Id, QList<QList<RBox> > > bbs;
+
     QSetIterator<REntity::Id> i(result);
     while (i.hasNext()) {
         QSharedPointer<REntity> entity = storage.queryEntityDirect(i.next());
@@ -1262,38 +1659,114 @@ void RDocument::rebuildSpatialIndex() {
             continue;
         }
 
-        QList<RBox> bbs = entity->getBoundingBoxes();
+        RBlock::Id blockId = entity->getBlockId();
+        if (blockId==RBlock::INVALID_ID) {
+            blockId = modelSpaceBlockId;
+        }
+        ids[blockId].append(entity->getId());
+        bbs[blockId].append(entity->getBoundingBoxes());
+    }
 
-        spatialIndex.addToIndex(
-            entity->getId(),
-            bbs
-        );
+    // drop indexes of blocks without entities:
+    QHash<RBlock::Id, RSpatialIndex*>::iterator it = spatialIndicesByBlock.begin();
+    while (it!=spatialIndicesByBlock.end()) {
+        if (!ids.contains(it.key())) {
+            it.value()->doDelete();
+            it = spatialIndicesByBlock.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    if (!ids.contains(modelSpaceBlockId)) {
+        spatialIndex.clear();
     }
+
+    QHash<RBlock::Id, QList<int> >::const_iterator bit;
+    for (bit=ids.constBegin(); bit!=ids.constEnd(); ++bit) {
+        getSpatialIndexForBlock(bit.key()).bulkLoad(bit.value(), bbs.value(bit.key()));
+    }
+
+    commitSpatialIndex();
 }
 
-void RDocument::removeBlockFromSpatialIndex(RBlock::Id blockId) {
-    static int recursionDepth = 0;
-    recursionDepth++;
+/**
+ * Disables or enables \ref rebuildSpatialIndex. Used while importing a
+ * drawing whose spatial index is loaded from a cache afterwards.
+ */
+void RDocument::setSpatialIndexDisabled(bool on) {
+    spatialIndexDisabled = on;
+}
 
-    if (recursionDepth>16) {
-        recursionDepth--;
-        return;
+bool RDocument::isSpatialIndexDisabled() const {
+    return spatialIndexDisabled;
+}
+
+/**
+ * Writes the spatial indexes of all blocks to the given stream.
+ */
+bool RDocument::saveSpatialIndex(QDataStream& stream) {
+    stream << (qint32)(spatialIndicesByBlock.size()+1);
+
+    stream << (qint32)modelSpaceBlockId;
+    if (!spatialIndex.save(stream)) {
+        return false;
     }
 
-    // remove entry for block references to the block the entity belongs to:
-    QSet<REntity::Id> blockRefIds = queryBlockReferences(blockId);
-    QSet<REntity::Id>::iterator it;
-    for (it=blockRefIds.begin(); it!=blockRefIds.end(); it++) {
-        QSharedPointer<RBlockReferenceEntity> blockRef = queryEntityDirect(*it).dynamicCast<RBlockReferenceEntity>();
-        if (blockRef.isNull()) {
-            continue;
+    QHash<RBlock::Id, RSpatialIndex*>::iterator it;
+    for (it=spatialIndicesByBlock.begin(); it!=spatialIndicesByBlock.end(); ++it) {
+        stream << (qint32)it.key();
+        if (!it.value()->save(stream)) {
+            return false;
         }
+    }
+
+    return stream.status()==QDataStream::Ok;
+}
 
-        removeBlockFromSpatialIndex(blockRef->getBlockId());
-        removeFromSpatialIndex(blockRef);
+/**
+ * Replaces the spatial indexes of all blocks with the indexes written
+ * by \ref saveSpatialIndex for the same drawing.
+ *
+ * \return False if the stream is invalid or refers to unknown blocks.
+ * The spatial indexes are rebuilt in that case.
+ */
+bool RDocument::loadSpatialIndex(QDataStream& stream) {
+    spatialIndex.clear();
+    deleteBlockSpatialIndices();
+
+    qint32 count;
+    stream >> count;
+    bool ok = (stream.status()==QDataStream::Ok && count>0);
+
+    for (qint32 i=0; ok && i<count; i++) {
+        qint32 blockId;
+        stream >> blockId;
+        if (stream.status()!=QDataStream::Ok || queryBlockDirect(blockId).isNull()) {
+            ok = false;
+            break;
+        }
+        ok = getSpatialIndexForBlock(blockId).load(stream);
     }
 
-    recursionDepth--;
+    if (!ok) {
+        qWarning() << "RDocument::loadSpatialIndex: invalid spatial index data";
+        rebuildSpatialIndex();
+        return false;
+    }
+
+    // block references in the loaded indexes are indexed with the boxes
+    // of their blocks, which are needed to update them when blocks change:
+    QSet<RBlock::Id> blockIds = queryAllBlocks();
+    QSet<RBlock::Id>::iterator it;
+    for (it=blockIds.begin(); it!=blockIds.end(); ++it) {
+        if (*it!=modelSpaceBlockId) {
+            getBlockBoundingBox(*it);
+        }
+    }
+
+    commitSpatialIndex();
+    return true;
 }
 
 bool RDocument::blockContainsReferences(RBlock::Id blockId, RBlock::Id referencedBlockId) {
@@ -1328,45 +1801,10 @@ bool RDocument::blockContainsReferences(RBlock::Id blockId, RBlock::Id reference
     return false;
 }
 
-/**
- * Add block references that point to blockId, unless they also point to ignoreBlockId.
- */
-bool RDocument::addBlockToSpatialIndex(RBlock::Id blockId, RBlock::Id ignoreBlockId) {
-    if (blockContainsReferences(blockId, ignoreBlockId)) {
-        //qDebug() << "RDocument::addBlockToSpatialIndex: block " << getBlockName(blockId) << " contains " << getBlockName(ignoreBlockId);
-        return false;
-    }
-
-    // add entries for block references to the block the entity belongs to:
-    QSet<REntity::Id> blockRefIds = queryBlockReferences(blockId);
-    QSet<REntity::Id>::iterator it;
-    QSet<RBlock::Id> added;
-
-    for (it=blockRefIds.begin(); it!=blockRefIds.end(); it++) {
-        QSharedPointer<RBlockReferenceEntity> blockRef = queryEntityDirect(*it).dynamicCast<RBlockReferenceEntity>();
-        if (blockRef.isNull()) {
-            continue;
-        }
-
-        if (!added.contains(blockRef->getBlockId())) {
-            addBlockToSpatialIndex(blockRef->getBlockId(), ignoreBlockId);
-            added.insert(blockRef->getBlockId());
-        }
-        //if (!addBlockToSpatialIndex(blockRef->getBlockId(), ignoreBlockId)) {
-        //    return false;
-        //}
-
-        blockRef->update();
-        addToSpatialIndex(blockRef);
-    }
-
-    return true;
-}
-
-
 void RDocument::removeFromSpatialIndex(QSharedPointer<REntity> entity /*, REntity::Id subEntityId*/) {
     QList<RBox> bbs = entity->getBoundingBoxes(/*subEntityId*/);
-    bool ok = spatialIndex.removeFromIndex(entity->getId(), bbs);
+    bool ok = getSpatialIndexForBlock(entity->getBlockId()).removeFromIndex(entity->getId(), bbs);
+    invalidateBlockBoundingBox(entity->getBlockId());
     if (!ok) {
         qWarning() << "RDocument::removeFromSpatialIndex: removing entity: " << *entity;
         qWarning() << "failed to remove entity from spatial index";
@@ -1374,7 +1812,8 @@ void RDocument::removeFromSpatialIndex(QSharedPointer<REntity> entity /*, REntit
 }
 
 void RDocument::addToSpatialIndex(QSharedPointer<REntity> entity) {
-    spatialIndex.addToIndex(entity->getId(), entity->getBoundingBoxes());
+    getSpatialIndexForBlock(entity->getBlockId()).addToIndex(entity->getId(), entity->getBoundingBoxes());
+    invalidateBlockBoundingBox(entity->getBlockId());
 }
 
 
@@ -22,8 +22,10 @@
 
 #include "core_global.h"
 
+#include <QHash>
 #include <QString>
 #include <QSharedPointer>
+#include <QVector>
 
 #include "RBlock.h"
 #include "RBlockReferenceEntity.h"
@@ -37,6 +39,8 @@
 #include "RLinetype.h"
 #include "RView.h"
 
+class RPolyline;
+class QDataStream;
 class RVector;
 class RStorage;
 
@@ -69,6 +73,16 @@ public:
     RStorage& getStorage();
     const RStorage& getStorage() const;
     RSpatialIndex& getSpatialIndex();
+    RSpatialIndex& getSpatialIndexForBlock(RBlock::Id blockId);
+    RSpatialIndex& getSpatialIndexForCurrentBlock();
+    /**
+     * \nonscriptable
+     */
+    void commitSpatialIndex();
+    /**
+     * \nonscriptable
+     */
+    RBox getBlockBoundingBox(RBlock::Id blockId);
     RTransactionStack& getTransactionStack();
 
     void clear();
@@ -101,6 +115,10 @@ public:
     QSet<REntity::Id> queryBlockReferences(RBlock::Id blockId) const;
     QSet<REntity::Id> queryAllBlockReferences() const;
 
+    int getLayerEntityCount(RLayer::Id layerId) const;
+    int getBlockEntityCount(RBlock::Id blockId) const;
+    int getEntityTypeCount(RS::EntityType type) const;
+
     QSet<REntity::Id> queryContainedEntities(
         const RBox& box
     );
@@ -113,6 +131,18 @@ public:
             const QList<RS::EntityType>& filter = RDEFAULT_QLIST_RS_ENTITYTYPE
     );
 
+    /**
+     * \nonscriptable
+     */
+    void queryIntersectedEntitiesXY(
+            QVector<REntity::Id>& result,
+            const RBox& box,
+            bool checkBoundingBoxOnly=false,
+            bool includeLockedLayers=true,
+            RBlock::Id blockId = RBlock::INVALID_ID,
+            const QList<RS::EntityType>& filter = RDEFAULT_QLIST_RS_ENTITYTYPE
+    );
+
     QMap<REntity::Id, QSet<int> > queryIntersectedShapesXY(
         const RBox& box,
         bool checkBoundingBoxOnly=false,
@@ -129,16 +159,32 @@ public:
 
     QSharedPointer<RObject> queryObject(RObject::Id objectId) const;
     QSharedPointer<RObject> queryObjectDirect(RObject::Id objectId) const;
+    /**
+     * \nonscriptable
+     */
+    QSharedPointer<const RObject> queryObjectConst(RObject::Id objectId) const;
     QSharedPointer<RObject> queryObjectByHandle(RObject::Handle objectHandle) const;
     QSharedPointer<REntity> queryEntity(REntity::Id entityId) const;
     QSharedPointer<REntity> queryEntityDirect(REntity::Id entityId) const;
+    /**
+     * \nonscriptable
+     */
+    QSharedPointer<const REntity> queryEntityConst(REntity::Id entityId) const;
     QSharedPointer<RUcs> queryUcs(RUcs::Id ucsId) const;
     QSharedPointer<RUcs> queryUcs(const QString& ucsName) const;
     QSharedPointer<RLayer> queryLayer(RLayer::Id layerId) const;
     QSharedPointer<RLayer> queryLayerDirect(RLayer::Id layerId) const;
+    /**
+     * \nonscriptable
+     */
+    QSharedPointer<const RLayer> queryLayerConst(RLayer::Id layerId) const;
     QSharedPointer<RLayer> queryLayer(const QString& layerName) const;
     QSharedPointer<RBlock> queryBlock(RBlock::Id blockId) const;
     QSharedPointer<RBlock> queryBlockDirect(RBlock::Id blockId) const;
+    /**
+     * \nonscriptable
+     */
+    QSharedPointer<const RBlock> queryBlockConst(RBlock::Id blockId) const;
     QSharedPointer<RBlock> queryBlock(const QString& blockName) const;
     QSharedPointer<RView> queryView(RView::Id viewId) const;
     QSharedPointer<RView> queryView(const QString& viewName) const;
@@ -184,13 +230,27 @@ public:
 
     //void addToSpatialIndex(RObject& object, bool isNew = false);
     virtual void rebuildSpatialIndex();
+    /**
+     * \nonscriptable
+     */
+    void setSpatialIndexDisabled(bool on);
+    /**
+     * \nonscriptable
+     */
+    bool isSpatialIndexDisabled() const;
+    /**
+     * \nonscriptable
+     */
+    bool saveSpatialIndex(QDataStream& stream);
+    /**
+     * \nonscriptable
+     */
+    bool loadSpatialIndex(QDataStream& stream);
     //void addToSpatialIndex(QSharedPointer<REntity> entity);
     void addToSpatialIndex(QSharedPointer<REntity> entity);
 
     bool blockContainsReferences(RBlock::Id blockId, RBlock::Id referencedBlockId);
 
-    void removeBlockFromSpatialIndex(RBlock::Id blockId);
-    bool addBlockToSpatialIndex(RBlock::Id blockId, RObject::Id ignoreBlockId);
     virtual void removeFromSpatialIndex(QSharedPointer<REntity> entity);
     //virtual void removeFromSpatialIndex2(QSharedPointer<REntity> entity);
 
@@ -304,13 +364,43 @@ public:
 protected:
     static RDocument* clipboard;
 
+private:
+    RSpatialIndex* findSpatialIndexForBlock(RBlock::Id blockId) const;
+    void deleteBlockSpatialIndices();
+    void invalidateBlockBoundingBox(RBlock::Id blockId);
+    void updateBlockBoundingBoxes();
+    void queryIntersectedXY(
+            const RBox& box, bool checkBoundingBoxOnly, bool includeLockedLayers,
+            RBlock::Id blockId, const QList<RS::EntityType>& filter,
+            QVector<REntity::Id>* ids, QMap<REntity::Id, QSet<int> >* shapes);
+    bool isIntersectedXY(
+            REntity::Id entityId, const RBox& boxExpanded, const RPolyline& pl,
+            bool checkBoundingBoxOnly, bool includeLockedLayers,
+            RBlock::Id blockId, const QList<RS::EntityType>& filter);
+
 private:
     QString fileName;
     QString fileVersion;
 
     RStorage& storage;
     RSpatialIndex& spatialIndex;
+    /**
+     * Spatial indexes of all blocks other than model space, created
+     * on demand from the model space index.
+     */
+    QHash<RBlock::Id, RSpatialIndex*> spatialIndicesByBlock;
+    /**
+     * Bounding boxes of blocks in block coordinates, shared by the
+     * spatial index entries of all references to a block.
+     */
+    QHash<RBlock::Id, RBox> blockBoundingBoxes;
+    /**
+     * Blocks with entities that have changed since the last
+     * \ref updateBlockBoundingBoxes.
+     */
+    QSet<RBlock::Id> changedBlocks;
     RTransactionStack transactionStack;
+    bool spatialIndexDisabled;
     RBlock::Id modelSpaceBlockId;
     RLinetype::Id linetypeByLayerId;
     RLinetype::Id linetypeByBlockId;
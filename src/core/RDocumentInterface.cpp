@@ -47,6 +47,7 @@
 #include "RSnap.h"
 #include "RSnapRestriction.h"
 #include "RSpatialIndexSimple.h"
+#include "RSpatialIndexCache.h"
 #include "RSpline.h"
 #include "RTextLabel.h"
 #include "RTransaction.h"
@@ -956,7 +957,26 @@ RDocumentInterface::IoErrorCode RDocumentInterface::importFile(
     RDocumentInterface::IoErrorCode ret = RDocumentInterface::IoErrorNoError;
     QString previousFileName = document.getFileName();
     document.setFileName(fileName);
-    if (fileImporter->importFile(fileName, nameFilter)) {
+
+    // skip building the spatial index during the import if it can be
+    // loaded from the cache afterwards:
+    bool useCache = RSpatialIndexCache::isEnabled();
+    bool cacheValid = useCache && RSpatialIndexCache::isValid(document, fileName);
+    document.setSpatialIndexDisabled(cacheValid);
+
+    bool success = fileImporter->importFile(fileName, nameFilter);
+    document.setSpatialIndexDisabled(false);
+
+    if (success) {
+        if (cacheValid) {
+            if (!RSpatialIndexCache::load(document, fileName)) {
+                document.rebuildSpatialIndex();
+                RSpatialIndexCache::save(document, fileName);
+            }
+        }
+        else if (useCache) {
+            RSpatialIndexCache::save(document, fileName);
+        }
         document.setModified(false);
     } else {
         document.setFileName(previousFileName);
@@ -32,6 +32,7 @@
 #include "RLayer.h"
 #include "RLineweight.h"
 #include "RMatrix.h"
+#include "RMemoryPool.h"
 #include "RObject.h"
 #include "RPropertyAttributes.h"
 #include "RPropertyTypeId.h"
@@ -81,6 +82,22 @@ public:
     REntity(RDocument* document, Id objectId=-1) : RObject(document, objectId) {}
     virtual ~REntity();
 
+    /**
+     * Entities are allocated from the memory pool if it is enabled.
+     *
+     * \nonscriptable
+     */
+    static void* operator new(size_t size) {
+        return RMemoryPool::allocate(size);
+    }
+
+    /**
+     * \nonscriptable
+     */
+    static void operator delete(void* p, size_t size) {
+        RMemoryPool::deallocate(p, size);
+    }
+
     static void init();
 
     static QSet<RPropertyTypeId> getStaticPropertyTypeIds() {
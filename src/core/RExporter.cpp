@@ -1083,7 +1083,24 @@ void RExporter::exportEllipse(const REllipse& ellipse, double offset) {
     double aStep;         // Angle Step (rad)
     double a;             // Current Angle (rad)
 
-    aStep=0.05;
+    if (pixelSizeHint>0.0) {
+        // approximate ellipse with segments with a length of about
+        // 2 pixels along the major axis, like arcs:
+        aStep = pixelSizeHint * 2 / radius1;
+        if (aStep>1.0) {
+            aStep = 1.0;
+        }
+        double minAStep = 2*M_PI/360.0;
+        if (!draftMode) {
+            minAStep /= 4;
+        }
+        if (aStep<minAStep) {
+            aStep = minAStep;
+        }
+    }
+    else {
+        aStep = 0.05;
+    }
     RVector vp;
     RVector vc(cp.x, cp.y);
     vp.set(cp.x+cos(a1)*radius1,
@@ -733,7 +733,7 @@ RVector RGraphicsView::getClosestReferencePoint(
     if (getDocument() == NULL) {
         return ret;
     }
-    QSharedPointer<REntity> entity = getDocument()->queryEntity(entityId);
+    QSharedPointer<const REntity> entity = getDocument()->queryEntityConst(entityId);
     if (entity.isNull()) {
         return ret;
     }
@@ -23,6 +23,8 @@
 #include "RObject.h"
 #include "RStorage.h"
 #include "RMainWindow.h"
+#include "RMemoryPool.h"
+#include "RSettings.h"
 
 RImporter::RImporter() :
     document(NULL),
@@ -55,6 +57,9 @@ RImporter::~RImporter() {
  * implementation first since this starts a transaction.
  */
 void RImporter::startImport() {
+    if (RSettings::getBoolValue("Import/UseMemoryPool", false)) {
+        RMemoryPool::setEnabled(true);
+    }
 }
 
 /**
@@ -126,6 +131,11 @@ void RImporter::endImport() {
     }
 
     document->rebuildSpatialIndex();
+
+    // statistics of the pool are available through RMemoryPool::getStatistics:
+    if (RMemoryPool::isEnabled()) {
+        RMemoryPool::setEnabled(false);
+    }
 }
 
 void RImporter::setCurrentBlockId(RBlock::Id id) {
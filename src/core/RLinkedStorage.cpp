@@ -37,6 +37,34 @@ QSet<REntity::Id> RLinkedStorage::queryAllEntities(bool undone, bool allBlocks)
             .unite(backStorage->queryAllEntities(undone, allBlocks));
 }
 
+/**
+ * Entities might be in the back storage, so the draw order index of this
+ * storage cannot be used.
+ */
+QList<REntity::Id> RLinkedStorage::orderBackToFront(const QSet<REntity::Id>& entityIds) const {
+    return RStorage::orderBackToFront(entityIds);
+}
+
+void RLinkedStorage::orderBackToFront(QVector<REntity::Id>& entityIds) const {
+    RStorage::orderBackToFront(entityIds);
+}
+
+int RLinkedStorage::getMinDrawOrder() {
+    return RStorage::getMinDrawOrder();
+}
+
+int RLinkedStorage::getLayerEntityCount(RLayer::Id layerId) {
+    return RStorage::getLayerEntityCount(layerId);
+}
+
+int RLinkedStorage::getBlockEntityCount(RBlock::Id blockId) {
+    return RStorage::getBlockEntityCount(blockId);
+}
+
+int RLinkedStorage::getEntityTypeCount(RS::EntityType type) {
+    return RStorage::getEntityTypeCount(type);
+}
+
 QSet<RUcs::Id> RLinkedStorage::queryAllUcs() {
     return RMemoryStorage::queryAllUcs()
             .unite(backStorage->queryAllUcs());
@@ -375,6 +403,22 @@ bool RLinkedStorage::deleteObject(RObject::Id objectId) {
     return false;
 }
 
+void RLinkedStorage::setObjectHandle(RObject& object, RObject::Handle objectHandle) {
+    if (objectMap.contains(object.getId()) || backStorage->queryObjectDirect(object.getId()).isNull()) {
+        RMemoryStorage::setObjectHandle(object, objectHandle);
+        return;
+    }
+    backStorage->setObjectHandle(object, objectHandle);
+}
+
+void RLinkedStorage::setEntityParentId(REntity& entity, REntity::Id parentId) {
+    if (entityMap.contains(entity.getId())) {
+        RMemoryStorage::setEntityParentId(entity, parentId);
+        return;
+    }
+    backStorage->setEntityParentId(entity, parentId);
+}
+
 bool RLinkedStorage::setUndoStatus(RObject::Id objectId, bool status) {
     if (objectMap.contains(objectId)) {
         RMemoryStorage::setUndoStatus(objectId, status);
@@ -52,6 +52,10 @@ public:
     virtual QSet<RLinetype::Id> queryAllLinetypes();
     virtual QSet<REntity::Id> querySelectedEntities();
 
+    virtual QList<REntity::Id> orderBackToFront(const QSet<REntity::Id>& entityIds) const;
+    virtual void orderBackToFront(QVector<REntity::Id>& entityIds) const;
+    virtual int getMinDrawOrder();
+
     virtual QSet<REntity::Id> queryLayerEntities(RLayer::Id layerId, bool allBlocks = false);
     virtual QSet<REntity::Id> queryBlockEntities(RBlock::Id blockId);
     virtual QSet<REntity::Id> queryChildEntities(REntity::Id parentId, RS::EntityType type = RS::EntityAll);
@@ -59,6 +63,10 @@ public:
     virtual QSet<REntity::Id> queryBlockReferences(RBlock::Id blockId);
     virtual QSet<REntity::Id> queryAllBlockReferences();
 
+    virtual int getLayerEntityCount(RLayer::Id layerId);
+    virtual int getBlockEntityCount(RBlock::Id blockId);
+    virtual int getEntityTypeCount(RS::EntityType type);
+
     virtual QSharedPointer<RObject> queryObject(RObject::Id objectId) const;
     virtual QSharedPointer<REntity> queryEntity(REntity::Id objectId) const;
     virtual QSharedPointer<RObject> queryObjectByHandle(RObject::Handle objectHandle) const;
@@ -106,6 +114,8 @@ public:
     virtual RLinetype getCurrentLinetype() const;
 
     virtual bool deleteObject(RObject::Id objectId);
+    virtual void setObjectHandle(RObject& object, RObject::Handle objectHandle);
+    virtual void setEntityParentId(REntity& entity, REntity::Id parentId);
     virtual bool setUndoStatus(RObject::Id objectId, bool status);
 
     virtual bool isInBackStorage(RObject::Id object);
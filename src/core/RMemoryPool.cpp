@@ -0,0 +1,289 @@
+/**
+ * Copyright (c) 2011-2013 by Andrew Mustun. All rights reserved.
+ * 
+ * This file is part of the QCAD project.
+ *
+ * QCAD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QCAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QCAD.
+ */
+#include <new>
+
+#include <QMutexLocker>
+
+#include "RMemoryPool.h"
+
+QMutex RMemoryPool::mutex;
+volatile bool RMemoryPool::enabled = false;
+void* RMemoryPool::freeLists[RMemoryPool::maxBlockSize/RMemoryPool::granularity] = { NULL };
+QMap<char*, int> RMemoryPool::chunks;
+volatile int RMemoryPool::chunkCount = 0;
+char* RMemoryPool::chunkPos = NULL;
+char* RMemoryPool::chunkEnd = NULL;
+qint64 RMemoryPool::reservedBytes = 0;
+qint64 RMemoryPool::usedBytes = 0;
+qint64 RMemoryPool::peakUsedBytes = 0;
+qint64 RMemoryPool::blockCount = 0;
+
+/**
+ * Allocates a block of at least the given size. Blocks larger than the
+ * largest size class or allocations while the pool is disabled are
+ * forwarded to the global operator new.
+ */
+void* RMemoryPool::allocate(size_t size) {
+    if (!enabled || size > maxBlockSize) {
+        return ::operator new(size);
+    }
+
+    if (size==0) {
+        size = 1;
+    }
+
+    size_t cls = (size + granularity - 1) / granularity - 1;
+    size_t blockSize = (cls+1) * granularity;
+
+    QMutexLocker locker(&mutex);
+
+    char* b = static_cast<char*>(freeLists[cls]);
+    if (b!=NULL) {
+        freeLists[cls] = *reinterpret_cast<void**>(b);
+    }
+    else {
+        if (chunkPos==NULL || chunkPos + blockSize > chunkEnd) {
+            chunkPos = static_cast<char*>(allocateChunk());
+            chunkEnd = chunkPos + chunkSize;
+        }
+        b = chunkPos;
+        chunkPos += blockSize;
+    }
+
+    findChunk(b).value()++;
+    usedBytes += blockSize;
+    blockCount++;
+    if (usedBytes>peakUsedBytes) {
+        peakUsedBytes = usedBytes;
+    }
+
+    return b;
+}
+
+/**
+ * Frees the given block of the given size, previously allocated with
+ * \ref allocate.
+ */
+void RMemoryPool::deallocate(void* p, size_t size) {
+    if (p==NULL) {
+        return;
+    }
+
+    if (size > maxBlockSize || chunkCount==0) {
+        ::operator delete(p);
+        return;
+    }
+
+    if (size==0) {
+        size = 1;
+    }
+
+    char* b = static_cast<char*>(p);
+
+    QMutexLocker locker(&mutex);
+
+    QMap<char*, int>::iterator chunk = findChunk(b);
+    if (chunk==chunks.end()) {
+        locker.unlock();
+        ::operator delete(p);
+        return;
+    }
+
+    size_t cls = (size + granularity - 1) / granularity - 1;
+
+    *reinterpret_cast<void**>(b) = freeLists[cls];
+    freeLists[cls] = b;
+
+    chunk.value()--;
+    usedBytes -= (cls+1) * granularity;
+    blockCount--;
+
+    if (blockCount==0 && !enabled) {
+        releaseAll();
+    }
+}
+
+/**
+ * Enables or disables the pool for new allocations. If the pool is
+ * disabled and has no blocks in use, its memory is released.
+ */
+void RMemoryPool::setEnabled(bool on) {
+    QMutexLocker locker(&mutex);
+    enabled = on;
+    if (!enabled && blockCount==0) {
+        releaseAll();
+    }
+}
+
+bool RMemoryPool::isEnabled() {
+    return enabled;
+}
+
+/**
+ * Returns all chunks without blocks in use to the operating system.
+ */
+void RMemoryPool::release() {
+    if (chunkCount==0) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+
+    if (blockCount==0) {
+        releaseAll();
+        return;
+    }
+
+    bool unused = false;
+    QMap<char*, int>::iterator it;
+    for (it = chunks.begin(); it != chunks.end(); ++it) {
+        if (it.value()==0) {
+            unused = true;
+            break;
+        }
+    }
+    if (!unused) {
+        return;
+    }
+
+    // remove the blocks of unused chunks from the free lists:
+    for (size_t cls = 0; cls < maxBlockSize/granularity; cls++) {
+        void* list = NULL;
+        char* b = static_cast<char*>(freeLists[cls]);
+        while (b!=NULL) {
+            char* next = static_cast<char*>(*reinterpret_cast<void**>(b));
+            if (findChunk(b).value()>0) {
+                *reinterpret_cast<void**>(b) = list;
+                list = b;
+            }
+            b = next;
+        }
+        freeLists[cls] = list;
+    }
+
+    it = chunks.begin();
+    while (it != chunks.end()) {
+        if (it.value()>0) {
+            ++it;
+            continue;
+        }
+        if (chunkPos>=it.key() && chunkPos<=it.key() + chunkSize) {
+            chunkPos = NULL;
+            chunkEnd = NULL;
+        }
+        ::operator delete(it.key());
+        reservedBytes -= chunkSize;
+        chunkCount--;
+        it = chunks.erase(it);
+    }
+}
+
+/**
+ * \return Memory reserved by the pool in bytes.
+ */
+qint64 RMemoryPool::getReservedBytes() {
+    QMutexLocker locker(&mutex);
+    return reservedBytes;
+}
+
+/**
+ * \return Memory currently handed out by the pool in bytes.
+ */
+qint64 RMemoryPool::getUsedBytes() {
+    QMutexLocker locker(&mutex);
+    return usedBytes;
+}
+
+/**
+ * \return Maximum memory handed out by the pool at any time in bytes.
+ */
+qint64 RMemoryPool::getPeakUsedBytes() {
+    QMutexLocker locker(&mutex);
+    return peakUsedBytes;
+}
+
+/**
+ * \return Number of blocks currently handed out by the pool.
+ */
+qint64 RMemoryPool::getBlockCount() {
+    QMutexLocker locker(&mutex);
+    return blockCount;
+}
+
+/**
+ * \return Number of chunks reserved by the pool.
+ */
+qint64 RMemoryPool::getChunkCount() {
+    QMutexLocker locker(&mutex);
+    return chunkCount;
+}
+
+/**
+ * \return Human readable memory statistics of the pool.
+ */
+QString RMemoryPool::getStatistics() {
+    QMutexLocker locker(&mutex);
+    return QString("memory pool: %1 blocks, %2 KB used, %3 KB peak, %4 KB reserved in %5 chunks")
+        .arg(blockCount)
+        .arg(usedBytes/1024)
+        .arg(peakUsedBytes/1024)
+        .arg(reservedBytes/1024)
+        .arg(chunkCount);
+}
+
+void* RMemoryPool::allocateChunk() {
+    char* chunk = static_cast<char*>(::operator new(chunkSize));
+    chunks.insert(chunk, 0);
+    chunkCount++;
+    reservedBytes += chunkSize;
+    return chunk;
+}
+
+/**
+ * \return The chunk that contains the given block or chunks.end().
+ */
+QMap<char*, int>::iterator RMemoryPool::findChunk(char* b) {
+    QMap<char*, int>::iterator it = chunks.upperBound(b);
+    if (it==chunks.begin()) {
+        return chunks.end();
+    }
+    --it;
+    if (b >= it.key() + chunkSize) {
+        return chunks.end();
+    }
+    return it;
+}
+
+/**
+ * Releases all chunks. Only called if no blocks are in use.
+ */
+void RMemoryPool::releaseAll() {
+    QMap<char*, int>::iterator it;
+    for (it = chunks.begin(); it != chunks.end(); ++it) {
+        ::operator delete(it.key());
+    }
+    chunks.clear();
+    for (size_t cls = 0; cls < maxBlockSize/granularity; cls++) {
+        freeLists[cls] = NULL;
+    }
+    chunkCount = 0;
+    chunkPos = NULL;
+    chunkEnd = NULL;
+    reservedBytes = 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2011-2013 by Andrew Mustun. All rights reserved.
+ * 
+ * This file is part of the QCAD project.
+ *
+ * QCAD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QCAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QCAD.
+ */
+
+#ifndef RMEMORYPOOL_H
+#define RMEMORYPOOL_H
+
+#include "core_global.h"
+
+#include <cstddef>
+
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+/**
+ * Pool allocator for small objects (entities) that are allocated in large
+ * numbers, e.g. during the import of large drawings.
+ *
+ * Memory is reserved in chunks and handed out in size classes of 16 bytes.
+ * Freed blocks are kept on a free list of their size class and reused.
+ * Chunks without blocks in use are returned to the operating system by
+ * \ref release and when the last block of the pool is freed while the
+ * pool is disabled.
+ *
+ * The pool is disabled by default. While disabled, all allocations are
+ * forwarded to the global operator new without taking the lock of the
+ * pool. Blocks are identified as pool blocks by the address range of the
+ * chunks, so blocks that were allocated from the pool are always returned
+ * to the pool, regardless of whether the pool is enabled at that time.
+ * As long as the pool has no chunks, deallocations are also forwarded
+ * to the global operator delete without taking the lock.
+ *
+ * The pool is enabled during imports if the setting
+ * "Import/UseMemoryPool" is true.
+ *
+ * \ingroup core
+ * \scriptable
+ */
+class QCADCORE_EXPORT RMemoryPool {
+public:
+    /**
+     * \nonscriptable
+     */
+    static void* allocate(size_t size);
+    /**
+     * \nonscriptable
+     */
+    static void deallocate(void* p, size_t size);
+
+    static void setEnabled(bool on);
+    static bool isEnabled();
+
+    static void release();
+
+    static qint64 getReservedBytes();
+    static qint64 getUsedBytes();
+    static qint64 getPeakUsedBytes();
+    static qint64 getBlockCount();
+    static qint64 getChunkCount();
+
+    static QString getStatistics();
+
+private:
+    static void* allocateChunk();
+    static QMap<char*, int>::iterator findChunk(char* b);
+    static void releaseAll();
+
+private:
+    static const size_t granularity = 16;
+    static const size_t maxBlockSize = 512;
+    static const size_t chunkSize = 256*1024;
+
+    static QMutex mutex;
+    /**
+     * Only changed between imports, read without lock.
+     */
+    static volatile bool enabled;
+    static void* freeLists[maxBlockSize/granularity];
+    /**
+     * Chunks of the pool (start address -> number of blocks in use).
+     */
+    static QMap<char*, int> chunks;
+    /**
+     * Number of chunks, read without lock to skip the lookup of chunks
+     * while the pool has no chunks.
+     */
+    static volatile int chunkCount;
+    static char* chunkPos;
+    static char* chunkEnd;
+
+    static qint64 reservedBytes;
+    static qint64 usedBytes;
+    static qint64 peakUsedBytes;
+    static qint64 blockCount;
+};
+
+#endif
@@ -17,6 +17,8 @@
  * along with QCAD.
  */
 #include <QRegExp>
+#include <QVector>
+#include <QtAlgorithms>
 
 #include "RMemoryStorage.h"
 #include "RSettings.h"
@@ -25,7 +27,6 @@
 RMemoryStorage::RMemoryStorage() :
     maxLineweight(RLineweight::Weight000), 
     inTransaction(false), 
-    boundingBoxChanged(true),
     unit(RS::None),
     linetypeScale(1.0) {
 
@@ -40,13 +41,28 @@ void RMemoryStorage::clear() {
 
     maxLineweight = RLineweight::Weight000;
     inTransaction = false;
-    boundingBoxChanged = true;
-    boundingBox = RBox();
+    invalidateBoundingBoxes();
     objectMap.clear();
+    objectHandleMap.clear();
     entityMap.clear();
     blockEntityMap.clear();
     blockMap.clear();
     layerMap.clear();
+    layerEntityMap.clear();
+    childEntityMap.clear();
+    blockReferenceMap.clear();
+    selectedEntitySet.clear();
+    layerEntityCount.clear();
+    blockEntityCount.clear();
+    entityTypeCount.clear();
+    blockDrawOrderCount.clear();
+    drawOrderIndex.clear();
+    indexedEntityMap.clear();
+    layerNameMap.clear();
+    blockNameMap.clear();
+    viewNameMap.clear();
+    linetypeNameMap.clear();
+    indexedNameMap.clear();
     transactionMap.clear();
     variables.clear();
     variableCaseMap.clear();
@@ -57,24 +73,75 @@ void RMemoryStorage::clear() {
 
 void RMemoryStorage::setCurrentBlock(RBlock::Id blockId) {
     RStorage::setCurrentBlock(blockId);
-    boundingBoxChanged = true;
 }
 
-/*
-QList<REntity::Id> RMemoryStorage::orderBackToFront(const QSet<REntity::Id>& entityIds) {
-    QMap<int, REntity::Id> res;
+/**
+ * Orders the given entities by draw order using the draw order index.
+ * Large sets are collected by walking the (sorted) index, small sets
+ * are sorted by their indexed draw order.
+ */
+QList<REntity::Id> RMemoryStorage::orderBackToFront(const QSet<REntity::Id>& entityIds) const {
+    QList<REntity::Id> ret;
+    ret.reserve(entityIds.size());
+
+    if (entityIds.size()*4 > drawOrderIndex.size()) {
+        QMultiMap<int, REntity::Id>::const_iterator it;
+        for (it = drawOrderIndex.constBegin(); it != drawOrderIndex.constEnd(); ++it) {
+            if (entityIds.contains(it.value())) {
+                ret.append(it.value());
+            }
+        }
+        return ret;
+    }
+
+    QVector<QPair<int, REntity::Id> > sorted;
+    sorted.reserve(entityIds.size());
     QSet<REntity::Id>::const_iterator it;
-    maxDrawOrder = 0;
-    for (it = entityIds.begin(); it != entityIds.end(); ++it) {
-        QSharedPointer<REntity> e = queryEntityDirect(*it);
-        if (!e.isNull()) {
-            res.insertMulti(e->getDrawOrder(), *it);
-            maxDrawOrder = qMax(e->getDrawOrder(), maxDrawOrder);
+    for (it = entityIds.constBegin(); it != entityIds.constEnd(); ++it) {
+        QHash<REntity::Id, IndexedEntity>::const_iterator iit = indexedEntityMap.constFind(*it);
+        if (iit!=indexedEntityMap.constEnd()) {
+            sorted.append(qMakePair(iit->drawOrder, *it));
         }
     }
-    return res.values();
+    qSort(sorted.begin(), sorted.end());
+
+    for (int i=0; i<sorted.size(); i++) {
+        ret.append(sorted[i].second);
+    }
+    return ret;
+}
+
+/**
+ * Sorts the given IDs by their indexed draw order.
+ */
+void RMemoryStorage::orderBackToFront(QVector<REntity::Id>& entityIds) const {
+    QVector<QPair<int, REntity::Id> > sorted;
+    sorted.reserve(entityIds.size());
+    for (int i=0; i<entityIds.size(); i++) {
+        QHash<REntity::Id, IndexedEntity>::const_iterator iit = indexedEntityMap.constFind(entityIds[i]);
+        if (iit!=indexedEntityMap.constEnd()) {
+            sorted.append(qMakePair(iit->drawOrder, entityIds[i]));
+        }
+    }
+    qSort(sorted.begin(), sorted.end());
+
+    entityIds.resize(sorted.size());
+    for (int i=0; i<sorted.size(); i++) {
+        entityIds[i] = sorted[i].second;
+    }
+}
+
+/**
+ * \return Draw order below the lowest draw order of all entities in the
+ * current block, looked up in the draw orders of the block.
+ */
+int RMemoryStorage::getMinDrawOrder() {
+    QHash<RBlock::Id, QMap<int, int> >::const_iterator it = blockDrawOrderCount.constFind(getCurrentBlockId());
+    if (it==blockDrawOrderCount.constEnd() || it->isEmpty()) {
+        return getMaxDrawOrder() - 1;
+    }
+    return qMin(it->firstKey(), getMaxDrawOrder()) - 1;
 }
-*/
 
 bool RMemoryStorage::isSelected(REntity::Id entityId) {
     QSharedPointer<REntity> e = queryEntityDirect(entityId);
@@ -104,7 +171,6 @@ void RMemoryStorage::commitTransaction() {
     transactionObjectMap.clear();
     */
     inTransaction = false;
-    boundingBoxChanged = true;
 
     setModified(true);
 }
@@ -224,11 +290,10 @@ QSet<RLinetype::Id> RMemoryStorage::queryAllLinetypes() {
 QSet<REntity::Id> RMemoryStorage::querySelectedEntities() {
     RBlock::Id currentBlock = getCurrentBlockId();
     QSet<REntity::Id> result;
-    QHash<RObject::Id, QSharedPointer<REntity> >::iterator it;
-    for (it = entityMap.begin(); it != entityMap.end(); ++it) {
-        QSharedPointer<REntity> e = *it;
-        if (!e.isNull() && !e->isUndone() && e->isSelected() &&
-            e->getBlockId() == currentBlock) {
+    QSet<REntity::Id>::const_iterator it;
+    for (it = selectedEntitySet.constBegin(); it != selectedEntitySet.constEnd(); ++it) {
+        QSharedPointer<REntity> e = entityMap.value(*it);
+        if (!e.isNull() && !e->isUndone() && e->getBlockId() == currentBlock) {
             result.insert(e->getId());
         }
     }
@@ -236,12 +301,17 @@ QSet<REntity::Id> RMemoryStorage::querySelectedEntities() {
 }
 
 QSet<REntity::Id> RMemoryStorage::queryLayerEntities(RLayer::Id layerId, bool allBlocks) {
+    if (!layerEntityMap.contains(layerId)) {
+        return QSet<REntity::Id>();
+    }
+
     RBlock::Id currentBlock = getCurrentBlockId();
     QSet<REntity::Id> result;
-    QHash<RObject::Id, QSharedPointer<REntity> >::iterator it;
-    for (it = entityMap.begin(); it != entityMap.end(); ++it) {
-        QSharedPointer<REntity> e = *it;
-        if (!e.isNull() && e->getLayerId() == layerId && !e->isUndone()
+    const QSet<REntity::Id>& candidates = layerEntityMap[layerId];
+    QSet<REntity::Id>::const_iterator it;
+    for (it = candidates.constBegin(); it != candidates.constEnd(); ++it) {
+        QSharedPointer<REntity> e = entityMap.value(*it);
+        if (!e.isNull() && !e->isUndone()
                 && (allBlocks || e->getBlockId() == currentBlock)) {
             result.insert(e->getId());
         }
@@ -250,28 +320,34 @@ QSet<REntity::Id> RMemoryStorage::queryLayerEntities(RLayer::Id layerId, bool al
 }
 
 QSet<REntity::Id> RMemoryStorage::queryBlockEntities(RBlock::Id blockId) {
-    if (!blockEntityMap.contains(blockId)) {
+    QHash<RBlock::Id, QSet<REntity::Id> >::const_iterator bit = blockEntityMap.constFind(blockId);
+    if (bit==blockEntityMap.constEnd()) {
         return QSet<REntity::Id>();
     }
 
     QSet<REntity::Id> result;
-    QList<QSharedPointer<REntity> > candidates = blockEntityMap.values(blockId);
-    QList<QSharedPointer<REntity> >::iterator it;
-    for (it=candidates.begin(); it!=candidates.end(); it++) {
-        QSharedPointer<REntity> e = *it;
+    result.reserve(bit->size());
+    QSet<REntity::Id>::const_iterator it;
+    for (it=bit->constBegin(); it!=bit->constEnd(); it++) {
+        QSharedPointer<REntity> e = entityMap.value(*it);
         if (!e.isNull() && !e->isUndone()) {
-            result.insert(e->getId());
+            result.insert(*it);
         }
     }
     return result;
 }
 
 QSet<REntity::Id> RMemoryStorage::queryChildEntities(REntity::Id parentId, RS::EntityType type) {
-    QSet<REntity::Id> result; // = queryBlockEntities(blockRef->getReferencedBlockId());
-    QHash<RObject::Id, QSharedPointer<REntity> >::iterator it;
-    for (it = entityMap.begin(); it != entityMap.end(); ++it) {
-        QSharedPointer<REntity> e = *it;
-        if (e.isNull() || e->isUndone() || e->getParentId()!=parentId) {
+    if (!childEntityMap.contains(parentId)) {
+        return QSet<REntity::Id>();
+    }
+
+    QSet<REntity::Id> result;
+    const QSet<REntity::Id>& candidates = childEntityMap[parentId];
+    QSet<REntity::Id>::const_iterator it;
+    for (it = candidates.constBegin(); it != candidates.constEnd(); ++it) {
+        QSharedPointer<REntity> e = entityMap.value(*it);
+        if (e.isNull() || e->isUndone()) {
             continue;
         }
 
@@ -291,10 +367,15 @@ bool RMemoryStorage::hasChildEntities(REntity::Id parentId) {
 //        return false;
 //    }
 
-    QHash<RObject::Id, QSharedPointer<REntity> >::iterator it;
-    for (it = entityMap.begin(); it != entityMap.end(); ++it) {
-        QSharedPointer<REntity> e = *it;
-        if (e.isNull() || e->isUndone() || e->getParentId()!=parentId) {
+    if (!childEntityMap.contains(parentId)) {
+        return false;
+    }
+
+    const QSet<REntity::Id>& candidates = childEntityMap[parentId];
+    QSet<REntity::Id>::const_iterator it;
+    for (it = candidates.constBegin(); it != candidates.constEnd(); ++it) {
+        QSharedPointer<REntity> e = entityMap.value(*it);
+        if (e.isNull() || e->isUndone()) {
             continue;
         }
 
@@ -306,11 +387,16 @@ bool RMemoryStorage::hasChildEntities(REntity::Id parentId) {
 
 QSet<REntity::Id> RMemoryStorage::queryBlockReferences(RBlock::Id blockId) {
     QSet<REntity::Id> result;
-    QHash<RObject::Id, QSharedPointer<REntity> >::iterator it;
-    for (it = entityMap.begin(); it != entityMap.end(); ++it) {
-        QSharedPointer<RBlockReferenceEntity> e = it->dynamicCast<RBlockReferenceEntity>();
-        if (!e.isNull() && e->getReferencedBlockId() == blockId && !e->isUndone()) {
-            result.insert(e->getId());
+    QHash<RBlock::Id, QSet<REntity::Id> >::const_iterator bit = blockReferenceMap.constFind(blockId);
+    if (bit==blockReferenceMap.constEnd()) {
+        return result;
+    }
+
+    QSet<REntity::Id>::const_iterator it;
+    for (it = bit->constBegin(); it != bit->constEnd(); ++it) {
+        QSharedPointer<REntity> e = entityMap.value(*it);
+        if (!e.isNull() && !e->isUndone()) {
+            result.insert(*it);
         }
     }
     return result;
@@ -357,21 +443,15 @@ QSharedPointer<RObject> RMemoryStorage::queryObjectDirect(RObject::Id objectId)
 }
 
 QSharedPointer<RObject> RMemoryStorage::queryObjectByHandle(RObject::Handle objectHandle) const {
-    QSharedPointer<RObject> ret;
-
-    QHash<RObject::Id, QSharedPointer<RObject> >::const_iterator it;
-    for (it=objectMap.constBegin(); it!=objectMap.constEnd(); it++) {
-        QSharedPointer<RObject> obj = it.value();
-        if (obj.isNull()) {
-            continue;
-        }
-        if (obj->getHandle()==objectHandle) {
-            ret = QSharedPointer<RObject>(obj->clone());
-            break;
-        }
+    if (!objectHandleMap.contains(objectHandle)) {
+        return QSharedPointer<RObject>();
     }
 
-    return ret;
+    QSharedPointer<RObject> obj = objectMap.value(objectHandleMap.value(objectHandle));
+    if (obj.isNull()) {
+        return QSharedPointer<RObject>();
+    }
+    return QSharedPointer<RObject>(obj->clone());
 }
 
 QSharedPointer<REntity> RMemoryStorage::queryEntity(REntity::Id objectId) const {
@@ -409,14 +489,11 @@ QSharedPointer<RLayer> RMemoryStorage::queryLayer(RLayer::Id layerId) const {
 }
 
 QSharedPointer<RLayer> RMemoryStorage::queryLayer(const QString& layerName) const {
-    QHash<RObject::Id, QSharedPointer<RLayer> >::const_iterator it;
-    for (it = layerMap.constBegin(); it != layerMap.constEnd(); ++it) {
-        QSharedPointer<RLayer> l = *it;
-        if (!l.isNull() && l->getName().compare(layerName, Qt::CaseInsensitive)==0 && !l->isUndone()) {
-            return QSharedPointer<RLayer> (l->clone());
-        }
+    RLayer::Id id = RMemoryStorage::getLayerId(layerName);
+    if (id==RLayer::INVALID_ID) {
+        return QSharedPointer<RLayer>();
     }
-    return QSharedPointer<RLayer>();
+    return QSharedPointer<RLayer>(layerMap[id]->clone());
 }
 
 QSharedPointer<RBlock> RMemoryStorage::queryBlock(RBlock::Id blockId) const {
@@ -437,14 +514,11 @@ QSharedPointer<RBlock> RMemoryStorage::queryBlockDirect(RBlock::Id blockId) cons
 }
 
 QSharedPointer<RBlock> RMemoryStorage::queryBlock(const QString& blockName) const {
-    QHash<RObject::Id, QSharedPointer<RBlock> >::const_iterator it;
-    for (it = blockMap.constBegin(); it != blockMap.constEnd(); ++it) {
-        QSharedPointer<RBlock> b = *it;
-        if (!b.isNull() && b->getName().compare(blockName, Qt::CaseInsensitive)==0 && !b->isUndone()) {
-            return QSharedPointer<RBlock> (b->clone());
-        }
+    RBlock::Id id = RMemoryStorage::getBlockId(blockName);
+    if (id==RBlock::INVALID_ID) {
+        return QSharedPointer<RBlock>();
     }
-    return QSharedPointer<RBlock>();
+    return QSharedPointer<RBlock>(blockMap[id]->clone());
 }
 
 QString RMemoryStorage::getBlockName(RBlock::Id blockId) const {
@@ -501,14 +575,11 @@ QSharedPointer<RView> RMemoryStorage::queryView(RView::Id viewId) const {
 }
 
 QSharedPointer<RView> RMemoryStorage::queryView(const QString& viewName) const {
-    QHash<RObject::Id, QSharedPointer<RObject> >::const_iterator it;
-    for (it = objectMap.constBegin(); it != objectMap.constEnd(); ++it) {
-        QSharedPointer<RView> l = it->dynamicCast<RView>();
-        if (!l.isNull() && l->getName() == viewName && !l->isUndone()) {
-            return QSharedPointer<RView> (l->clone());
-        }
+    RView::Id id = RMemoryStorage::getViewId(viewName);
+    if (id==RView::INVALID_ID) {
+        return QSharedPointer<RView>();
     }
-    return QSharedPointer<RView>();
+    return QSharedPointer<RView>((RView*)objectMap[id]->clone());
 }
 
 QSharedPointer<RUcs> RMemoryStorage::queryUcsDirect(RUcs::Id ucsId) const {
@@ -542,15 +613,11 @@ QSharedPointer<RLinetype> RMemoryStorage::queryLinetype(RLinetype::Id linetypeId
 }
 
 QSharedPointer<RLinetype> RMemoryStorage::queryLinetype(const QString& linetypeName) const {
-    QHash<RObject::Id, QSharedPointer<RObject> >::const_iterator it;
-    for (it = objectMap.constBegin(); it != objectMap.constEnd(); ++it) {
-        QSharedPointer<RLinetype> l = it->dynamicCast<RLinetype>();
-        if (!l.isNull() && l->getName().compare(linetypeName, Qt::CaseInsensitive)==0) {
-            return l;
-        }
+    RLinetype::Id id = RMemoryStorage::getLinetypeId(linetypeName);
+    if (id==RLinetype::INVALID_ID) {
+        return QSharedPointer<RLinetype>();
     }
-
-    return QSharedPointer<RLinetype>();
+    return objectMap[id].dynamicCast<RLinetype>();
 }
 
 void RMemoryStorage::selectAllEntites(QSet<REntity::Id>* affectedEntities) {
@@ -572,9 +639,11 @@ void RMemoryStorage::selectAllEntites(QSet<REntity::Id>* affectedEntities) {
 }
 
 void RMemoryStorage::clearEntitySelection(QSet<REntity::Id>* affectedEntities) {
-    QHash<RObject::Id, QSharedPointer<REntity> >::iterator it;
-    for (it = entityMap.begin(); it != entityMap.end(); ++it) {
-        QSharedPointer<REntity> e = *it;
+    // iterate over a copy, the selection set changes while deselecting:
+    QSet<REntity::Id> ids = selectedEntitySet;
+    QSet<REntity::Id>::iterator it;
+    for (it = ids.begin(); it != ids.end(); ++it) {
+        QSharedPointer<REntity> e = entityMap.value(*it);
         if (!e.isNull() && e->isSelected()) {
 //            if (affectedEntities!=NULL) {
 //                affectedEntities->insert(e->getId());
@@ -606,9 +675,10 @@ void RMemoryStorage::selectEntities(const QSet<REntity::Id>& entityIds,
 
     if (!add) {
         // deselect all first:
-        QHash<RObject::Id, QSharedPointer<REntity> >::iterator it;
-        for (it = entityMap.begin(); it != entityMap.end(); ++it) {
-            QSharedPointer<REntity> e = *it;
+        QSet<REntity::Id> ids = selectedEntitySet;
+        QSet<REntity::Id>::iterator it;
+        for (it = ids.begin(); it != ids.end(); ++it) {
+            QSharedPointer<REntity> e = entityMap.value(*it);
             if (!e.isNull() && e->isSelected() &&
                 !entityIds.contains(e->getId())) {
 
@@ -650,6 +720,14 @@ void RMemoryStorage::setEntitySelected(QSharedPointer<REntity> entity, bool on,
 //    }
 
     entity->setSelected(on);
+    if (entityMap.value(entity->getId())==entity) {
+        if (on) {
+            selectedEntitySet.insert(entity->getId());
+        }
+        else {
+            selectedEntitySet.remove(entity->getId());
+        }
+    }
     if (affectedEntities!=NULL) {
         affectedEntities->insert(entity->getId());
     }
@@ -683,11 +761,10 @@ void RMemoryStorage::deselectEntities(const QSet<REntity::Id>& entityIds,
 
 bool RMemoryStorage::hasSelection() const {
     RBlock::Id currentBlock = getCurrentBlockId();
-    QHash<RObject::Id, QSharedPointer<REntity> >::const_iterator it;
-    for (it = entityMap.begin(); it != entityMap.end(); ++it) {
-        QSharedPointer<REntity> e = *it;
-        if (!e.isNull() && !e->isUndone() && e->isSelected() &&
-            e->getBlockId() == currentBlock) {
+    QSet<REntity::Id>::const_iterator it;
+    for (it = selectedEntitySet.constBegin(); it != selectedEntitySet.constEnd(); ++it) {
+        QSharedPointer<REntity> e = entityMap.value(*it);
+        if (!e.isNull() && !e->isUndone() && e->getBlockId() == currentBlock) {
             return true;
         }
     }
@@ -695,62 +772,238 @@ bool RMemoryStorage::hasSelection() const {
     return false;
 }
 
+/**
+ * \param includeHiddenLayer True to return the bounding box of all entities
+ * on layers that are not frozen, false to return the bounding box of all
+ * entities.
+ */
 RBox RMemoryStorage::getBoundingBox(bool includeHiddenLayer) {
-    if (!boundingBoxChanged) {
-        return boundingBox;
+    RBlock::Id currentBlockId = getCurrentBlockId();
+    if (!boundingBoxMap.contains(currentBlockId)) {
+        updateBoundingBox(currentBlockId);
     }
 
-    RBlock::Id currentBlockId = getCurrentBlockId();
-    boundingBox = RBox();
-    maxLineweight = RLineweight::Weight000;
-    QHash<RObject::Id, QSharedPointer<REntity> >::iterator it;
-    for (it = entityMap.begin(); it != entityMap.end(); ++it) {
-        QSharedPointer<REntity> e = *it;
+    maxLineweight = maxLineweightMap.value(currentBlockId);
+
+    if (includeHiddenLayer) {
+        return visibleBoundingBoxMap.value(currentBlockId);
+    }
+    return boundingBoxMap.value(currentBlockId);
+}
+
+/**
+ * Recomputes the bounding boxes and maximum lineweight of the given block
+ * from the entities in that block.
+ */
+void RMemoryStorage::updateBoundingBox(RBlock::Id blockId) {
+    RBox box;
+    RBox visibleBox;
+    RLineweight::Lineweight lw = RLineweight::Weight000;
+    QMap<RLineweight::Lineweight, int> lineweights;
+
+    QSet<REntity::Id> ids = blockEntityMap.value(blockId);
+    QSet<REntity::Id>::const_iterator it;
+    for (it = ids.constBegin(); it != ids.constEnd(); ++it) {
+        QSharedPointer<REntity> e = entityMap.value(*it);
         if (e.isNull() || e->isUndone()) {
             continue;
         }
 
-        if (includeHiddenLayer) {
-            QSharedPointer<RLayer> layer = queryLayerDirect(e->getLayerId());
-            if (layer.isNull() || layer->isFrozen()) {
-                continue;
-            }
-        }
+        RBox b = e->getBoundingBox();
+        box.growToInclude(b);
 
-        if (e->getBlockId() == currentBlockId) {
-            boundingBox.growToInclude(e->getBoundingBox());
+        QSharedPointer<RLayer> layer = queryLayerDirect(e->getLayerId());
+        if (layer.isNull() || layer->isFrozen()) {
+            continue;
         }
 
-        // resolve line width ByLayer:
-        //QSharedPointer<RLayer> layer =
-        //        queryLayerDirect(e->getLayerId());
+        visibleBox.growToInclude(b);
 
         // don't resolve block references, if line weight is ByBlock,
         // the maxLinewidth will be adjusted when the block reference
         // is encountered:
         QStack<RBlockReferenceEntity*> blockRefStack;
+        RLineweight::Lineweight entityLw = e->getLineweight(true, blockRefStack);
+        lineweights[entityLw]++;
+        lw = qMax(lw, entityLw);
+    }
+
+    boundingBoxMap.insert(blockId, box);
+    visibleBoundingBoxMap.insert(blockId, visibleBox);
+    maxLineweightMap.insert(blockId, lw);
+    lineweightCountMap.insert(blockId, lineweights);
+}
+
+/**
+ * Grows the cached bounding box of the block of the given entity to
+ * include the entity.
+ */
+void RMemoryStorage::addToBoundingBox(QSharedPointer<REntity> entity) {
+    if (entity->isUndone()) {
+        return;
+    }
+
+    RBlock::Id blockId = entity->getBlockId();
+
+    // block references to this block (in other blocks) change as well:
+    invalidateReferencingBoundingBoxes(blockId);
+
+    if (!boundingBoxMap.contains(blockId)) {
+        // recomputed on demand:
+        return;
+    }
+
+    RBox b = entity->getBoundingBox();
+    boundingBoxMap[blockId].growToInclude(b);
+
+    QSharedPointer<RLayer> layer = queryLayerDirect(entity->getLayerId());
+    if (layer.isNull() || layer->isFrozen()) {
+        return;
+    }
+
+    visibleBoundingBoxMap[blockId].growToInclude(b);
+
+    QStack<RBlockReferenceEntity*> blockRefStack;
+    RLineweight::Lineweight lw = entity->getLineweight(true, blockRefStack);
+    lineweightCountMap[blockId][lw]++;
+    if (lw > maxLineweightMap.value(blockId)) {
+        maxLineweightMap.insert(blockId, lw);
+    }
+}
+
+/**
+ * \return True if the given box lies strictly inside the given hull, i.e.
+ * removing it cannot shrink the hull. A box that touches any edge of the
+ * hull in X or Y is never inside, also if the hull has no extent on that
+ * axis. In Z, a flat hull (2D drawing) cannot shrink.
+ */
+static bool isInsideHull(const RBox& box, const RBox& hull) {
+    RVector bMin = box.getMinimum();
+    RVector bMax = box.getMaximum();
+    RVector hMin = hull.getMinimum();
+    RVector hMax = hull.getMaximum();
+
+    return bMin.x > hMin.x && bMax.x < hMax.x &&
+           bMin.y > hMin.y && bMax.y < hMax.y &&
+           ((bMin.z > hMin.z && bMax.z < hMax.z) || hMin.z==hMax.z);
+}
+
+/**
+ * Updates the cached bounding box of the block of the given entity for the
+ * removal of the entity. Only if the entity touches the bounding box, the
+ * block is recomputed (on demand). If the entity is the last one with the
+ * maximum lineweight, the maximum lineweight is taken from the remaining
+ * lineweights of the block.
+ */
+void RMemoryStorage::removeFromBoundingBox(QSharedPointer<REntity> entity) {
+    if (entity->isUndone()) {
+        return;
+    }
+
+    RBlock::Id blockId = entity->getBlockId();
+
+    // block references to this block (in other blocks) change as well:
+    invalidateReferencingBoundingBoxes(blockId);
+
+    if (!boundingBoxMap.contains(blockId)) {
+        return;
+    }
+
+    QSharedPointer<RLayer> layer = queryLayerDirect(entity->getLayerId());
+    bool visible = !layer.isNull() && !layer->isFrozen();
+
+    RBox b = entity->getBoundingBox();
+    if (b.isValid() &&
+        (!isInsideHull(b, boundingBoxMap[blockId]) ||
+         (visible && !isInsideHull(b, visibleBoundingBoxMap[blockId])))) {
+
+        invalidateBoundingBox(blockId);
+        return;
+    }
 
-        RLineweight::Lineweight lw =
-                e->getLineweight(true, blockRefStack);
-        if (!boundingBox.isValid()) {
-            maxLineweight = lw;
-        } else {
-            maxLineweight = qMax(lw, maxLineweight);
+    if (!visible) {
+        return;
+    }
+
+    QStack<RBlockReferenceEntity*> blockRefStack;
+    RLineweight::Lineweight lw = entity->getLineweight(true, blockRefStack);
+
+    QMap<RLineweight::Lineweight, int>& lineweights = lineweightCountMap[blockId];
+    QMap<RLineweight::Lineweight, int>::iterator it = lineweights.find(lw);
+    if (it==lineweights.end()) {
+        // entity was not counted:
+        invalidateBoundingBox(blockId);
+        return;
+    }
+
+    it.value()--;
+    if (it.value()>0) {
+        return;
+    }
+
+    lineweights.erase(it);
+    if (lineweights.isEmpty()) {
+        maxLineweightMap.insert(blockId, RLineweight::Weight000);
+    }
+    else {
+        maxLineweightMap.insert(blockId, qMax(RLineweight::Weight000, lineweights.lastKey()));
+    }
+}
+
+/**
+ * Invalidates the cached bounding boxes of the given block.
+ */
+void RMemoryStorage::invalidateBoundingBox(RBlock::Id blockId) {
+    boundingBoxMap.remove(blockId);
+    visibleBoundingBoxMap.remove(blockId);
+    maxLineweightMap.remove(blockId);
+    lineweightCountMap.remove(blockId);
+}
+
+/**
+ * Invalidates the cached bounding boxes of all blocks that contain a
+ * reference to the given block, directly or through other blocks.
+ */
+void RMemoryStorage::invalidateReferencingBoundingBoxes(RBlock::Id blockId) {
+    if (!blockReferenceMap.contains(blockId)) {
+        return;
+    }
+
+    QSet<RBlock::Id> done;
+    QList<RBlock::Id> todo;
+    todo.append(blockId);
+    while (!todo.isEmpty()) {
+        QSet<REntity::Id> refs = blockReferenceMap.value(todo.takeLast());
+        QSet<REntity::Id>::const_iterator it;
+        for (it = refs.constBegin(); it != refs.constEnd(); ++it) {
+            QHash<REntity::Id, IndexedEntity>::const_iterator iit = indexedEntityMap.constFind(*it);
+            if (iit==indexedEntityMap.constEnd() || done.contains(iit->blockId)) {
+                continue;
+            }
+            done.insert(iit->blockId);
+            invalidateBoundingBox(iit->blockId);
+            todo.append(iit->blockId);
         }
     }
+}
 
-    boundingBoxChanged = false;
-    return boundingBox;
+/**
+ * Invalidates the cached bounding boxes of all blocks.
+ */
+void RMemoryStorage::invalidateBoundingBoxes() {
+    boundingBoxMap.clear();
+    visibleBoundingBoxMap.clear();
+    maxLineweightMap.clear();
+    lineweightCountMap.clear();
 }
 
 RBox RMemoryStorage::getSelectionBox() {
     RBlock::Id currentBlock = getCurrentBlockId();
     RBox ret;
-    QHash<RObject::Id, QSharedPointer<REntity> >::iterator it;
-    for (it = entityMap.begin(); it != entityMap.end(); ++it) {
-        QSharedPointer<REntity> e = *it;
-        if (!e.isNull() && !e->isUndone() && e->isSelected() &&
-                e->getBlockId() == currentBlock) {
+    QSet<REntity::Id>::const_iterator it;
+    for (it = selectedEntitySet.constBegin(); it != selectedEntitySet.constEnd(); ++it) {
+        QSharedPointer<REntity> e = entityMap.value(*it);
+        if (!e.isNull() && !e->isUndone() && e->getBlockId() == currentBlock) {
 
             ret.growToInclude(e->getBoundingBox());
         }
@@ -766,7 +1019,8 @@ bool RMemoryStorage::removeObject(QSharedPointer<RObject> object) {
 
     QSharedPointer<REntity> entity = object.dynamicCast<REntity> ();
     if (!entity.isNull()) {
-        blockEntityMap.remove(entity->getBlockId(), entity);
+        removeFromEntityIndexes(entity);
+        removeFromBoundingBox(entity);
         return true;
     }
 
@@ -837,27 +1091,103 @@ bool RMemoryStorage::saveObject(QSharedPointer<RObject> object, bool checkBlockR
         //transactionObjectMap[object->getId()] = object;
     //}
 
+    // previous version of the object might have had a different handle:
+    QSharedPointer<RObject> oldObject = objectMap.value(object->getId());
+    if (!oldObject.isNull() && oldObject->getHandle()!=object->getHandle()) {
+        removeFromHandleIndex(*oldObject);
+    }
+
     objectMap[object->getId()] = object;
+    if (object->getHandle()!=RObject::INVALID_HANDLE) {
+        objectHandleMap.insert(object->getHandle(), object->getId());
+    }
 
     //QSharedPointer<REntity> entity = object.dynamicCast<REntity> ();
     if (!entity.isNull()) {
+        // previous version of the entity (if not removed through removeObject):
+        QSharedPointer<REntity> oldEntity = entityMap.value(entity->getId());
+        if (!oldEntity.isNull() && oldEntity!=entity) {
+            removeFromEntityIndexes(oldEntity);
+            removeFromBoundingBox(oldEntity);
+        }
+        else if (!oldEntity.isNull()) {
+            // the same instance has been changed and is saved again, its
+            // previous bounding box and lineweight are unknown:
+            QHash<REntity::Id, IndexedEntity>::const_iterator iit = indexedEntityMap.constFind(entity->getId());
+            if (iit!=indexedEntityMap.constEnd()) {
+                invalidateBoundingBox(iit->blockId);
+            }
+        }
+        addToEntityIndexes(entity);
+
         entityMap[entity->getId()] = entity;
-        blockEntityMap.insert(entity->getBlockId(), entity);
+        addToBoundingBox(entity);
         //qDebug() << "added " << entity->getId() << " to block " << entity->getBlockId();
         setMaxDrawOrder(qMax(entity->getDrawOrder()+1, getMaxDrawOrder()));
     }
 
     if (!layer.isNull()) {
         layerMap[object->getId()] = layer;
+        addToNameIndex(layerNameMap, layer->getId(), layer->getName());
+        // layer might have been frozen, thawed or changed lineweight:
+        invalidateBoundingBoxes();
     }
 
     if (!block.isNull()) {
         blockMap[object->getId()] = block;
+        addToNameIndex(blockNameMap, block->getId(), block->getName());
+        invalidateBoundingBoxes();
+    }
+
+    if (entity.isNull() && layer.isNull() && block.isNull()) {
+        QSharedPointer<RView> view = object.dynamicCast<RView>();
+        if (!view.isNull()) {
+            addToNameIndex(viewNameMap, view->getId(), view->getName());
+        }
+
+        QSharedPointer<RLinetype> linetype = object.dynamicCast<RLinetype>();
+        if (!linetype.isNull()) {
+            addToNameIndex(linetypeNameMap, linetype->getId(), linetype->getName());
+        }
     }
 
     return true;
 }
 
+/**
+ * Adds or updates the entry of the given object in the given name index.
+ * A previous entry of the object under a different (old) name is removed.
+ */
+void RMemoryStorage::addToNameIndex(QMultiHash<QString, RObject::Id>& index,
+    RObject::Id objectId, const QString& name) {
+
+    QString key = name.toLower();
+    if (indexedNameMap.contains(objectId)) {
+        if (indexedNameMap[objectId]==key) {
+            return;
+        }
+        removeFromNameIndex(index, objectId);
+    }
+
+    index.insert(key, objectId);
+    indexedNameMap.insert(objectId, key);
+}
+
+/**
+ * Removes the entry of the given object from the given name index.
+ */
+void RMemoryStorage::removeFromNameIndex(QMultiHash<QString, RObject::Id>& index,
+    RObject::Id objectId) {
+
+    if (!indexedNameMap.contains(objectId)) {
+        return;
+    }
+
+    if (index.remove(indexedNameMap.value(objectId), objectId)>0) {
+        indexedNameMap.remove(objectId);
+    }
+}
+
 /**
  * Checks recursively, if the given block is allowed to contain
  * references to the potential child block.
@@ -899,26 +1229,449 @@ bool RMemoryStorage::deleteObject(RObject::Id objectId) {
         //transactionObjectMap.insert(objectId, QSharedPointer<RObject>());
     }
 
+    QSharedPointer<REntity> entity = entityMap.value(objectId);
+    if (!entity.isNull()) {
+        removeFromEntityIndexes(entity);
+        removeFromBoundingBox(entity);
+        //qDebug() << "deleteObject: removed " << entity->getId() << " from block " << entity->getBlockId();
+    }
+
+    QSharedPointer<RObject> object = objectMap.value(objectId);
+    if (!object.isNull()) {
+        removeFromHandleIndex(*object);
+    }
+
     objectMap.remove(objectId);
     if (entityMap.contains(objectId)) {
         entityMap.remove(objectId);
     }
     if (blockMap.contains(objectId)) {
         blockMap.remove(objectId);
+        removeFromNameIndex(blockNameMap, objectId);
+        invalidateBoundingBoxes();
     }
     if (layerMap.contains(objectId)) {
         layerMap.remove(objectId);
+        removeFromNameIndex(layerNameMap, objectId);
+        invalidateBoundingBoxes();
     }
-
-    QSharedPointer<REntity> entity = queryEntityDirect(objectId);
-    if (!entity.isNull()) {
-        blockEntityMap.remove(entity->getBlockId(), entity);
-        //qDebug() << "deleteObject: removed " << entity->getId() << " from block " << entity->getBlockId();
+    if (indexedNameMap.contains(objectId)) {
+        // view or linetype:
+        removeFromNameIndex(viewNameMap, objectId);
+        removeFromNameIndex(linetypeNameMap, objectId);
     }
 
     return true;
 }
 
+/**
+ * Sets the handle of the given object and updates the handle index if the
+ * object is stored in this storage.
+ */
+void RMemoryStorage::setObjectHandle(RObject& object, RObject::Handle objectHandle) {
+    QSharedPointer<RObject> obj = objectMap.value(object.getId());
+    bool stored = (obj.data()==&object);
+
+    if (stored) {
+        removeFromHandleIndex(object);
+    }
+
+    RStorage::setObjectHandle(object, objectHandle);
+
+    if (stored && objectHandle!=RObject::INVALID_HANDLE) {
+        objectHandleMap.insert(objectHandle, object.getId());
+    }
+}
+
+/**
+ * Removes the handle of the given object from the handle index.
+ */
+void RMemoryStorage::removeFromHandleIndex(const RObject& object) {
+    QHash<RObject::Handle, RObject::Id>::iterator it = objectHandleMap.find(object.getHandle());
+    // handle might have been taken over by another object:
+    if (it!=objectHandleMap.end() && it.value()==object.getId()) {
+        objectHandleMap.erase(it);
+    }
+}
+
+/**
+ * Reparents the given entity and updates the child entity index if the
+ * entity is stored in this storage.
+ */
+void RMemoryStorage::setEntityParentId(REntity& entity, REntity::Id parentId) {
+    QSharedPointer<REntity> e = entityMap.value(entity.getId());
+    if (e.data()!=&entity) {
+        RStorage::setEntityParentId(entity, parentId);
+        return;
+    }
+
+    removeFromEntityIndexes(e);
+    RStorage::setEntityParentId(entity, parentId);
+    addToEntityIndexes(e);
+}
+
+/**
+ * \return ID of the block referenced by the given entity if it is a block
+ * reference, RBlock::INVALID_ID otherwise.
+ */
+static RBlock::Id getReferencedBlockId(QSharedPointer<REntity> entity) {
+    if (entity->getType()!=RS::EntityBlockRef) {
+        return RBlock::INVALID_ID;
+    }
+    QSharedPointer<RBlockReferenceEntity> blockRef = entity.dynamicCast<RBlockReferenceEntity>();
+    if (blockRef.isNull()) {
+        return RBlock::INVALID_ID;
+    }
+    return blockRef->getReferencedBlockId();
+}
+
+/**
+ * Adds the given entity to the block, layer, parent, block reference,
+ * selection and draw order indexes. If the entity is already indexed under different
+ * attributes (the same instance has been changed and saved again),
+ * it is moved in the indexes.
+ */
+void RMemoryStorage::addToEntityIndexes(QSharedPointer<REntity> entity) {
+    REntity::Id id = entity->getId();
+
+    if (entity->isSelected()) {
+        selectedEntitySet.insert(id);
+    }
+    else {
+        selectedEntitySet.remove(id);
+    }
+
+    QHash<REntity::Id, IndexedEntity>::const_iterator iit = indexedEntityMap.constFind(id);
+    if (iit!=indexedEntityMap.constEnd()) {
+        if (iit->blockId==entity->getBlockId() &&
+            iit->layerId==entity->getLayerId() &&
+            iit->parentId==entity->getParentId() &&
+            iit->referencedBlockId==getReferencedBlockId(entity) &&
+            iit->drawOrder==entity->getDrawOrder() &&
+            iit->counted!=entity->isUndone()) {
+            return;
+        }
+        removeFromEntityIndexes(entity);
+        if (entity->isSelected()) {
+            selectedEntitySet.insert(id);
+        }
+    }
+
+    IndexedEntity indexed;
+    indexed.blockId = entity->getBlockId();
+    indexed.layerId = entity->getLayerId();
+    indexed.parentId = entity->getParentId();
+    indexed.referencedBlockId = getReferencedBlockId(entity);
+    indexed.type = entity->getType();
+    indexed.drawOrder = entity->getDrawOrder();
+    indexed.counted = !entity->isUndone();
+    indexedEntityMap.insert(id, indexed);
+
+    blockEntityMap[indexed.blockId].insert(id);
+    layerEntityMap[indexed.layerId].insert(id);
+    if (indexed.parentId!=REntity::INVALID_ID) {
+        childEntityMap[indexed.parentId].insert(id);
+    }
+    if (indexed.referencedBlockId!=RBlock::INVALID_ID) {
+        blockReferenceMap[indexed.referencedBlockId].insert(id);
+    }
+    drawOrderIndex.insert(indexed.drawOrder, id);
+    if (indexed.counted) {
+        updateEntityCounts(indexed, 1);
+    }
+}
+
+/**
+ * Removes the given entity from the block, layer, parent, block reference,
+ * selection and draw order indexes, using the attributes it was indexed under.
+ */
+void RMemoryStorage::removeFromEntityIndexes(QSharedPointer<REntity> entity) {
+    REntity::Id id = entity->getId();
+
+    selectedEntitySet.remove(id);
+
+    QHash<REntity::Id, IndexedEntity>::iterator iit = indexedEntityMap.find(id);
+    if (iit==indexedEntityMap.end()) {
+        return;
+    }
+    IndexedEntity indexed = iit.value();
+    indexedEntityMap.erase(iit);
+
+    QHash<RBlock::Id, QSet<REntity::Id> >::iterator it = blockEntityMap.find(indexed.blockId);
+    if (it!=blockEntityMap.end()) {
+        it->remove(id);
+        if (it->isEmpty()) {
+            blockEntityMap.erase(it);
+        }
+    }
+
+    it = layerEntityMap.find(indexed.layerId);
+    if (it!=layerEntityMap.end()) {
+        it->remove(id);
+        if (it->isEmpty()) {
+            layerEntityMap.erase(it);
+        }
+    }
+
+    it = childEntityMap.find(indexed.parentId);
+    if (it!=childEntityMap.end()) {
+        it->remove(id);
+        if (it->isEmpty()) {
+            childEntityMap.erase(it);
+        }
+    }
+
+    it = blockReferenceMap.find(indexed.referencedBlockId);
+    if (it!=blockReferenceMap.end()) {
+        it->remove(id);
+        if (it->isEmpty()) {
+            blockReferenceMap.erase(it);
+        }
+    }
+
+    drawOrderIndex.remove(indexed.drawOrder, id);
+    if (indexed.counted) {
+        updateEntityCounts(indexed, -1);
+    }
+}
+
+/**
+ * Checks the consistency of all indexes (handle, name, block, layer, parent,
+ * block reference, selection and draw order indexes) against the stored objects. This iterates through all objects
+ * and is intended for debugging only.
+ *
+ * \return True if all indexes are consistent. Inconsistencies are
+ * reported as warnings.
+ */
+bool RMemoryStorage::checkIndexes() const {
+    bool ret = true;
+
+    // every entity is indexed under its current attributes:
+    QHash<REntity::Id, QSharedPointer<REntity> >::const_iterator it;
+    for (it = entityMap.constBegin(); it != entityMap.constEnd(); ++it) {
+        QSharedPointer<REntity> e = *it;
+        if (e.isNull()) {
+            continue;
+        }
+        REntity::Id id = e->getId();
+        if (!blockEntityMap.value(e->getBlockId()).contains(id)) {
+            qWarning() << "RMemoryStorage::checkIndexes: entity not in block index: " << id;
+            ret = false;
+        }
+        if (!layerEntityMap.value(e->getLayerId()).contains(id)) {
+            qWarning() << "RMemoryStorage::checkIndexes: entity not in layer index: " << id;
+            ret = false;
+        }
+        if (e->getParentId()!=REntity::INVALID_ID &&
+            !childEntityMap.value(e->getParentId()).contains(id)) {
+            qWarning() << "RMemoryStorage::checkIndexes: entity not in parent index: " << id;
+            ret = false;
+        }
+        if (getReferencedBlockId(e)!=RBlock::INVALID_ID &&
+            !blockReferenceMap.value(getReferencedBlockId(e)).contains(id)) {
+            qWarning() << "RMemoryStorage::checkIndexes: entity not in block reference index: " << id;
+            ret = false;
+        }
+        if (e->isSelected()!=selectedEntitySet.contains(id)) {
+            qWarning() << "RMemoryStorage::checkIndexes: selection index out of sync: " << id;
+            ret = false;
+        }
+        QHash<REntity::Id, IndexedEntity>::const_iterator iit = indexedEntityMap.constFind(id);
+        if (iit==indexedEntityMap.constEnd() ||
+            iit->blockId!=e->getBlockId() ||
+            iit->layerId!=e->getLayerId() ||
+            iit->parentId!=e->getParentId() ||
+            iit->counted==e->isUndone()) {
+            qWarning() << "RMemoryStorage::checkIndexes: indexed attributes out of sync: " << id;
+            ret = false;
+        }
+        if (iit==indexedEntityMap.constEnd() ||
+            iit->drawOrder!=e->getDrawOrder() ||
+            !drawOrderIndex.contains(e->getDrawOrder(), id)) {
+            qWarning() << "RMemoryStorage::checkIndexes: draw order index out of sync: " << id;
+            ret = false;
+        }
+    }
+    if (drawOrderIndex.size()!=indexedEntityMap.size()) {
+        qWarning() << "RMemoryStorage::checkIndexes: stale draw order index entries";
+        ret = false;
+    }
+
+    // no stale index entries:
+    QHash<RLayer::Id, QSet<REntity::Id> >::const_iterator lit;
+    for (lit = blockEntityMap.constBegin(); lit != blockEntityMap.constEnd(); ++lit) {
+        QSet<REntity::Id>::const_iterator eit;
+        for (eit = lit->constBegin(); eit != lit->constEnd(); ++eit) {
+            QSharedPointer<REntity> e = entityMap.value(*eit);
+            if (e.isNull() || e->getBlockId()!=lit.key()) {
+                qWarning() << "RMemoryStorage::checkIndexes: stale block index entry: " << *eit;
+                ret = false;
+            }
+        }
+    }
+    for (lit = layerEntityMap.constBegin(); lit != layerEntityMap.constEnd(); ++lit) {
+        QSet<REntity::Id>::const_iterator eit;
+        for (eit = lit->constBegin(); eit != lit->constEnd(); ++eit) {
+            QSharedPointer<REntity> e = entityMap.value(*eit);
+            if (e.isNull() || e->getLayerId()!=lit.key()) {
+                qWarning() << "RMemoryStorage::checkIndexes: stale layer index entry: " << *eit;
+                ret = false;
+            }
+        }
+    }
+    for (lit = childEntityMap.constBegin(); lit != childEntityMap.constEnd(); ++lit) {
+        QSet<REntity::Id>::const_iterator eit;
+        for (eit = lit->constBegin(); eit != lit->constEnd(); ++eit) {
+            QSharedPointer<REntity> e = entityMap.value(*eit);
+            if (e.isNull() || e->getParentId()!=lit.key()) {
+                qWarning() << "RMemoryStorage::checkIndexes: stale parent index entry: " << *eit;
+                ret = false;
+            }
+        }
+    }
+    for (lit = blockReferenceMap.constBegin(); lit != blockReferenceMap.constEnd(); ++lit) {
+        QSet<REntity::Id>::const_iterator eit;
+        for (eit = lit->constBegin(); eit != lit->constEnd(); ++eit) {
+            QSharedPointer<REntity> e = entityMap.value(*eit);
+            if (e.isNull() || getReferencedBlockId(e)!=lit.key()) {
+                qWarning() << "RMemoryStorage::checkIndexes: stale block reference index entry: " << *eit;
+                ret = false;
+            }
+        }
+    }
+    QSet<REntity::Id>::const_iterator sit;
+    for (sit = selectedEntitySet.constBegin(); sit != selectedEntitySet.constEnd(); ++sit) {
+        if (!entityMap.contains(*sit)) {
+            qWarning() << "RMemoryStorage::checkIndexes: stale selection index entry: " << *sit;
+            ret = false;
+        }
+    }
+
+    // handle index:
+    QHash<RObject::Handle, RObject::Id>::const_iterator hit;
+    for (hit = objectHandleMap.constBegin(); hit != objectHandleMap.constEnd(); ++hit) {
+        QSharedPointer<RObject> obj = objectMap.value(hit.value());
+        if (obj.isNull() || obj->getHandle()!=hit.key()) {
+            qWarning() << "RMemoryStorage::checkIndexes: stale handle index entry: " << hit.key();
+            ret = false;
+        }
+    }
+    QHash<RObject::Id, QSharedPointer<RObject> >::const_iterator oit;
+    for (oit = objectMap.constBegin(); oit != objectMap.constEnd(); ++oit) {
+        QSharedPointer<RObject> obj = *oit;
+        if (!obj.isNull() && obj->getHandle()!=RObject::INVALID_HANDLE &&
+            !objectHandleMap.contains(obj->getHandle())) {
+            qWarning() << "RMemoryStorage::checkIndexes: object not in handle index: " << obj->getId();
+            ret = false;
+        }
+    }
+
+    // name indexes:
+    QHash<RObject::Id, QString>::const_iterator nit;
+    for (nit = indexedNameMap.constBegin(); nit != indexedNameMap.constEnd(); ++nit) {
+        QSharedPointer<RObject> obj = objectMap.value(nit.key());
+        if (obj.isNull()) {
+            qWarning() << "RMemoryStorage::checkIndexes: stale name index entry: " << nit.key();
+            ret = false;
+            continue;
+        }
+        QString name;
+        if (!obj.dynamicCast<RLayer>().isNull()) {
+            name = obj.dynamicCast<RLayer>()->getName();
+        }
+        else if (!obj.dynamicCast<RBlock>().isNull()) {
+            name = obj.dynamicCast<RBlock>()->getName();
+        }
+        else if (!obj.dynamicCast<RView>().isNull()) {
+            name = obj.dynamicCast<RView>()->getName();
+        }
+        else if (!obj.dynamicCast<RLinetype>().isNull()) {
+            name = obj.dynamicCast<RLinetype>()->getName();
+        }
+        if (name.toLower()!=nit.value()) {
+            qWarning() << "RMemoryStorage::checkIndexes: name index out of sync: " << nit.key();
+            ret = false;
+        }
+    }
+
+    // entity counts:
+    QHash<RLayer::Id, int> layerCount;
+    QHash<RBlock::Id, int> blockCount;
+    QHash<RS::EntityType, int> typeCount;
+    QHash<RBlock::Id, QMap<int, int> > drawOrderCount;
+    for (it = entityMap.constBegin(); it != entityMap.constEnd(); ++it) {
+        QSharedPointer<REntity> e = *it;
+        if (e.isNull() || e->isUndone()) {
+            continue;
+        }
+        layerCount[e->getLayerId()]++;
+        blockCount[e->getBlockId()]++;
+        typeCount[e->getType()]++;
+        drawOrderCount[e->getBlockId()][e->getDrawOrder()]++;
+    }
+    if (layerCount!=layerEntityCount || blockCount!=blockEntityCount ||
+        typeCount!=entityTypeCount || drawOrderCount!=blockDrawOrderCount) {
+        qWarning() << "RMemoryStorage::checkIndexes: entity counts out of sync";
+        ret = false;
+    }
+
+    return ret;
+}
+
+/**
+ * Adds the given delta to the entity counts of the layer, block, type
+ * and draw order of the given entity.
+ */
+void RMemoryStorage::updateEntityCounts(const IndexedEntity& indexed, int delta) {
+    int c = layerEntityCount.value(indexed.layerId) + delta;
+    if (c>0) {
+        layerEntityCount.insert(indexed.layerId, c);
+    }
+    else {
+        layerEntityCount.remove(indexed.layerId);
+    }
+
+    c = blockEntityCount.value(indexed.blockId) + delta;
+    if (c>0) {
+        blockEntityCount.insert(indexed.blockId, c);
+    }
+    else {
+        blockEntityCount.remove(indexed.blockId);
+    }
+
+    c = entityTypeCount.value(indexed.type) + delta;
+    if (c>0) {
+        entityTypeCount.insert(indexed.type, c);
+    }
+    else {
+        entityTypeCount.remove(indexed.type);
+    }
+
+    QMap<int, int>& drawOrders = blockDrawOrderCount[indexed.blockId];
+    c = drawOrders.value(indexed.drawOrder) + delta;
+    if (c>0) {
+        drawOrders.insert(indexed.drawOrder, c);
+    }
+    else {
+        drawOrders.remove(indexed.drawOrder);
+        if (drawOrders.isEmpty()) {
+            blockDrawOrderCount.remove(indexed.blockId);
+        }
+    }
+}
+
+int RMemoryStorage::getLayerEntityCount(RLayer::Id layerId) {
+    return layerEntityCount.value(layerId);
+}
+
+int RMemoryStorage::getBlockEntityCount(RBlock::Id blockId) {
+    return blockEntityCount.value(blockId);
+}
+
+int RMemoryStorage::getEntityTypeCount(RS::EntityType type) {
+    return entityTypeCount.value(type);
+}
+
 void RMemoryStorage::saveTransaction(RTransaction& transaction) {
     // if the given transaction is not undoable, we don't need to
     // store anything here:
@@ -995,7 +1748,7 @@ void RMemoryStorage::toggleUndoStatus(QSet<RObject::Id>& objects) {
 void RMemoryStorage::toggleUndoStatus(RObject::Id objectId) {
     QSharedPointer<RObject> obj = queryObjectDirect(objectId);
     if (!obj.isNull()) {
-        obj->setUndone(!obj->isUndone());
+        setUndoStatus(objectId, !obj->isUndone());
     }
 }
 
@@ -1005,7 +1758,32 @@ bool RMemoryStorage::setUndoStatus(RObject::Id objectId, bool status) {
         qWarning() << QString("RMemoryStorage::setUndoStatus: object is NULL");
         return false;
     }
+
+    if (obj->isUndone()==status) {
+        return true;
+    }
+
+    QSharedPointer<REntity> entity = obj.dynamicCast<REntity>();
+    if (!entity.isNull() && status) {
+        removeFromBoundingBox(entity);
+    }
+
+    if (!entity.isNull()) {
+        QHash<REntity::Id, IndexedEntity>::iterator iit = indexedEntityMap.find(entity->getId());
+        if (iit!=indexedEntityMap.end() && iit->counted==status) {
+            iit->counted = !status;
+            updateEntityCounts(iit.value(), status ? -1 : 1);
+        }
+    }
+
     obj->setUndone(status);
+
+    if (!entity.isNull() && !status) {
+        addToBoundingBox(entity);
+    }
+    if (!obj.dynamicCast<RLayer>().isNull() || !obj.dynamicCast<RBlock>().isNull()) {
+        invalidateBoundingBoxes();
+    }
     return true;
 }
 
@@ -1076,7 +1854,7 @@ void RMemoryStorage::setKnownVariable(RS::KnownVariable key, const QVariant& val
     }
 
     // dimension settings might affect bounding box:
-    boundingBoxChanged = true;
+    invalidateBoundingBoxes();
     setModified(true);
 }
 
@@ -1122,27 +1900,40 @@ QSet<QString> RMemoryStorage::getLayerNames() const {
 }
 
 RLayer::Id RMemoryStorage::getLayerId(const QString& layerName) const {
-    QSharedPointer<RLayer> l = queryLayer(layerName);
-    if (l.isNull()) {
-        return RLayer::INVALID_ID;
+    QString key = layerName.toLower();
+    QMultiHash<QString, RLayer::Id>::const_iterator it = layerNameMap.constFind(key);
+    for (; it!=layerNameMap.constEnd() && it.key()==key; ++it) {
+        QSharedPointer<RLayer> l = layerMap.value(it.value());
+        if (!l.isNull() && !l->isUndone()) {
+            return l->getId();
+        }
     }
-    return l->getId();
+    return RLayer::INVALID_ID;
 }
 
 RBlock::Id RMemoryStorage::getBlockId(const QString& blockName) const {
-    QSharedPointer<RBlock> b = queryBlock(blockName);
-    if (b.isNull()) {
-        return RBlock::INVALID_ID;
+    QString key = blockName.toLower();
+    QMultiHash<QString, RBlock::Id>::const_iterator it = blockNameMap.constFind(key);
+    for (; it!=blockNameMap.constEnd() && it.key()==key; ++it) {
+        QSharedPointer<RBlock> b = blockMap.value(it.value());
+        if (!b.isNull() && !b->isUndone()) {
+            return b->getId();
+        }
     }
-    return b->getId();
+    return RBlock::INVALID_ID;
 }
 
 RView::Id RMemoryStorage::getViewId(const QString& viewName) const {
-    QSharedPointer<RView> v = queryView(viewName);
-    if (v.isNull()) {
-        return RView::INVALID_ID;
+    QString key = viewName.toLower();
+    QMultiHash<QString, RView::Id>::const_iterator it = viewNameMap.constFind(key);
+    for (; it!=viewNameMap.constEnd() && it.key()==key; ++it) {
+        QSharedPointer<RObject> v = objectMap.value(it.value());
+        // view names are case sensitive:
+        if (!v.isNull() && !v->isUndone() && v.staticCast<RView>()->getName()==viewName) {
+            return v->getId();
+        }
     }
-    return v->getId();
+    return RView::INVALID_ID;
 }
 
 QString RMemoryStorage::getLinetypeName(RLinetype::Id linetypeId) const {
@@ -1166,20 +1957,19 @@ QSet<QString> RMemoryStorage::getLinetypeNames() const {
 }
 
 RLinetype::Id RMemoryStorage::getLinetypeId(const QString& linetypeName) const {
-    QSharedPointer<RLinetype> l = queryLinetype(linetypeName);
-    if (l.isNull()) {
+    QMultiHash<QString, RLinetype::Id>::const_iterator it = linetypeNameMap.constFind(linetypeName.toLower());
+    if (it==linetypeNameMap.constEnd()) {
         return RLinetype::INVALID_ID;
     }
-    return l->getId();
+    return it.value();
 }
 
 void RMemoryStorage::setLastTransactionId(int transactionId) {
     RStorage::setLastTransactionId(transactionId);
-    boundingBoxChanged = true;
 }
 
 RLineweight::Lineweight RMemoryStorage::getMaxLineweight() const {
-    return maxLineweight;
+    return maxLineweightMap.value(getCurrentBlockId(), maxLineweight);
 }
 
 void RMemoryStorage::setUnit(RS::Unit unit) {
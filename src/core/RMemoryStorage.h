@@ -22,6 +22,7 @@
 
 #include "core_global.h"
 
+#include <QMap>
 #include <QSharedPointer>
 
 #include "RStorage.h"
@@ -46,7 +47,9 @@ public:
     virtual void commitTransaction();
     virtual void rollbackTransaction();
 
-    //virtual QList<REntity::Id> orderBackToFront(const QSet<REntity::Id>& entityIds);
+    virtual QList<REntity::Id> orderBackToFront(const QSet<REntity::Id>& entityIds) const;
+    virtual void orderBackToFront(QVector<REntity::Id>& entityIds) const;
+    virtual int getMinDrawOrder();
 
     virtual QSet<RObject::Id> queryAllObjects();
     virtual QSet<REntity::Id> queryAllEntities(bool undone = false, bool allBlocks = false);
@@ -63,6 +66,10 @@ public:
     virtual bool hasChildEntities(REntity::Id parentId);
     virtual QSet<REntity::Id> queryBlockReferences(RBlock::Id blockId);
     virtual QSet<REntity::Id> queryAllBlockReferences();
+
+    virtual int getLayerEntityCount(RLayer::Id layerId);
+    virtual int getBlockEntityCount(RBlock::Id blockId);
+    virtual int getEntityTypeCount(RS::EntityType type);
     //virtual QSet<REntity::Id> queryViewEntities(RView::Id viewId);
 
     virtual QSharedPointer<RObject> queryObject(RObject::Id objectId) const;
@@ -105,6 +112,8 @@ public:
         RBlock::Id blockId, RBlock::Id potentialChildBlockId
     );
     virtual bool deleteObject(RObject::Id objectId);
+    virtual void setObjectHandle(RObject& object, RObject::Handle objectHandle);
+    virtual void setEntityParentId(REntity& entity, REntity::Id parentId);
     virtual void saveTransaction(RTransaction& transaction);
     virtual void deleteTransactionsFrom(int transactionId);
     virtual RTransaction getTransaction(int transactionId);
@@ -156,16 +165,110 @@ public:
     virtual void setLinetypeScale(double v);
     virtual double getLinetypeScale() const;
 
+    bool checkIndexes() const;
+
+protected:
+    /**
+     * Attributes under which an entity is indexed. Used to update the
+     * indexes if an entity instance that is already stored has been
+     * changed and is saved again.
+     *
+     * \nonscriptable
+     */
+    struct IndexedEntity {
+        RBlock::Id blockId;
+        RLayer::Id layerId;
+        REntity::Id parentId;
+        RBlock::Id referencedBlockId;
+        RS::EntityType type;
+        int drawOrder;
+        bool counted;
+    };
+
+    void addToEntityIndexes(QSharedPointer<REntity> entity);
+    void removeFromEntityIndexes(QSharedPointer<REntity> entity);
+    void updateEntityCounts(const IndexedEntity& indexed, int delta);
+
+    void updateBoundingBox(RBlock::Id blockId);
+    void addToBoundingBox(QSharedPointer<REntity> entity);
+    void removeFromBoundingBox(QSharedPointer<REntity> entity);
+    void invalidateBoundingBox(RBlock::Id blockId);
+    void invalidateReferencingBoundingBoxes(RBlock::Id blockId);
+    void invalidateBoundingBoxes();
+
+    void addToNameIndex(QMultiHash<QString, RObject::Id>& index,
+        RObject::Id objectId, const QString& name);
+    void removeFromNameIndex(QMultiHash<QString, RObject::Id>& index,
+        RObject::Id objectId);
+    void removeFromHandleIndex(const RObject& object);
+
 protected:
     RLineweight::Lineweight maxLineweight;
     bool inTransaction;
-    bool boundingBoxChanged;
-    RBox boundingBox;
+    /**
+     * Bounding boxes and maximum lineweight per block, maintained
+     * incrementally. A block without entry is recomputed on demand.
+     */
+    QHash<RBlock::Id, RBox> boundingBoxMap;
+    QHash<RBlock::Id, RBox> visibleBoundingBoxMap;
+    QHash<RBlock::Id, RLineweight::Lineweight> maxLineweightMap;
+    /**
+     * Number of visible entities per lineweight and block. The maximum
+     * lineweight of a block only changes if the last entity with that
+     * lineweight is removed.
+     */
+    QHash<RBlock::Id, QMap<RLineweight::Lineweight, int> > lineweightCountMap;
     QHash<RObject::Id, QSharedPointer<RObject> > objectMap;
+    /**
+     * Handle index for O(1) lookups by handle.
+     */
+    QHash<RObject::Handle, RObject::Id> objectHandleMap;
     QHash<REntity::Id, QSharedPointer<REntity> > entityMap;
-    QMultiHash<RBlock::Id, QSharedPointer<REntity> > blockEntityMap;
     QHash<RBlock::Id, QSharedPointer<RBlock> > blockMap;
     QHash<RLayer::Id, QSharedPointer<RLayer> > layerMap;
+    /**
+     * Entity indexes for queries by block, layer, parent and selection
+     * status. Undone entities stay in the indexes and are filtered on lookup.
+     */
+    QHash<RBlock::Id, QSet<REntity::Id> > blockEntityMap;
+    QHash<RLayer::Id, QSet<REntity::Id> > layerEntityMap;
+    QHash<REntity::Id, QSet<REntity::Id> > childEntityMap;
+    /**
+     * Block references by referenced block.
+     */
+    QHash<RBlock::Id, QSet<REntity::Id> > blockReferenceMap;
+    QSet<REntity::Id> selectedEntitySet;
+    /**
+     * Number of entities (not undone) per layer, block and entity type.
+     */
+    QHash<RLayer::Id, int> layerEntityCount;
+    QHash<RBlock::Id, int> blockEntityCount;
+    QHash<RS::EntityType, int> entityTypeCount;
+    /**
+     * Number of entities (not undone) per draw order and block, used to
+     * look up the lowest draw order of a block.
+     */
+    QHash<RBlock::Id, QMap<int, int> > blockDrawOrderCount;
+    /**
+     * Draw order index (draw order -> entity IDs).
+     */
+    QMultiMap<int, REntity::Id> drawOrderIndex;
+    /**
+     * Indexed attributes of every entity in the indexes.
+     */
+    QHash<REntity::Id, IndexedEntity> indexedEntityMap;
+    /**
+     * Name indexes (lower case name -> IDs) for O(1) lookups by name.
+     * Undone objects stay in the indexes and are filtered on lookup.
+     */
+    QMultiHash<QString, RLayer::Id> layerNameMap;
+    QMultiHash<QString, RBlock::Id> blockNameMap;
+    QMultiHash<QString, RView::Id> viewNameMap;
+    QMultiHash<QString, RLinetype::Id> linetypeNameMap;
+    /**
+     * Indexed (lower case) name of every object in one of the name indexes.
+     */
+    QHash<RObject::Id, QString> indexedNameMap;
     QHash<int, RTransaction> transactionMap;
     QHash<QString, QVariant> variables;
     QMap<QString, QString> variableCaseMap;
@@ -0,0 +1,229 @@
+/**
+ * Copyright (c) 2011-2013 by Andrew Mustun. All rights reserved.
+ * 
+ * This file is part of the QCAD project.
+ *
+ * QCAD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QCAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QCAD.
+ */
+#include <cmath>
+#include <queue>
+#include <vector>
+
+#include <QtAlgorithms>
+
+#include "RSegmentIndex.h"
+#include "RMath.h"
+
+namespace {
+
+/**
+ * Internal.
+ * Entry of a level with its distance to the query point of a closest
+ * segment query, ordered by ascending distance in the priority queue.
+ */
+struct RSegmentCandidate {
+    RSegmentCandidate(double dist, int level, int index) :
+        dist(dist), level(level), index(index) {}
+
+    bool operator<(const RSegmentCandidate& other) const {
+        return dist > other.dist;
+    }
+
+    double dist;
+    int level;
+    int index;
+};
+
+}
+
+RSegmentIndex::RSegmentIndex() {
+}
+
+/**
+ * Builds the index for the given shapes (sort tile recursive packing).
+ */
+void RSegmentIndex::build(const QList<QSharedPointer<RShape> >& shapes) {
+    clear();
+    this->shapes = shapes;
+
+    QVector<Entry> leaves;
+    leaves.reserve(shapes.size());
+    for (int i=0; i<shapes.size(); i++) {
+        if (shapes.at(i).isNull()) {
+            continue;
+        }
+        RBox bb = shapes.at(i)->getBoundingBox();
+        RVector c1 = bb.getMinimum();
+        RVector c2 = bb.getMaximum();
+        Entry e = { c1.x, c1.y, c2.x, c2.y, i };
+        leaves.append(e);
+    }
+
+    if (leaves.isEmpty()) {
+        return;
+    }
+
+    // sort into vertical slices, then sort each slice by y:
+    int leafCount = (leaves.size() + nodeSize - 1) / nodeSize;
+    int sliceCount = (int)ceil(sqrt((double)leafCount));
+    int sliceSize = sliceCount * nodeSize;
+    qSort(leaves.begin(), leaves.end(), lessX);
+    for (int i=0; i<leaves.size(); i+=sliceSize) {
+        int end = qMin(i+sliceSize, leaves.size());
+        qSort(leaves.begin()+i, leaves.begin()+end, lessY);
+    }
+    levels.append(leaves);
+
+    // group consecutive entries into nodes up to a single root node:
+    while (levels.last().size() > nodeSize) {
+        const QVector<Entry>& below = levels.last();
+        QVector<Entry> level;
+        level.reserve((below.size() + nodeSize - 1) / nodeSize);
+        for (int i=0; i<below.size(); i+=nodeSize) {
+            Entry n = below[i];
+            n.ref = i;
+            int end = qMin(i+nodeSize, below.size());
+            for (int k=i+1; k<end; k++) {
+                n.x1 = qMin(n.x1, below[k].x1);
+                n.y1 = qMin(n.y1, below[k].y1);
+                n.x2 = qMax(n.x2, below[k].x2);
+                n.y2 = qMax(n.y2, below[k].y2);
+            }
+            level.append(n);
+        }
+        levels.append(level);
+    }
+}
+
+void RSegmentIndex::clear() {
+    shapes.clear();
+    levels.clear();
+}
+
+/**
+ * \return Indexes of all shapes whose bounding box intersects with the
+ * given box in X/Y, in ascending order.
+ */
+QList<int> RSegmentIndex::queryIntersected(const RBox& box) const {
+    QList<int> ret;
+    if (levels.isEmpty()) {
+        return ret;
+    }
+
+    RVector c1 = box.getMinimum();
+    RVector c2 = box.getMaximum();
+
+    // (level, index of first entry) of the nodes to visit:
+    QVector<QPair<int, int> > stack;
+    stack.append(qMakePair(levels.size()-1, 0));
+    while (!stack.isEmpty()) {
+        QPair<int, int> n = stack.last();
+        stack.resize(stack.size()-1);
+
+        const QVector<Entry>& level = levels[n.first];
+        int end = qMin(n.second+nodeSize, level.size());
+        for (int i=n.second; i<end; i++) {
+            const Entry& e = level[i];
+            if (e.x1 > c2.x || e.x2 < c1.x || e.y1 > c2.y || e.y2 < c1.y) {
+                continue;
+            }
+            if (n.first==0) {
+                ret.append(e.ref);
+            }
+            else {
+                stack.append(qMakePair(n.first-1, e.ref));
+            }
+        }
+    }
+
+    qSort(ret);
+    return ret;
+}
+
+/**
+ * \return All shapes whose bounding box intersects with the given box
+ * in X/Y, in their original order.
+ */
+QList<QSharedPointer<RShape> > RSegmentIndex::queryIntersectedShapes(const RBox& box) const {
+    QList<QSharedPointer<RShape> > ret;
+    QList<int> indexes = queryIntersected(box);
+    for (int i=0; i<indexes.size(); i++) {
+        ret.append(shapes.at(indexes[i]));
+    }
+    return ret;
+}
+
+/**
+ * Best-first search for the shape closest to the given point. Exact
+ * distances are only computed for shapes whose bounding box is closer
+ * than the closest shape found so far.
+ *
+ * \param distance Set to the distance of the closest shape.
+ *
+ * \return Index of the closest shape or -1.
+ */
+int RSegmentIndex::queryClosest(const RVector& point, double& distance) const {
+    int ret = -1;
+    distance = RNANDOUBLE;
+    if (levels.isEmpty()) {
+        return ret;
+    }
+
+    double minDist = RMAXDOUBLE;
+    std::priority_queue<RSegmentCandidate> queue;
+    queue.push(RSegmentCandidate(0.0, levels.size(), 0));
+    while (!queue.empty()) {
+        RSegmentCandidate c = queue.top();
+        queue.pop();
+
+        // no remaining shape can be closer:
+        if (c.dist >= minDist) {
+            break;
+        }
+
+        if (c.level==0) {
+            int i = levels[0][c.index].ref;
+            double dist = shapes.at(i)->getDistanceTo(point);
+            if (!RMath::isNaN(dist) && dist < minDist) {
+                minDist = dist;
+                ret = i;
+            }
+            continue;
+        }
+
+        // entries of the node (the root node if c.level is the top):
+        const QVector<Entry>& level = levels[c.level-1];
+        int start = c.level==levels.size() ? 0 : levels[c.level][c.index].ref;
+        int end = qMin(start+nodeSize, level.size());
+        for (int i=start; i<end; i++) {
+            const Entry& e = level[i];
+            double dx = point.x<e.x1 ? e.x1-point.x : (point.x>e.x2 ? point.x-e.x2 : 0.0);
+            double dy = point.y<e.y1 ? e.y1-point.y : (point.y>e.y2 ? point.y-e.y2 : 0.0);
+            queue.push(RSegmentCandidate(sqrt(dx*dx + dy*dy), c.level-1, i));
+        }
+    }
+
+    if (ret!=-1) {
+        distance = minDist;
+    }
+    return ret;
+}
+
+bool RSegmentIndex::lessX(const Entry& a, const Entry& b) {
+    return a.x1 + a.x2 < b.x1 + b.x2;
+}
+
+bool RSegmentIndex::lessY(const Entry& a, const Entry& b) {
+    return a.y1 + a.y2 < b.y1 + b.y2;
+}
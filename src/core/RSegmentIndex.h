@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2011-2013 by Andrew Mustun. All rights reserved.
+ * 
+ * This file is part of the QCAD project.
+ *
+ * QCAD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QCAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QCAD.
+ */
+
+#ifndef RSEGMENTINDEX_H
+#define RSEGMENTINDEX_H
+
+#include "core_global.h"
+
+#include <QList>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "RBox.h"
+#include "RShape.h"
+#include "RVector.h"
+
+/**
+ * \brief Static spatial index of the segments (sub-shapes) of one
+ * complex entity, for example a polyline with many vertices or a hatch.
+ *
+ * The index is built once from a list of shapes and packed into a
+ * two dimensional R-tree. It is used to find the few segments close to
+ * a query box or position without evaluating every segment.
+ *
+ * \ingroup core
+ */
+class QCADCORE_EXPORT RSegmentIndex {
+public:
+    /**
+     * Entities with fewer segments are not worth indexing.
+     */
+    static const int minSegments = 64;
+
+    RSegmentIndex();
+
+    void build(const QList<QSharedPointer<RShape> >& shapes);
+    void clear();
+
+    bool isEmpty() const {
+        return shapes.isEmpty();
+    }
+
+    int count() const {
+        return shapes.size();
+    }
+
+    QSharedPointer<RShape> getShape(int i) const {
+        return shapes.at(i);
+    }
+
+    QList<QSharedPointer<RShape> > getShapes() const {
+        return shapes;
+    }
+
+    QList<int> queryIntersected(const RBox& box) const;
+    QList<QSharedPointer<RShape> > queryIntersectedShapes(const RBox& box) const;
+    int queryClosest(const RVector& point, double& distance) const;
+
+private:
+    /**
+     * Two dimensional box of a segment or a node.
+     */
+    struct Entry {
+        double x1;
+        double y1;
+        double x2;
+        double y2;
+        int ref;
+    };
+
+    static bool lessX(const Entry& a, const Entry& b);
+    static bool lessY(const Entry& a, const Entry& b);
+
+private:
+    static const int nodeSize = 16;
+
+    /**
+     * Shapes in their original order.
+     */
+    QList<QSharedPointer<RShape> > shapes;
+    /**
+     * Levels of the packed tree, leaves first. The entries of level 0
+     * refer to shapes, entry i of level k covers entries
+     * [i*nodeSize, (i+1)*nodeSize) of level k-1.
+     */
+    QVector<QVector<Entry> > levels;
+};
+
+#endif
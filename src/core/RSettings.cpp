@@ -22,6 +22,7 @@
 #include <QFileInfo>
 #include <QFontMetrics>
 #include <QStringList>
+#include <QThread>
 #include <QTranslator>
 
 #if QT_VERSION >= 0x050000
@@ -51,6 +52,7 @@ int RSettings::concurrentDrawing = -1;
 int RSettings::previewEntities = -1;
 int RSettings::limitZoomAndScroll = -1;
 double RSettings::arcAngleLengthThreshold = -1;
+int RSettings::cacheGeneration = 0;
 QStringList RSettings::recentFiles;
 QLocale* RSettings::numberLocale = NULL;
 QString RSettings::applicationNameOverride;
@@ -619,6 +621,19 @@ void RSettings::setConcurrentDrawing(bool on) {
     concurrentDrawing = on;
 }
 
+/**
+ * \return Number of threads used to render graphics views. The setting
+ * GraphicsView/RenderThreads is 0 by default, which uses one thread per
+ * processor core.
+ */
+int RSettings::getRenderThreadCount() {
+    int ret = getValue("GraphicsView/RenderThreads", 0).toInt();
+    if (ret<=0) {
+        ret = QThread::idealThreadCount();
+    }
+    return qMax(ret, 1);
+}
+
 QLocale RSettings::getNumberLocale() {
     if (numberLocale==NULL) {
         if (getValue("Input/DecimalPoint", ".").toString()==",") {
@@ -787,6 +802,16 @@ void RSettings::resetCache() {
     limitZoomAndScroll = -1;
     arcAngleLengthThreshold = -1;
     cache.clear();
+    cacheGeneration++;
+}
+
+/**
+ * \return Number that changes every time the cache is reset, i.e. every
+ * time settings might have changed. Useful to detect if results
+ * that depend on settings are out of date.
+ */
+int RSettings::getCacheGeneration() {
+    return cacheGeneration;
 }
 
 void RSettings::uninit() {
@@ -119,6 +119,10 @@ public:
     static void setShowLargeCrosshair(bool on);
     static bool getConcurrentDrawing();
     static void setConcurrentDrawing(bool on);
+    /**
+     * \nonscriptable
+     */
+    static int getRenderThreadCount();
     static QLocale getNumberLocale();
 
     static void initRecentFiles();
@@ -145,6 +149,10 @@ public:
     static QSettings* getQSettings();
 
     static void resetCache();
+    /**
+     * \nonscriptable
+     */
+    static int getCacheGeneration();
 
     static void setXDataEnabled(bool on);
     static bool isXDataEnabled();
@@ -170,6 +178,7 @@ private:
     static int previewEntities;
     static int limitZoomAndScroll;
     static double arcAngleLengthThreshold;
+    static int cacheGeneration;
     static QStringList recentFiles;
     static QLocale* numberLocale;
 
@@ -16,8 +16,141 @@
  * You should have received a copy of the GNU General Public License
  * along with QCAD.
  */
+#include <QDataStream>
+
 #include "RSpatialIndex.h"
 
+namespace {
+
+/**
+ * Internal.
+ * Visitor that appends the (ID, position) pairs of all visited items
+ * to a vector.
+ */
+class RSiAppendVisitor : public RSpatialIndexVisitor {
+public:
+    RSiAppendVisitor(QVector<QPair<int, int> >& result) : result(result) {}
+
+    virtual void visitData(
+        int id,
+        int pos,
+        double x1, double y1, double z1,
+        double x2, double y2, double z2) {
+        Q_UNUSED(x1)
+        Q_UNUSED(y1)
+        Q_UNUSED(z1)
+        Q_UNUSED(x2)
+        Q_UNUSED(y2)
+        Q_UNUSED(z2)
+
+        result.append(qMakePair(id, pos));
+    }
+
+    virtual void visitNode(
+        double x1, double y1, double z1,
+        double x2, double y2, double z2) {
+        Q_UNUSED(x1)
+        Q_UNUSED(y1)
+        Q_UNUSED(z1)
+        Q_UNUSED(x2)
+        Q_UNUSED(y2)
+        Q_UNUSED(z2)
+    }
+
+private:
+    QVector<QPair<int, int> >& result;
+};
+
+/**
+ * Internal.
+ * Visitor that collects the bounding boxes of all visited items by ID
+ * and position.
+ */
+class RSiBoxVisitor : public RSpatialIndexVisitor {
+public:
+    RSiBoxVisitor(QMap<int, QMap<int, RBox> >& result) : result(result) {}
+
+    virtual void visitData(
+        int id,
+        int pos,
+        double x1, double y1, double z1,
+        double x2, double y2, double z2) {
+
+        result[id].insert(pos, RBox(RVector(x1, y1, z1), RVector(x2, y2, z2)));
+    }
+
+    virtual void visitNode(
+        double x1, double y1, double z1,
+        double x2, double y2, double z2) {
+        Q_UNUSED(x1)
+        Q_UNUSED(y1)
+        Q_UNUSED(z1)
+        Q_UNUSED(x2)
+        Q_UNUSED(y2)
+        Q_UNUSED(z2)
+    }
+
+private:
+    QMap<int, QMap<int, RBox> >& result;
+};
+
+/**
+ * Internal.
+ * Item with the X/Y distance of its bounding box to a query position.
+ */
+struct RSiDistanceEntry {
+    double dist;
+    int id;
+    int pos;
+
+    bool operator<(const RSiDistanceEntry& other) const {
+        return dist < other.dist;
+    }
+};
+
+/**
+ * Internal.
+ * Visitor that collects all visited items with the X/Y distance of their
+ * bounding boxes to the given position.
+ */
+class RSiDistanceVisitor : public RSpatialIndexVisitor {
+public:
+    RSiDistanceVisitor(double x, double y, QVector<RSiDistanceEntry>& result)
+        : x(x), y(y), result(result) {}
+
+    virtual void visitData(
+        int id,
+        int pos,
+        double x1, double y1, double z1,
+        double x2, double y2, double z2) {
+        Q_UNUSED(z1)
+        Q_UNUSED(z2)
+
+        double dx = qMax(0.0, qMax(qMin(x1, x2)-x, x-qMax(x1, x2)));
+        double dy = qMax(0.0, qMax(qMin(y1, y2)-y, y-qMax(y1, y2)));
+        RSiDistanceEntry e = { sqrt(dx*dx + dy*dy), id, pos };
+        result.append(e);
+    }
+
+    virtual void visitNode(
+        double x1, double y1, double z1,
+        double x2, double y2, double z2) {
+        Q_UNUSED(x1)
+        Q_UNUSED(y1)
+        Q_UNUSED(z1)
+        Q_UNUSED(x2)
+        Q_UNUSED(y2)
+        Q_UNUSED(z2)
+    }
+
+private:
+    double x;
+    double y;
+    QVector<RSiDistanceEntry>& result;
+};
+
+}
+
 void RSpatialIndexDebugVisitor::visitData(
     int id,
     int pos,
@@ -68,6 +201,16 @@ void RSpatialIndex::addToIndex(int id, int pos, const RBox& bb) {
     );
 }
 
+/**
+ * Default implementation: clears the index and adds all entries one by one.
+ */
+void RSpatialIndex::bulkLoad(const QList<int>& ids, const QList<QList<RBox> >& bbs) {
+    clear();
+    for (int i = 0; i < ids.size() && i < bbs.size(); ++i) {
+        addToIndex(ids[i], bbs[i]);
+    }
+}
+
 bool RSpatialIndex::removeFromIndex(int id, int pos, const RBox& bb) {
     return removeFromIndex(
         id, pos,
@@ -111,6 +254,53 @@ QMap<int, QSet<int> > RSpatialIndex::queryContained(const RBox& b,
     );
 }
 
+/**
+ * Default implementation: collects the result of the map based query
+ * with a visitor. Implementations should reimplement this to append
+ * the matches directly.
+ */
+void RSpatialIndex::queryIntersected(
+    double x1, double y1, double z1,
+    double x2, double y2, double z2,
+    QVector<QPair<int, int> >& result) {
+
+    RSiAppendVisitor v(result);
+    queryIntersected(x1, y1, z1, x2, y2, z2, &v);
+}
+
+void RSpatialIndex::queryIntersected(const RBox& b,
+    QVector<QPair<int, int> >& result) {
+
+    queryIntersected(
+        b.c1.x, b.c1.y, b.c1.z,
+        b.c2.x, b.c2.y, b.c2.z,
+        result
+    );
+}
+
+/**
+ * Default implementation: collects the result of the map based query
+ * with a visitor.
+ */
+void RSpatialIndex::queryContained(
+    double x1, double y1, double z1,
+    double x2, double y2, double z2,
+    QVector<QPair<int, int> >& result) {
+
+    RSiAppendVisitor v(result);
+    queryContained(x1, y1, z1, x2, y2, z2, &v);
+}
+
+void RSpatialIndex::queryContained(const RBox& b,
+    QVector<QPair<int, int> >& result) {
+
+    queryContained(
+        b.c1.x, b.c1.y, b.c1.z,
+        b.c2.x, b.c2.y, b.c2.z,
+        result
+    );
+}
+
 /**
  * Convenience implementation for scripts.
  */
@@ -124,6 +314,102 @@ QPair<int, int> RSpatialIndex::queryNearestNeighbor(double x, double y, double z
     return QPair<int, int>(keys.at(0), res[keys.at(0)].toList().first());
 }
 
+/**
+ * Default implementation for spatial indexes without native support:
+ * queries all items within \c maxDistance and evaluates them in
+ * order of the distance of their bounding boxes.
+ */
+QPair<int, int> RSpatialIndex::queryNearestNeighborXY(
+    double x, double y, double maxDistance,
+    RSpatialIndexDistanceFunction& distanceFunction) {
+
+    QVector<RSiDistanceEntry> candidates;
+    RSiDistanceVisitor v(x, y, candidates);
+    queryIntersected(
+        x-maxDistance, y-maxDistance, -RMAXDOUBLE,
+        x+maxDistance, y+maxDistance, RMAXDOUBLE,
+        &v
+    );
+    qSort(candidates.begin(), candidates.end());
+
+    QPair<int, int> ret(-1, -1);
+    double minDist = RMAXDOUBLE;
+    for (int i=0; i<candidates.size(); i++) {
+        const RSiDistanceEntry& c = candidates[i];
+        // no remaining item can be closer:
+        if (c.dist>maxDistance || c.dist>=minDist) {
+            break;
+        }
+
+        double dist = distanceFunction.getDistance(c.id, c.pos);
+        if (!RMath::isNaN(dist) && dist<=maxDistance && dist<minDist) {
+            minDist = dist;
+            ret = qMakePair(c.id, c.pos);
+        }
+    }
+
+    return ret;
+}
+
+bool RSpatialIndex::save(QDataStream& stream) {
+    QMap<int, QMap<int, RBox> > entries;
+    RSiBoxVisitor v(entries);
+    queryContained(
+        -RMAXDOUBLE, -RMAXDOUBLE, -RMAXDOUBLE,
+        RMAXDOUBLE, RMAXDOUBLE, RMAXDOUBLE,
+        &v
+    );
+
+    stream << (qint32)entries.size();
+    QMap<int, QMap<int, RBox> >::const_iterator it;
+    for (it=entries.constBegin(); it!=entries.constEnd(); ++it) {
+        QList<RBox> bbs = it.value().values();
+        stream << (qint32)it.key() << (qint32)bbs.size();
+        for (int i=0; i<bbs.size(); i++) {
+            const RBox& bb = bbs.at(i);
+            stream << bb.c1.x << bb.c1.y << bb.c1.z
+                   << bb.c2.x << bb.c2.y << bb.c2.z;
+        }
+    }
+
+    return stream.status()==QDataStream::Ok;
+}
+
+bool RSpatialIndex::load(QDataStream& stream) {
+    qint32 count;
+    stream >> count;
+    if (stream.status()!=QDataStream::Ok || count<0) {
+        return false;
+    }
+
+    QList<int> ids;
+    QList<QList<RBox> > bbs;
+    for (qint32 i=0; i<count; i++) {
+        qint32 id, n;
+        stream >> id >> n;
+        if (stream.status()!=QDataStream::Ok || n<0) {
+            return false;
+        }
+
+        QList<RBox> boxes;
+        for (qint32 k=0; k<n; k++) {
+            RBox bb;
+            stream >> bb.c1.x >> bb.c1.y >> bb.c1.z
+                   >> bb.c2.x >> bb.c2.y >> bb.c2.z;
+            boxes.append(bb);
+        }
+        ids.append(id);
+        bbs.append(boxes);
+    }
+
+    if (stream.status()!=QDataStream::Ok) {
+        return false;
+    }
+
+    bulkLoad(ids, bbs);
+    return true;
+}
+
 /**
  * Stream operator for QDebug
  */
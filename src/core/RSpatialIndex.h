@@ -27,13 +27,18 @@
 
 #include <QSet>
 #include <QList>
+#include <QPair>
+#include <QVector>
 
 #include "RBox.h"
 #include "RDebug.h"
 #include "RMath.h"
 #include "RRequireHeap.h"
+#include "RSpatialIndexDistanceFunction.h"
 #include "RSpatialIndexVisitor.h"
 
+class QDataStream;
+
 class QCADCORE_EXPORT RSpatialIndexDebugVisitor : public RSpatialIndexVisitor {
 public:
     RSpatialIndexDebugVisitor(QDebug dbg) : dbg(dbg) {}
@@ -78,6 +83,14 @@ public:
     static int getId(qint64 siid);
     static int getPos(qint64 siid);
 
+    /**
+     * \return A new, empty spatial index of the same type. Used to
+     * create additional indexes, e.g. one index per block.
+     *
+     * \nonscriptable
+     */
+    virtual RSpatialIndex* create() = 0;
+
     virtual void clear() = 0;
 
     /**
@@ -106,6 +119,16 @@ public:
         const QList<RBox>& bbs
     );
 
+    /**
+     * Replaces the contents of this spatial index with the given entries.
+     * ids[i] is added at the positions of the boxes in bbs[i]. This is
+     * much faster than adding the entries one by one for implementations
+     * that support bulk loading.
+     *
+     * \nonscriptable
+     */
+    virtual void bulkLoad(const QList<int>& ids, const QList<QList<RBox> >& bbs);
+
     /**
      * Removes the entry with the given ID from this spatial index.
      */
@@ -189,6 +212,49 @@ public:
         RSpatialIndexVisitor* dataVisitor=NULL
     );
 
+    /**
+     * Queries the index for all items that are completely inside or intersect
+     * with the given box and appends their (ID, position) pairs to \c result.
+     * Unlike the other query functions, no map or set is built for the
+     * result, so the caller can reuse \c result for many queries.
+     * An ID is appended once for every matching position.
+     *
+     * \nonscriptable
+     */
+    virtual void queryIntersected(
+        double x1, double y1, double z1,
+        double x2, double y2, double z2,
+        QVector<QPair<int, int> >& result
+    );
+
+    /**
+     * \nonscriptable
+     */
+    virtual void queryIntersected(
+        const RBox& b,
+        QVector<QPair<int, int> >& result
+    );
+
+    /**
+     * Queries the index for all items that are completely inside the given
+     * box and appends their (ID, position) pairs to \c result.
+     *
+     * \nonscriptable
+     */
+    virtual void queryContained(
+        double x1, double y1, double z1,
+        double x2, double y2, double z2,
+        QVector<QPair<int, int> >& result
+    );
+
+    /**
+     * \nonscriptable
+     */
+    virtual void queryContained(
+        const RBox& b,
+        QVector<QPair<int, int> >& result
+    );
+
     /**
      * Queries the index for closest neighbor items.
      *
@@ -206,6 +272,43 @@ public:
 
     virtual QPair<int, int> queryNearestNeighbor(double x, double y, double z);
 
+    /**
+     * Queries the index for the item closest to the given position in
+     * X/Y. Items are visited in order of the distance of their bounding
+     * boxes. The exact distance is computed by \c distanceFunction only
+     * for items whose bounding box is closer than the closest item found
+     * so far.
+     *
+     * \param maxDistance Items further away are ignored.
+     *
+     * \return (ID, position) of the closest item or (-1, -1).
+     *
+     * \nonscriptable
+     */
+    virtual QPair<int, int> queryNearestNeighborXY(
+        double x, double y, double maxDistance,
+        RSpatialIndexDistanceFunction& distanceFunction
+    );
+
+    /**
+     * Writes the contents of this index to the given stream. The default
+     * implementation writes all entries, implementations may write their
+     * internal structure to avoid rebuilding it in \ref load.
+     *
+     * \nonscriptable
+     */
+    virtual bool save(QDataStream& stream);
+
+    /**
+     * Replaces the contents of this index with the contents written by
+     * \ref save of an index of the same type.
+     *
+     * \return False if the stream is invalid.
+     *
+     * \nonscriptable
+     */
+    virtual bool load(QDataStream& stream);
+
 protected:
     int idCounter;
 };
@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2011-2013 by Andrew Mustun. All rights reserved.
+ * 
+ * This file is part of the QCAD project.
+ *
+ * QCAD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QCAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QCAD.
+ */
+#include <typeinfo>
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "RDocument.h"
+#include "REntity.h"
+#include "RSettings.h"
+#include "RSpatialIndex.h"
+#include "RSpatialIndexCache.h"
+#include "RStorage.h"
+
+namespace {
+    const quint32 magic = 0x52534943;
+    const qint32 formatVersion = 2;
+}
+
+bool RSpatialIndexCache::isEnabled() {
+    return RSettings::getBoolValue("SpatialIndex/Cache", false);
+}
+
+/**
+ * \return Path of the cache file for the given drawing file.
+ */
+QString RSpatialIndexCache::getCacheFileName(const QString& fileName) {
+    QString abs = QFileInfo(fileName).absoluteFilePath();
+    QByteArray hash = QCryptographicHash::hash(abs.toUtf8(), QCryptographicHash::Sha1);
+    return RSettings::getCacheLocation() + QDir::separator()
+        + "SpatialIndex" + QDir::separator()
+        + QString(hash.toHex()) + ".dat";
+}
+
+/**
+ * \return True if there is a cache file for the given drawing file
+ * which matches its current size and modification time. Used before
+ * importing to decide whether the spatial index needs to be built
+ * during the import.
+ */
+bool RSpatialIndexCache::isValid(RDocument& document, const QString& fileName) {
+    QFile file(getCacheFileName(fileName));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+    return readHeader(stream, document, fileName, false);
+}
+
+/**
+ * Loads the spatial indexes of the given document, which has just been
+ * imported from the given drawing file, from the cache.
+ *
+ * \return False if the cache is missing, outdated or does not match
+ * the contents of the document.
+ */
+bool RSpatialIndexCache::load(RDocument& document, const QString& fileName) {
+    QFile file(getCacheFileName(fileName));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+    if (!readHeader(stream, document, fileName, true)) {
+        return false;
+    }
+
+    return document.loadSpatialIndex(stream);
+}
+
+/**
+ * Writes the spatial indexes of the given document to the cache file
+ * of the given drawing file. The cache file is written to a temporary
+ * file first and then renamed, so readers never see partial files.
+ */
+bool RSpatialIndexCache::save(RDocument& document, const QString& fileName) {
+    QString cacheFileName = getCacheFileName(fileName);
+    QDir().mkpath(QFileInfo(cacheFileName).absolutePath());
+
+    QString tmpFileName = cacheFileName + ".tmp";
+    QFile file(tmpFileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "RSpatialIndexCache::save: cannot write " << tmpFileName;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+    writeHeader(stream, document, fileName);
+    bool ok = document.saveSpatialIndex(stream);
+    file.close();
+
+    if (!ok || file.error()!=QFile::NoError) {
+        QFile::remove(tmpFileName);
+        return false;
+    }
+
+    QFile::remove(cacheFileName);
+    if (!QFile::rename(tmpFileName, cacheFileName)) {
+        QFile::remove(tmpFileName);
+        return false;
+    }
+    return true;
+}
+
+void RSpatialIndexCache::writeHeader(QDataStream& stream, RDocument& document,
+    const QString& fileName) {
+
+    QFileInfo fi(fileName);
+
+    stream << magic;
+    stream << formatVersion;
+    stream << fi.absoluteFilePath();
+    stream << (qint64)fi.size();
+    stream << (qint64)fi.lastModified().toMSecsSinceEpoch();
+    stream << RSettings::getVersionString();
+    stream << QString(typeid(document.getSpatialIndex()).name());
+    stream << (qint32)document.getStorage().getMaxObjectId();
+    stream << getContentHash(document);
+}
+
+/**
+ * \return Hash of the ID, type, layer and block of all entities of the
+ * given document. Used to make sure that the entity IDs of the cache
+ * refer to the same entities as the IDs of the imported document.
+ */
+QByteArray RSpatialIndexCache::getContentHash(RDocument& document) {
+    QList<REntity::Id> ids = document.queryAllEntities(false, true).toList();
+    qSort(ids);
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    for (int i=0; i<ids.size(); i++) {
+        QSharedPointer<REntity> entity = document.queryEntityDirect(ids[i]);
+        if (entity.isNull()) {
+            continue;
+        }
+        stream << (qint32)ids[i] << (qint32)entity->getType()
+               << (qint32)entity->getLayerId() << (qint32)entity->getBlockId();
+    }
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Md5);
+}
+
+/**
+ * Reads and checks the header of a cache file. Cache files written by
+ * other versions of QCAD are not used.
+ *
+ * \param checkContents True to also compare the highest object ID and
+ * the content hash (see \ref getContentHash) with the (imported) document.
+ */
+bool RSpatialIndexCache::readHeader(QDataStream& stream, RDocument& document,
+    const QString& fileName, bool checkContents) {
+
+    QFileInfo fi(fileName);
+
+    quint32 m;
+    qint32 version;
+    QString path;
+    qint64 size;
+    qint64 lastModified;
+    QString appVersion;
+    QString type;
+    qint32 maxObjectId;
+    QByteArray contentHash;
+
+    stream >> m >> version;
+    if (stream.status()!=QDataStream::Ok || m!=magic || version!=formatVersion) {
+        return false;
+    }
+
+    stream >> path >> size >> lastModified >> appVersion >> type >> maxObjectId >> contentHash;
+    if (stream.status()!=QDataStream::Ok) {
+        return false;
+    }
+
+    if (path!=fi.absoluteFilePath() ||
+        size!=fi.size() ||
+        lastModified!=fi.lastModified().toMSecsSinceEpoch() ||
+        appVersion!=RSettings::getVersionString() ||
+        type!=QString(typeid(document.getSpatialIndex()).name())) {
+        return false;
+    }
+
+    if (checkContents) {
+        if (maxObjectId!=document.getStorage().getMaxObjectId() ||
+            contentHash!=getContentHash(document)) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2011-2013 by Andrew Mustun. All rights reserved.
+ * 
+ * This file is part of the QCAD project.
+ *
+ * QCAD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QCAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QCAD.
+ */
+
+#ifndef RSPATIALINDEXCACHE_H_
+#define RSPATIALINDEXCACHE_H_
+
+#include "core_global.h"
+
+#include <QByteArray>
+#include <QString>
+
+class QDataStream;
+class RDocument;
+
+/**
+ * Stores the spatial indexes of a drawing in a cache file next to the
+ * other application caches, so that reopening an unchanged drawing does
+ * not have to rebuild them. Cache files are keyed by the absolute path
+ * of the drawing and are only used as long as size and modification
+ * time of the drawing file are unchanged. Cache files are only written
+ * right after a drawing has been imported, since only then the object
+ * IDs of the document are those assigned by the importer.
+ *
+ * The cache is disabled unless the setting SpatialIndex/Cache is true.
+ *
+ * \ingroup core
+ * \nonscriptable
+ */
+class QCADCORE_EXPORT RSpatialIndexCache {
+public:
+    static bool isEnabled();
+    static QString getCacheFileName(const QString& fileName);
+
+    static bool isValid(RDocument& document, const QString& fileName);
+    static bool load(RDocument& document, const QString& fileName);
+    static bool save(RDocument& document, const QString& fileName);
+
+private:
+    static bool readHeader(QDataStream& stream, RDocument& document,
+        const QString& fileName, bool checkContents);
+    static void writeHeader(QDataStream& stream, RDocument& document,
+        const QString& fileName);
+    static QByteArray getContentHash(RDocument& document);
+};
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * Copyright (c) 2011-2013 by Andrew Mustun. All rights reserved.
+ * 
+ * This file is part of the QCAD project.
+ *
+ * QCAD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QCAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QCAD.
+ */
+
+#ifndef RSPATIALINDEXDISTANCEFUNCTION_H
+#define RSPATIALINDEXDISTANCEFUNCTION_H
+
+#include "core_global.h"
+
+/**
+ * \brief Abstract base class for exact distance computations used by
+ * nearest neighbor queries of spatial indexes.
+ *
+ * The spatial index only knows the bounding boxes of its items. The
+ * distance function computes the exact distance between the query
+ * position and an item. It is only called for items whose bounding box
+ * is closer to the query position than the closest item found so far.
+ *
+ * \ingroup core
+ */
+class QCADCORE_EXPORT RSpatialIndexDistanceFunction {
+public:
+    virtual ~RSpatialIndexDistanceFunction() {}
+
+    /**
+     * \return Exact distance between the query position and the item
+     * with the given ID and position. The distance must not be less
+     * than the distance between the query position and the bounding
+     * box of the item. RMAXDOUBLE or NaN if the item is not a
+     * candidate for the query.
+     */
+    virtual double getDistance(int id, int pos) = 0;
+};
+
+#endif
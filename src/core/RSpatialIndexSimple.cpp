@@ -25,6 +25,10 @@ RSpatialIndexSimple::RSpatialIndexSimple() {
 RSpatialIndexSimple::~RSpatialIndexSimple() {
 }
 
+RSpatialIndex* RSpatialIndexSimple::create() {
+    return new RSpatialIndexSimple();
+}
+
 void RSpatialIndexSimple::clear() {
     si.clear();
 }
@@ -68,7 +72,7 @@ bool RSpatialIndexSimple::removeFromIndex(int id, const QList<RBox>& bb) {
 QMap<int, QSet<int> > RSpatialIndexSimple::queryIntersected(
     double x1, double y1, double z1,
     double x2, double y2, double z2,
-    RSpatialIndexVisitor* /*dataVisitor*/) {
+    RSpatialIndexVisitor* dataVisitor) {
     
     RBox box(RVector(x1,y1,z1),RVector(x2,y2,z2));
     QMap<int, QSet<int> > res;
@@ -79,6 +83,12 @@ QMap<int, QSet<int> > RSpatialIndexSimple::queryIntersected(
             if (box.intersects(bbs.at(i))) {
                 //res.insert(it.key());
                 res[it.key()].insert(i);
+                if (dataVisitor!=NULL) {
+                    const RBox& bb = bbs.at(i);
+                    dataVisitor->visitData(it.key(), i,
+                        bb.c1.x, bb.c1.y, bb.c1.z,
+                        bb.c2.x, bb.c2.y, bb.c2.z);
+                }
             }
         }
     }
@@ -89,7 +99,7 @@ QMap<int, QSet<int> > RSpatialIndexSimple::queryIntersected(
 QMap<int, QSet<int> > RSpatialIndexSimple::queryContained(
     double x1, double y1, double z1,
     double x2, double y2, double z2,
-    RSpatialIndexVisitor* /*dataVisitor*/) {
+    RSpatialIndexVisitor* dataVisitor) {
 
     RBox box(RVector(x1,y1,z1),RVector(x2,y2,z2));
     QMap<int, QSet<int> > res;
@@ -100,6 +110,12 @@ QMap<int, QSet<int> > RSpatialIndexSimple::queryContained(
             if (box.contains(bbs.at(i))) {
                 //res.insert(it.key());
                 res[it.key()].insert(i);
+                if (dataVisitor!=NULL) {
+                    const RBox& bb = bbs.at(i);
+                    dataVisitor->visitData(it.key(), i,
+                        bb.c1.x, bb.c1.y, bb.c1.z,
+                        bb.c2.x, bb.c2.y, bb.c2.z);
+                }
             }
         }
     }
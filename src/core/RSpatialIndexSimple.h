@@ -42,6 +42,11 @@ public:
     RSpatialIndexSimple();
     virtual ~RSpatialIndexSimple();
 
+    /**
+     * \nonscriptable
+     */
+    virtual RSpatialIndex* create();
+
     virtual void clear();
 
     /**
@@ -16,11 +16,14 @@
  * You should have received a copy of the GNU General Public License
  * along with QCAD.
  */
+#include <QtAlgorithms>
+
 #include "RSettings.h"
 #include "RStorage.h"
 
 RStorage::RStorage() :
     modified(false),
+    document(NULL),
     maxDrawOrder(0),
     idCounter(0),
     handleCounter(0),
@@ -51,6 +54,14 @@ void RStorage::setObjectHandle(RObject& object, RObject::Handle objectHandle) {
     }
 }
 
+/**
+ * Sets the parent ID of the given entity. Entities that are already stored
+ * must be reparented through this function to keep storage indexes intact.
+ */
+void RStorage::setEntityParentId(REntity& entity, REntity::Id parentId) {
+    entity.setParentId(parentId);
+}
+
 RObject::Id RStorage::getNewObjectId() {
     return idCounter++;
 }
@@ -124,6 +135,54 @@ QList<REntity::Id> RStorage::orderBackToFront(const QSet<REntity::Id>& entityIds
     return res.values();
 }
 
+void RStorage::orderBackToFront(QVector<REntity::Id>& entityIds) const {
+    QVector<QPair<int, REntity::Id> > sorted;
+    sorted.reserve(entityIds.size());
+    for (int i=0; i<entityIds.size(); i++) {
+        QSharedPointer<REntity> e = queryEntityDirect(entityIds[i]);
+        if (!e.isNull()) {
+            sorted.append(qMakePair(e->getDrawOrder(), entityIds[i]));
+        }
+    }
+    qSort(sorted.begin(), sorted.end());
+
+    entityIds.resize(sorted.size());
+    for (int i=0; i<sorted.size(); i++) {
+        entityIds[i] = sorted[i].second;
+    }
+}
+
+/**
+ * \return Number of entities on the given layer in all blocks.
+ * Implementations may reimplement this to return a maintained count.
+ */
+int RStorage::getLayerEntityCount(RLayer::Id layerId) {
+    return queryLayerEntities(layerId, true).size();
+}
+
+/**
+ * \return Number of entities in the given block.
+ */
+int RStorage::getBlockEntityCount(RBlock::Id blockId) {
+    return queryBlockEntities(blockId).size();
+}
+
+/**
+ * \return Number of entities of the given type in all blocks.
+ */
+int RStorage::getEntityTypeCount(RS::EntityType type) {
+    int ret = 0;
+    QSet<REntity::Id> entityIds = queryAllEntities(false, true);
+    QSet<REntity::Id>::const_iterator it;
+    for (it = entityIds.begin(); it != entityIds.end(); ++it) {
+        QSharedPointer<REntity> e = queryEntityDirect(*it);
+        if (!e.isNull() && e->getType()==type) {
+            ret++;
+        }
+    }
+    return ret;
+}
+
 int RStorage::getMinDrawOrder() {
     QSet<REntity::Id> entityIds = queryAllEntities(false, false);
     QSet<REntity::Id>::const_iterator it;
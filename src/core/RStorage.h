@@ -24,6 +24,7 @@
 
 #include <QString>
 #include <QSharedPointer>
+#include <QVector>
 
 #include "RBlock.h"
 #include "RBlockReferenceEntity.h"
@@ -38,6 +39,7 @@
 #include "RUcs.h"
 #include "RView.h"
 
+class RDocument;
 
 /**
  * This is the abstract base class for all storage implementations.
@@ -45,7 +47,13 @@
  * transactions) in memory or on disk. Every \ref RDocument "document"
  * is backed by a storage object.
  *
- * A storage implementation is available in the \ref qcaddbstorage.
+ * \ref RMemoryStorage is the storage implementation used for documents,
+ * \ref RLinkedStorage is used for previews.
+ *
+ * Implementations must return the same object instance from the
+ * query...Direct functions for as long as an object is stored, since
+ * transactions, indexes and exporters keep and compare these pointers.
+ * The other query functions return independent clones.
  *
  * \ingroup core
  * \scriptable
@@ -60,6 +68,24 @@ public:
      */
     virtual void clear();
 
+    /**
+     * Sets the document this storage belongs to. Called by the document.
+     *
+     * \nonscriptable
+     */
+    void setDocument(RDocument* d) {
+        document = d;
+    }
+
+    /**
+     * \return The document this storage belongs to or NULL.
+     *
+     * \nonscriptable
+     */
+    RDocument* getDocument() const {
+        return document;
+    }
+
     /**
      * Starts a new transaction.
      * This function is called before something is stored in the
@@ -85,6 +111,14 @@ public:
      */
     virtual QList<REntity::Id> orderBackToFront(const QSet<REntity::Id>& entityIds) const;
 
+    /**
+     * Sorts the given IDs back to front for display purposes. IDs of
+     * entities that don't exist are removed.
+     *
+     * \nonscriptable
+     */
+    virtual void orderBackToFront(QVector<REntity::Id>& entityIds) const;
+
     /**
      * \return A set of all object IDs of the document.
      */
@@ -151,6 +185,10 @@ public:
      */
     virtual QSet<REntity::Id> queryAllBlockReferences() = 0;
 
+    virtual int getLayerEntityCount(RLayer::Id layerId);
+    virtual int getBlockEntityCount(RBlock::Id blockId);
+    virtual int getEntityTypeCount(RS::EntityType type);
+
     /**
      * \return A set of entity IDs of all selected entities.
      */
@@ -167,6 +205,21 @@ public:
     }
     virtual QSharedPointer<RObject> queryObjectByHandle(RObject::Handle objectHandle) const = 0;
 
+    /**
+     * \return A read-only pointer to the stored object with the given
+     *      \c objectId or null pointer. Unlike \ref queryObject, no copy
+     *      is made. Transactions replace changed objects with new instances
+     *      instead of modifying them in place, so the returned object stays
+     *      valid (and unchanged apart from its selection and undo status)
+     *      as long as it is referenced. Callers that need to modify the
+     *      object use \ref queryObject to get their own copy.
+     *
+     * \nonscriptable
+     */
+    QSharedPointer<const RObject> queryObjectConst(RObject::Id objectId) const {
+        return queryObjectDirect(objectId);
+    }
+
     /**
      * \return A pointer to the enitity with the given \c entityId
      *      or NULL if no such entity exists.
@@ -177,6 +230,17 @@ public:
         return queryEntity(entityId);
     }
 
+    /**
+     * \return A read-only pointer to the stored entity with the given
+     *      \c entityId or null pointer.
+     * \see queryObjectConst
+     *
+     * \nonscriptable
+     */
+    QSharedPointer<const REntity> queryEntityConst(REntity::Id entityId) const {
+        return queryEntityDirect(entityId);
+    }
+
     /**
      * \return A pointer to the UCS with the given \c ucsId
      *      or NULL if no such UCS exists.
@@ -203,6 +267,17 @@ public:
         return queryLayer(layerId);
     }
 
+    /**
+     * \return A read-only pointer to the stored layer with the given
+     *      \c layerId or null pointer.
+     * \see queryObjectConst
+     *
+     * \nonscriptable
+     */
+    QSharedPointer<const RLayer> queryLayerConst(RLayer::Id layerId) const {
+        return queryLayerDirect(layerId);
+    }
+
     /**
      * \return A pointer to the layer with the given \c layerName
      *      or NULL if no such layer exists.
@@ -223,6 +298,17 @@ public:
 
     virtual QSharedPointer<RBlock> queryBlock(RBlock::Id blockId) const = 0;
     virtual QSharedPointer<RBlock> queryBlockDirect(RBlock::Id blockId) const = 0;
+
+    /**
+     * \return A read-only pointer to the stored block with the given
+     *      \c blockId or null pointer.
+     * \see queryObjectConst
+     *
+     * \nonscriptable
+     */
+    QSharedPointer<const RBlock> queryBlockConst(RBlock::Id blockId) const {
+        return queryBlockDirect(blockId);
+    }
     virtual QSharedPointer<RBlock> queryBlock(const QString& blockName) const = 0;
 
     virtual QSharedPointer<RView> queryView(RView::Id viewId) const = 0;
@@ -444,7 +530,8 @@ public:
     }
 
     void setObjectId(RObject& object, RObject::Id objectId);
-    void setObjectHandle(RObject& object, RObject::Handle objectHandle);
+    virtual void setObjectHandle(RObject& object, RObject::Handle objectHandle);
+    virtual void setEntityParentId(REntity& entity, REntity::Id parentId);
 
     /**
      * \return True if at least one entity is selected in this storage.
@@ -577,6 +664,7 @@ public:
 
 protected:
     bool modified;
+    RDocument* document;
 
 private:
     int maxDrawOrder;
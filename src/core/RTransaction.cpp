@@ -150,7 +150,7 @@ void RTransaction::redo(RDocument* document) {
             if (object->isUndone()) {
                 QSharedPointer<REntity> entity = object.dynamicCast<REntity>();
 
-                object->setUndone(false);
+                storage->setUndoStatus(objId, false);
 
                 if (!spatialIndexDisabled && !entity.isNull()) {
                     document->addToSpatialIndex(entity);
@@ -161,7 +161,7 @@ void RTransaction::redo(RDocument* document) {
                 if (!spatialIndexDisabled && !entity.isNull()) {
                     document->removeFromSpatialIndex(entity);
                 }
-                object->setUndone(true);
+                storage->setUndoStatus(objId, true);
             }
         }
 
@@ -219,7 +219,7 @@ void RTransaction::undo(RDocument* document) {
             // toggle undo status of affected object:
             if (object->isUndone()) {
                 QSharedPointer<REntity> entity = object.dynamicCast<REntity>();
-                object->setUndone(false);
+                storage->setUndoStatus(objId, false);
                 if (!spatialIndexDisabled && !entity.isNull()) {
                     document->addToSpatialIndex(entity);
                 }
@@ -229,7 +229,7 @@ void RTransaction::undo(RDocument* document) {
                 if (!spatialIndexDisabled && !entity.isNull()) {
                     document->removeFromSpatialIndex(entity);
                 }
-                object->setUndone(true);
+                storage->setUndoStatus(objId, true);
             }
         }
 
@@ -288,7 +288,7 @@ void RTransaction::endCycle() {
 
         REntity::Id parentId = entity->getParentId();
         if (cloneIds.contains(parentId)) {
-            entity->setParentId(cloneIds.value(parentId, REntity::INVALID_ID));
+            storage->setEntityParentId(*entity, cloneIds.value(parentId, REntity::INVALID_ID));
         }
     }
     cloneIds.clear();
@@ -313,6 +313,11 @@ void RTransaction::commit() {
     }
 
     updateOverwrittenBlockReferences();
+
+    // update block references in the spatial index:
+    if (!spatialIndexDisabled && storage->getDocument()!=NULL) {
+        storage->getDocument()->commitSpatialIndex();
+    }
 }
 
 void RTransaction::fail() {
@@ -495,11 +500,13 @@ bool RTransaction::addObject(QSharedPointer<RObject> object,
         // note that we delete the OLD entity here
         // (old entity is queried from storage since we pass the ID here):
         deleteObject(entity->getId(), entity->getDocument());
-        addObject(clone, useCurrentAttributes, false, modifiedPropertyTypeIds);
-
-        // draw order was set to top value automatically by
-        // saveObject of RMemoryStorage:
-        clone->setDrawOrder(entity->getDrawOrder());
+        if (addObject(clone, useCurrentAttributes, false, modifiedPropertyTypeIds)) {
+            // draw order was set to top value automatically by
+            // saveObject of RMemoryStorage, save again with the original
+            // draw order to update the draw order index of the storage:
+            clone->setDrawOrder(entity->getDrawOrder());
+            storage->saveObject(clone, false, true);
+        }
         return true;
     }
 
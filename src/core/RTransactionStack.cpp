@@ -82,6 +82,7 @@ RTransaction RTransactionStack::undo() {
     storage.setLastTransactionId(lastTransactionId-1);
 
     lastTransaction.undo(&document);
+    document.commitSpatialIndex();
 
     return lastTransaction;
 }
@@ -113,6 +114,7 @@ RTransaction RTransactionStack::redo() {
     //std::set<REntity::Id> affectedEntities = lastTransaction.getAffectedEntities();
     //storage.toggleUndoStatus(affectedEntities);
     lastTransaction.redo(&document);
+    document.commitSpatialIndex();
 
     return lastTransaction;
 }
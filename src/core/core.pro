@@ -36,6 +36,7 @@ SOURCES += \
     RLocalPeer.cpp \
     RLockedFile.cpp \
     RMainWindow.cpp \
+    RMemoryPool.cpp \
     RMemoryStorage.cpp \
     RMouseEvent.cpp \
     RNavigationAction.cpp \
@@ -60,10 +61,12 @@ SOURCES += \
     RScriptAction.cpp \
     RScriptHandler.cpp \
     RScriptHandlerRegistry.cpp \
+    RSegmentIndex.cpp \
     RSettings.cpp \
     RSingleApplication.cpp \
     RSingleton.cpp \
     RSpatialIndex.cpp \
+    RSpatialIndexCache.cpp \
     RSpatialIndexSimple.cpp \
     RStorage.cpp \
     RTabletEvent.cpp \
@@ -143,6 +146,7 @@ HEADERS = \
     RLocalPeer.h \
     RLockedFile.h \
     RMainWindow.h \
+    RMemoryPool.h \
     RMemoryStorage.h \
     RMetaTypes.h \
     RMessageHandler.h \
@@ -182,6 +186,7 @@ HEADERS = \
     RScriptAction.h \
     RScriptHandler.h \
     RScriptHandlerRegistry.h \
+    RSegmentIndex.h \
     RSelectionChangedEvent.h \
     RSelectionListener.h \
     RSettings.h \
@@ -190,6 +195,8 @@ HEADERS = \
     RSnap.h \
     RSnapRestriction.h \
     RSpatialIndex.h \
+    RSpatialIndexCache.h \
+    RSpatialIndexDistanceFunction.h \
     RSpatialIndexSimple.h \
     RSpatialIndexVisitor.h \
     RStorage.h \
@@ -78,6 +78,7 @@ RHatchData& RHatchData::operator =(const RHatchData& other) {
     boundaryPath = other.boundaryPath;
     dirty = other.dirty;
     gotDraft = other.gotDraft;
+    segmentIndex = other.segmentIndex;
 
     boundary.clear();
 
@@ -168,12 +169,22 @@ double RHatchData::getDistanceTo(const RVector& point, bool limited, double rang
 
     // path is not filled and relatively simple (simple hatch):
     else {
-        for (int i=0; i<painterPaths.count(); i++) {
-            double d = painterPaths[i].getDistanceTo(point);
-            if (RMath::isNaN(ret) || d<ret) {
+        const RSegmentIndex* si = getSegmentIndex();
+        if (si!=NULL) {
+            // evaluate only the pattern segments near the point:
+            double d;
+            if (si->queryClosest(point, d)!=-1) {
                 ret = d;
             }
         }
+        else {
+            for (int i=0; i<painterPaths.count(); i++) {
+                double d = painterPaths[i].getDistanceTo(point);
+                if (RMath::isNaN(ret) || d<ret) {
+                    ret = d;
+                }
+            }
+        }
     }
 
     return ret;
@@ -436,7 +447,13 @@ bool RHatchData::stretch(const RPolyline& area, const RVector& offset) {
 }
 
 QList<QSharedPointer<RShape> > RHatchData::getShapes(const RBox& queryBox) const {
-    Q_UNUSED(queryBox)
+    // complex hatches: only the segments near the query box:
+    if (queryBox.isValid()) {
+        const RSegmentIndex* si = getSegmentIndex();
+        if (si!=NULL) {
+            return si->queryIntersectedShapes(queryBox);
+        }
+    }
 
     QList<QSharedPointer<RShape> > shapes;
 
@@ -510,6 +527,7 @@ QList<RPainterPath> RHatchData::getPainterPaths(bool draft) const {
     }
 
     painterPaths.clear();
+    segmentIndex.clear();
 
     getBoundaryPath();
 
@@ -744,6 +762,9 @@ QList<RPainterPath> RHatchData::getPainterPaths(bool draft) const {
                     if (!path.isEmpty()) {
                         //clippedPattern.addPath(path);
                         path.setPen(QPen(Qt::SolidLine));
+                        // distance between pattern lines, patterns that are
+                        // too dense are not displayed:
+                        path.setFeatureSize(qAbs(patternLine.offset.y));
                         painterPaths.append(path);
                     }
                 }
@@ -1101,6 +1122,22 @@ QList<QSharedPointer<RShape> > RHatchData::getLoopBoundary(int index) const {
     return boundary[index];
 }
 
+/**
+ * \return Index of the segments of this hatch or NULL if the hatch has
+ * too few segments to be worth indexing. The index is built on demand
+ * and cleared whenever the painter paths are rebuilt.
+ */
+const RSegmentIndex* RHatchData::getSegmentIndex() const {
+    if (getComplexity() < RSegmentIndex::minSegments) {
+        return NULL;
+    }
+
+    if (segmentIndex.isEmpty()) {
+        segmentIndex.build(getShapes());
+    }
+    return &segmentIndex;
+}
+
 int RHatchData::getComplexity() const {
     QList<RPainterPath> pps = getPainterPaths(false);
 
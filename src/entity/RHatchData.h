@@ -29,6 +29,7 @@
 #include "RPainterPath.h"
 #include "RPainterPathSource.h"
 #include "RPoint.h"
+#include "RSegmentIndex.h"
 #include "RVector.h"
 
 /**
@@ -150,6 +151,7 @@ public:
 
 protected:
     QList<RLine> getSegments(const RLine& line) const;
+    const RSegmentIndex* getSegmentIndex() const;
 
 private:
     bool solid;
@@ -167,6 +169,11 @@ private:
     mutable QList<RPainterPath> painterPaths;
     mutable bool dirty;
     mutable bool gotDraft;
+    /**
+     * Index of the segments of complex hatch patterns, cleared whenever
+     * the painter paths are rebuilt.
+     */
+    mutable RSegmentIndex segmentIndex;
 };
 
 Q_DECLARE_METATYPE(RHatchData)
@@ -19,11 +19,12 @@
 #include "RPolylineData.h"
 #include "RPolylineEntity.h"
 
-RPolylineData::RPolylineData() {
+RPolylineData::RPolylineData() :
+    segmentIndexClosed(false) {
 }
 
 RPolylineData::RPolylineData(RDocument* document, const RPolylineData& data)
-    : REntityData(document) {
+    : REntityData(document), segmentIndexClosed(false) {
 
     *this = data;
     this->document = document;
@@ -33,7 +34,73 @@ RPolylineData::RPolylineData(RDocument* document, const RPolylineData& data)
 }
 
 RPolylineData::RPolylineData(const RPolyline& line) :
-    RPolyline(line) {
+    RPolyline(line), segmentIndexClosed(false) {
+}
+
+/**
+ * \return Index of the segments of this polyline or NULL if the polyline
+ * has too few segments to be worth indexing.
+ *
+ * The index is built when it is first requested and rebuilt when it is
+ * requested after the geometry has changed.
+ */
+const RSegmentIndex* RPolylineData::getSegmentIndex() const {
+    if (countSegments() < RSegmentIndex::minSegments) {
+        return NULL;
+    }
+
+    // comparing the lists is cheap as long as they are still shared:
+    if (segmentIndexClosed!=closed ||
+        segmentIndexVertices!=vertices ||
+        segmentIndexBulges!=bulges) {
+
+        segmentIndex.clear();
+        segmentIndexVertices = vertices;
+        segmentIndexBulges = bulges;
+        segmentIndexClosed = closed;
+    }
+
+    if (segmentIndex.isEmpty()) {
+        segmentIndex.build(getExploded());
+    }
+    return &segmentIndex;
+}
+
+/**
+ * \return Segments of this polyline that intersect with the given box.
+ */
+QList<QSharedPointer<RShape> > RPolylineData::getSegmentsIn(const RBox& queryBox) const {
+    const RSegmentIndex* si = getSegmentIndex();
+    if (si!=NULL) {
+        return si->queryIntersectedShapes(queryBox);
+    }
+
+    QList<QSharedPointer<RShape> > ret;
+    QList<QSharedPointer<RShape> > segments = getExploded();
+    for (int i=0; i<segments.size(); i++) {
+        if (queryBox.intersects(segments.at(i)->getBoundingBox())) {
+            ret.append(segments.at(i));
+        }
+    }
+    return ret;
+}
+
+/**
+ * \return Distance to the closest segment. For polylines with many
+ * segments, only the segments near the given point are evaluated.
+ */
+double RPolylineData::getDistanceTo(const RVector& point, bool limited, double range, bool draft) const {
+    const RSegmentIndex* si = NULL;
+    if (limited) {
+        si = getSegmentIndex();
+    }
+    if (si==NULL) {
+        return REntityData::getDistanceTo(point, limited, range, draft);
+    }
+
+    double dist;
+    si->queryClosest(point, dist);
+    return dist;
 }
 
 QList<RBox> RPolylineData::getBoundingBoxes() const {
@@ -78,36 +145,22 @@ QList<RVector> RPolylineData::getIntersectionPoints(
 
     QList<RVector> ret;
 
-    QList<QSharedPointer<RShape> > shapes1All = getExploded();
-    QList<QSharedPointer<RShape> > shapes2All;
-    if (same) {
-        shapes2All = shapes1All;
-    }
-    else {
-        const RPolylineData* otherPl = dynamic_cast<const RPolylineData*>(&other);
-        if (otherPl!=NULL) {
-            shapes2All = otherPl->getExploded();
-        }
-        else {
-            shapes2All = other.getShapes(queryBox);
-        }
-    }
+    const RPolylineData* otherPl = dynamic_cast<const RPolylineData*>(&other);
 
     QList<QSharedPointer<RShape> > shapes1;
     QList<QSharedPointer<RShape> > shapes2;
 
     // filter out shapes that are not in query box:
     if (queryBox.isValid()) {
-        for (int i1=0; i1<shapes1All.size(); i1++) {
-            QSharedPointer<RShape> shape1 = shapes1All.at(i1);
-            if (queryBox.intersects(shape1->getBoundingBox())) {
-                shapes1.append(shape1);
-            }
-        }
+        shapes1 = getSegmentsIn(queryBox);
         if (same) {
            shapes2 = shapes1;
         }
+        else if (otherPl!=NULL) {
+            shapes2 = otherPl->getSegmentsIn(queryBox);
+        }
         else {
+            QList<QSharedPointer<RShape> > shapes2All = other.getShapes(queryBox);
             for (int i2=0; i2<shapes2All.size(); i2++) {
                 QSharedPointer<RShape> shape2 = shapes2All.at(i2);
                 if (queryBox.intersects(shape2->getBoundingBox())) {
@@ -117,8 +170,16 @@ QList<RVector> RPolylineData::getIntersectionPoints(
         }
     }
     else {
-        shapes1 = shapes1All;
-        shapes2 = shapes2All;
+        shapes1 = getExploded();
+        if (same) {
+            shapes2 = shapes1;
+        }
+        else if (otherPl!=NULL) {
+            shapes2 = otherPl->getExploded();
+        }
+        else {
+            shapes2 = other.getShapes(queryBox);
+        }
     }
 
     for (int i1=0; i1<shapes1.size(); i1++) {
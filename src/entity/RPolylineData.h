@@ -26,6 +26,7 @@
 #include "RDocument.h"
 #include "REntity.h"
 #include "RPolyline.h"
+#include "RSegmentIndex.h"
 #include "RVector.h"
 
 /**
@@ -155,15 +156,37 @@ public:
     }
 
     virtual QList<QSharedPointer<RShape> > getShapes(const RBox& queryBox = RDEFAULT_RBOX) const {
-        Q_UNUSED(queryBox)
+        // complex polylines: only the segments near the query box:
+        if (queryBox.isValid()) {
+            const RSegmentIndex* si = getSegmentIndex();
+            if (si!=NULL) {
+                return si->queryIntersectedShapes(queryBox);
+            }
+        }
 
         return QList<QSharedPointer<RShape> >() <<
                 QSharedPointer<RShape>(new RPolyline(*this));
     }
 
+    virtual double getDistanceTo(const RVector& point, bool limited = true, double range = 0.0, bool draft = false) const;
+
     virtual QList<RVector> getIntersectionPoints(
             const REntityData& other, bool limited = true, bool same = false,
             const RBox& queryBox = RDEFAULT_RBOX) const;
+
+private:
+    const RSegmentIndex* getSegmentIndex() const;
+    QList<QSharedPointer<RShape> > getSegmentsIn(const RBox& queryBox) const;
+
+private:
+    /**
+     * Index of the segments of complex polylines and the geometry it
+     * was built for.
+     */
+    mutable RSegmentIndex segmentIndex;
+    mutable QList<RVector> segmentIndexVertices;
+    mutable QList<double> segmentIndexBulges;
+    mutable bool segmentIndexClosed;
 };
 
 Q_DECLARE_METATYPE(RPolylineData*)
@@ -31,9 +31,13 @@
 #include "RTextLabel.h"
 #include "RPainterPathSource.h"
 #include "RPolyline.h"
+#include "RBlock.h"
 #include "RBlockReferenceEntity.h"
+#include "RHatchData.h"
 
 
+const QList<RPainterPath> RGraphicsSceneQt::noPainterPaths;
+
 RGraphicsSceneQt::RGraphicsSceneQt(RDocumentInterface& documentInterface)
     : RGraphicsScene(documentInterface) /*, patternFactor(-1.0)*/ {
 
@@ -60,8 +64,88 @@ void RGraphicsSceneQt::clear() {
     deletePainterPaths();
 }
 
+namespace {
+    /**
+     * \return Hash of the complete state of the given brush.
+     */
+    uint hashBrush(const QBrush& brush) {
+        return qHash(brush.color().rgba()) * 31 + (uint)brush.style();
+    }
+
+    /**
+     * \return Hash of the complete state of the given pen.
+     */
+    uint hashPen(const QPen& pen) {
+        uint h = hashBrush(pen.brush());
+        h = h*31 + qHash((qint64)(pen.widthF()*1.0e6));
+        h = h*31 + (uint)pen.style();
+        h = h*31 + (uint)pen.capStyle();
+        h = h*31 + (uint)pen.joinStyle();
+        h = h*31 + (uint)pen.isCosmetic();
+        if (pen.style()==Qt::CustomDashLine) {
+            QVector<qreal> pattern = pen.dashPattern();
+            for (int i=0; i<pattern.size(); i++) {
+                h = h*31 + qHash((qint64)(pattern[i]*1.0e6));
+            }
+            h = h*31 + qHash((qint64)(pen.dashOffset()*1.0e6));
+        }
+        return h;
+    }
+}
+
+/**
+ * Regenerates the whole scene. All tiles cached by views and all block
+ * instances are out of date.
+ */
+void RGraphicsSceneQt::regenerate(bool undone) {
+    clearBlockInstances();
+
+    // pens and brushes that are no longer used are dropped:
+    penTable.clear();
+    brushTable.clear();
+
+    QList<RGraphicsView*>::iterator it;
+    for (it=views.begin(); it!=views.end(); it++) {
+        RGraphicsViewImage* view = dynamic_cast<RGraphicsViewImage*>(*it);
+        if (view!=NULL) {
+            view->clearTileCache();
+        }
+    }
+
+    RGraphicsScene::regenerate(undone);
+}
+
+/**
+ * Regenerates the given entities. Tiles cached by views are invalidated
+ * where the entities were before and where they are after the update.
+ */
+void RGraphicsSceneQt::regenerate(QSet<REntity::Id>& affectedEntities, bool updateViews) {
+    // block instances are out of date if a block definition has changed:
+    RDocument& doc = getDocument();
+    QSet<REntity::Id>::iterator it;
+    for (it=affectedEntities.begin(); it!=affectedEntities.end(); it++) {
+        QSharedPointer<REntity> entity = doc.queryEntityDirect(*it);
+        if (entity.isNull() || entity->getBlockId()!=doc.getCurrentBlockId()) {
+            clearBlockInstances();
+            break;
+        }
+    }
+
+    invalidateTiles(affectedEntities);
+    RGraphicsScene::regenerate(affectedEntities, false);
+    invalidateTiles(affectedEntities);
+    if (updateViews) {
+        regenerateViews(true);
+    }
+}
+
 void RGraphicsSceneQt::updateSelectionStatus(QSet<REntity::Id>& affectedEntities, bool updateViews) {
-    RGraphicsScene::updateSelectionStatus(affectedEntities, updateViews);
+    invalidateTiles(affectedEntities);
+    RGraphicsScene::updateSelectionStatus(affectedEntities, false);
+    invalidateTiles(affectedEntities);
+    if (updateViews) {
+        regenerateViews(true);
+    }
     /*
     // Change painter paths directly when selecting an entity (faster).
     // Generally good idea, needs refining (blue handles not added when selecting entity):
@@ -186,6 +270,9 @@ void RGraphicsSceneQt::exportArc(const RArc& arc, double offset) {
 void RGraphicsSceneQt::exportEllipse(const REllipse& ellipse, double offset) {
     bool created = beginPath();
 
+    // number of segments depends on the zoom level:
+    currentPainterPath.setAutoRegen(true);
+
     RGraphicsScene::exportEllipse(ellipse, offset);
 
     if (created) {
@@ -335,7 +422,45 @@ void RGraphicsSceneQt::exportRectangle(const RVector& p1,
 }
 
 void RGraphicsSceneQt::exportPainterPathSource(const RPainterPathSource& pathSource) {
-    exportPainterPaths(pathSource.getPainterPaths(false));
+    QList<RPainterPath> paths = pathSource.getPainterPaths(false);
+    exportPainterPaths(paths);
+
+    // hatch patterns that are too dense to be displayed are replaced
+    // by their boundary with a transparent fill:
+    const RHatchData* hatchData = dynamic_cast<const RHatchData*>(&pathSource);
+    if (hatchData==NULL || hatchData->isSolid()) {
+        return;
+    }
+    if (getEntity()==NULL && !exportToPreview) {
+        return;
+    }
+
+    double featureSize = 0.0;
+    for (int i=0; i<paths.size(); i++) {
+        double s = paths[i].getFeatureSize();
+        if (s>RS::PointTolerance && (featureSize<RS::PointTolerance || s<featureSize)) {
+            featureSize = s;
+        }
+    }
+    if (featureSize<RS::PointTolerance) {
+        return;
+    }
+
+    RPainterPath boundaryPath = hatchData->getBoundaryPath();
+    boundaryPath.setZLevel(0);
+    boundaryPath.setPen(QPen(Qt::SolidLine));
+    boundaryPath.setPen(getPen(boundaryPath));
+    QColor color = boundaryPath.getPen().color();
+    color.setAlpha(64);
+    boundaryPath.setBrush(QBrush(color));
+    boundaryPath.setFeatureSize(-featureSize);
+
+    if (!exportToPreview) {
+        addPath(getBlockRefOrEntity()->getId(), boundaryPath, draftMode);
+    }
+    else {
+        addToPreview(boundaryPath);
+    }
 }
 
 void RGraphicsSceneQt::exportPainterPaths(const QList<RPainterPath>& paths) {
@@ -411,27 +536,50 @@ double RGraphicsSceneQt::getPatternFactor() {
 
 void RGraphicsSceneQt::unexportEntity(REntity::Id entityId) {
     if (!exportToPreview) {
-        painterPaths.remove(entityId);
+        removePainterPaths(entityId);
         images.remove(entityId);
+        instanceTransforms.remove(entityId);
     }
 }
 
 void RGraphicsSceneQt::deletePainterPaths() {
     painterPaths.clear();
+    penTable.clear();
+    brushTable.clear();
     images.clear();
     previewPainterPaths.clear();
+    clearBlockInstances();
+}
+
+/**
+ * Clears all block instances. Block references are exported again
+ * when they are regenerated the next time.
+ */
+void RGraphicsSceneQt::clearBlockInstances() {
+    blockInstances.clear();
 }
 
 /**
  * \return A list of all painter paths that represent the entity with the
- * given ID.
+ * given ID. The list is valid until the entity is exported again.
+ * The painter paths of block references that are painted as block
+ * instances are in block coordinates, see \ref getInstanceTransform.
  */
-QList<RPainterPath> RGraphicsSceneQt::getPainterPaths(REntity::Id entityId) {
-    if (painterPaths.contains(entityId)) {
-        return painterPaths[entityId];
+const QList<RPainterPath>& RGraphicsSceneQt::getPainterPaths(REntity::Id entityId) const {
+    if (entityId>=0 && entityId<painterPaths.size()) {
+        return painterPaths.at(entityId);
     }
 
-    return QList<RPainterPath>();
+    return noPainterPaths;
+}
+
+/**
+ * Removes the painter paths of the entity with the given ID.
+ */
+void RGraphicsSceneQt::removePainterPaths(REntity::Id entityId) {
+    if (entityId>=0 && entityId<painterPaths.size()) {
+        painterPaths[entityId].clear();
+    }
 }
 
 bool RGraphicsSceneQt::hasImageFor(REntity::Id entityId) {
@@ -447,15 +595,57 @@ RImageData RGraphicsSceneQt::getImage(REntity::Id entityId) {
 }
 
 void RGraphicsSceneQt::addPath(REntity::Id entityId, const RPainterPath& path, bool draft) {
-    if (painterPaths.contains(entityId)) {
-        painterPaths[entityId].append(path);
+    Q_UNUSED(draft)
+
+    if (entityId<0) {
+        qWarning("RGraphicsSceneQt::addPath: invalid entity ID");
+        return;
     }
-    else {
-        painterPaths.insert(entityId, QList<RPainterPath>() << path);
+
+    if (entityId>=painterPaths.size()) {
+        painterPaths.resize(entityId+1);
+    }
+
+    QList<RPainterPath>& paths = painterPaths[entityId];
+    paths.append(path);
+    paths.last().setPen(getSharedPen(path.getPen()));
+    paths.last().setBrush(getSharedBrush(path.getBrush()));
+}
+
+/**
+ * \return Pen from the pen table that is equal to the given pen. Painter
+ * paths with equal pens share the same pen data.
+ */
+QPen RGraphicsSceneQt::getSharedPen(const QPen& pen) {
+    uint key = hashPen(pen);
+    QMultiHash<uint, QPen>::const_iterator it = penTable.constFind(key);
+    while (it!=penTable.constEnd() && it.key()==key) {
+        if (it.value()==pen) {
+            return it.value();
+        }
+        ++it;
+    }
+    penTable.insert(key, pen);
+    return pen;
+}
+
+/**
+ * \return Brush from the brush table that is equal to the given brush.
+ */
+QBrush RGraphicsSceneQt::getSharedBrush(const QBrush& brush) {
+    uint key = hashBrush(brush);
+    QMultiHash<uint, QBrush>::const_iterator it = brushTable.constFind(key);
+    while (it!=brushTable.constEnd() && it.key()==key) {
+        if (it.value()==brush) {
+            return it.value();
+        }
+        ++it;
     }
+    brushTable.insert(key, brush);
+    return brush;
 }
 
-QList<RPainterPath> RGraphicsSceneQt::getPreviewPainterPaths() {
+const QList<RPainterPath>& RGraphicsSceneQt::getPreviewPainterPaths() const {
     return previewPainterPaths;
 }
 
@@ -476,7 +666,12 @@ void RGraphicsSceneQt::highlightEntity(REntity& entity) {
     beginPreview();
     // get painter paths for closest entity:
     QList<RPainterPath> painterPaths = getPainterPaths(entity.getId());
+    bool instance = hasInstanceTransform(entity.getId());
+    QTransform instanceTransform = getInstanceTransform(entity.getId());
     for (int i = 0; i < painterPaths.size(); ++i) {
+        if (instance) {
+            painterPaths[i].transform(instanceTransform);
+        }
         painterPaths[i].setSelected(entity.isSelected());
         painterPaths[i].setHighlighted(true);
     }
@@ -493,7 +688,209 @@ void RGraphicsSceneQt::startEntity(bool topLevelEntity) {
 
     if (!exportToPreview) {
         if (topLevelEntity) {
-            painterPaths.remove(getEntity()->getId());
+            removePainterPaths(getEntity()->getId());
+            instanceTransforms.remove(getEntity()->getId());
+        }
+    }
+}
+
+/**
+ * Exports block references in the current block as instances of their
+ * block if possible, otherwise the current entity is exported normally.
+ */
+void RGraphicsSceneQt::exportCurrentEntity(bool preview) {
+    RBlockReferenceEntity* blockRef = dynamic_cast<RBlockReferenceEntity*>(getEntity());
+    if (blockRef!=NULL && !preview && !exportToPreview &&
+        blockRefStack.size()==1 && blockRefStack.top()==blockRef) {
+
+        if (exportBlockReferenceInstance(*blockRef)) {
+            return;
+        }
+    }
+
+    RGraphicsScene::exportCurrentEntity(preview);
+}
+
+/**
+ * Exports the given block reference as instance of its block. The painter
+ * paths of the block are exported once in block coordinates, with the
+ * scale factors and attributes of the block reference, and shared by all
+ * block references that only differ in position and rotation. These are
+ * painted with their own instance transform.
+ *
+ * \return True if the block reference was exported as block instance,
+ * false if it has to be exported normally. Blocks with points or images
+ * are never exported as block instances, since points are painted in
+ * view coordinates and images are not painter paths.
+ */
+bool RGraphicsSceneQt::exportBlockReferenceInstance(RBlockReferenceEntity& blockRef) {
+    RDocument& doc = getDocument();
+    QSharedPointer<RBlock> block = doc.queryBlockDirect(blockRef.getReferencedBlockId());
+    if (block.isNull()) {
+        return false;
+    }
+
+    REntity::Id id = blockRef.getId();
+    RVector scale = blockRef.getScaleFactors();
+    RColor color = blockRef.getColor();
+    QString key = QString("%1,%2,%3,%4,%5,%6")
+        .arg(blockRef.getReferencedBlockId())
+        .arg(scale.x, 0, 'g', 17)
+        .arg(scale.y, 0, 'g', 17)
+        .arg(blockRef.getLayerId())
+        .arg(blockRef.getLinetypeId())
+        .arg((int)blockRef.getLineweight());
+    key += QString(",%1,%2,%3,%4,%5")
+        .arg(color.isByLayer() ? QString("L") : color.isByBlock() ? QString("B") : QString::number(color.rgba()))
+        .arg((int)blockRef.isSelected())
+        .arg((int)draftMode)
+        .arg((int)screenBasedLinetypes)
+        .arg(getPatternFactor(), 0, 'g', 17);
+
+    QHash<QString, BlockInstance>::iterator it = blockInstances.find(key);
+    if (it!=blockInstances.end() && it->autoRegen &&
+        !RMath::fuzzyCompare(it->pixelSizeHint, getPixelSizeHint())) {
+
+        // arcs, ellipses or splines of the block are too detailed or not
+        // detailed enough for the current zoom level:
+        blockInstances.erase(it);
+        it = blockInstances.end();
+    }
+
+    if (it==blockInstances.end()) {
+        // export a copy of the block reference without position and
+        // rotation to get the painter paths in block coordinates:
+        QSharedPointer<RBlockReferenceEntity> copy(blockRef.clone());
+        copy->getData().setPosition(block->getOrigin());
+        copy->getData().setRotation(0.0);
+
+        // layer of the block reference is reset by exportEntity:
+        RLayer* layer = currentLayer;
+        images.remove(id);
+        RGraphicsScene::exportEntity(*copy, false, true);
+        currentLayer = layer;
+
+        BlockInstance instance;
+        instance.painterPaths = getPainterPaths(id);
+        instance.pixelSizeHint = getPixelSizeHint();
+        instance.autoRegen = false;
+        for (int i=0; i<instance.painterPaths.size(); i++) {
+            if (instance.painterPaths[i].hasPoints()) {
+                instance.painterPaths.clear();
+                break;
+            }
+            if (instance.painterPaths[i].getAutoRegen()) {
+                instance.autoRegen = true;
+            }
+        }
+        if (images.contains(id)) {
+            instance.painterPaths.clear();
+        }
+
+        removePainterPaths(id);
+        images.remove(id);
+        it = blockInstances.insert(key, instance);
+    }
+
+    // empty blocks and blocks that cannot be instantiated:
+    if (it->painterPaths.isEmpty()) {
+        return false;
+    }
+
+    if (id>=painterPaths.size()) {
+        painterPaths.resize(id+1);
+    }
+    painterPaths[id] = it->painterPaths;
+
+    RVector position = blockRef.getPosition();
+    RVector origin = block->getOrigin();
+    QTransform t;
+    t.translate(position.x, position.y);
+    t.rotate(RMath::rad2deg(blockRef.getRotation()));
+    t.translate(-origin.x, -origin.y);
+    instanceTransforms.insert(id, t);
+    return true;
+}
+
+/**
+ * \return True if the entity with the given ID is a block reference that
+ * is painted as block instance.
+ */
+bool RGraphicsSceneQt::hasInstanceTransform(REntity::Id entityId) const {
+    return instanceTransforms.contains(entityId);
+}
+
+/**
+ * \return Transform from the block coordinates of the painter paths of the
+ * given block reference to drawing coordinates or the identity if the
+ * entity is not painted as block instance.
+ */
+QTransform RGraphicsSceneQt::getInstanceTransform(REntity::Id entityId) const {
+    return instanceTransforms.value(entityId);
+}
+
+/**
+ * \return Bounding box of the given box mapped with the given transform.
+ */
+RBox RGraphicsSceneQt::mapBox(const QTransform& transform, const RBox& box) {
+    if (!box.isValid()) {
+        return box;
+    }
+
+    RBox ret(transform.mapRect(box.toQRectF()));
+    ret.c1.z = box.c1.z;
+    ret.c2.z = box.c2.z;
+    return ret;
+}
+
+/**
+ * Invalidates the tiles cached by views that intersect the current painter
+ * paths or images of the given entities.
+ */
+void RGraphicsSceneQt::invalidateTiles(const QSet<REntity::Id>& entityIds) {
+    QList<RBox> boxes;
+    QSet<REntity::Id>::const_iterator it;
+    for (it=entityIds.constBegin(); it!=entityIds.constEnd(); it++) {
+        RBox box;
+        const QList<RPainterPath>& paths = getPainterPaths(*it);
+        for (int i=0; i<paths.size(); i++) {
+            box.growToInclude(paths.at(i).getBoundingBox());
+        }
+        if (box.isValid() && hasInstanceTransform(*it)) {
+            box = mapBox(getInstanceTransform(*it), box);
+        }
+        QMap<REntity::Id, RImageData>::const_iterator imageIt = images.constFind(*it);
+        if (imageIt!=images.constEnd()) {
+            box.growToInclude(imageIt.value().getBoundingBox());
+        }
+        if (box.isValid()) {
+            boxes.append(box);
+        }
+    }
+
+    if (boxes.isEmpty()) {
+        return;
+    }
+
+    // every box is checked against every cached tile, for large
+    // numbers of entities one box is good enough:
+    if (boxes.size()>100) {
+        RBox box;
+        for (int i=0; i<boxes.size(); i++) {
+            box.growToInclude(boxes[i]);
+        }
+        boxes.clear();
+        boxes.append(box);
+    }
+
+    QList<RGraphicsView*>::iterator viewIt;
+    for (viewIt=views.begin(); viewIt!=views.end(); viewIt++) {
+        RGraphicsViewImage* view = dynamic_cast<RGraphicsViewImage*>(*viewIt);
+        if (view==NULL) {
+            continue;
+        }
+        for (int i=0; i<boxes.size(); i++) {
+            view->invalidateTiles(boxes[i]);
         }
     }
 }
@@ -503,9 +900,11 @@ void RGraphicsSceneQt::startEntity(bool topLevelEntity) {
  */
 QDebug operator<<(QDebug dbg, RGraphicsSceneQt& gs) {
     dbg.nospace() << "RGraphicsSceneQt(" << QString("%1").arg((long int)&gs, 0, 16) << ")";
-    QMap<REntity::Id, QList<RPainterPath> >::iterator it;
-    for (it=gs.painterPaths.begin(); it!=gs.painterPaths.end(); it++) {
-        dbg.nospace() << "\n" << it.key() << "\n  " << it.value() << "\n";
+    for (int id=0; id<gs.painterPaths.size(); id++) {
+        if (gs.painterPaths[id].isEmpty()) {
+            continue;
+        }
+        dbg.nospace() << "\n" << id << "\n  " << gs.painterPaths[id] << "\n";
     }
     return dbg.space();
 }
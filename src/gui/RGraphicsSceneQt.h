@@ -22,11 +22,16 @@
 
 #include "gui_global.h"
 
+#include <QBrush>
+#include <QHash>
 #include <QPen>
 #include <QList>
 #include <QMultiMap>
+#include <QTransform>
+#include <QVector>
 
 #include "RArc.h"
+#include "RBox.h"
 #include "RCircle.h"
 #include "RDocumentInterface.h"
 #include "REllipse.h"
@@ -38,6 +43,7 @@
 #include "RPoint.h"
 #include "RPolyline.h"
 
+class RBlockReferenceEntity;
 class RGraphicsViewImage;
 
 /**
@@ -60,6 +66,8 @@ public:
 
     virtual void clear();
 
+    virtual void regenerate(bool undone = false);
+    virtual void regenerate(QSet<REntity::Id>& affectedEntities, bool updateViews);
     virtual void updateSelectionStatus(QSet<REntity::Id>& affectedEntities, bool updateViews);
 
     virtual void clearPreview();
@@ -91,8 +99,8 @@ public:
     virtual void highlightEntity(REntity& entity);
 
     void deletePainterPaths();
-    QList<RPainterPath> getPainterPaths(REntity::Id entityId);
-    QList<RPainterPath> getPreviewPainterPaths();
+    const QList<RPainterPath>& getPainterPaths(REntity::Id entityId) const;
+    const QList<RPainterPath>& getPreviewPainterPaths() const;
     bool hasImageFor(REntity::Id entityId);
     RImageData getImage(REntity::Id entityId);
 
@@ -102,7 +110,20 @@ public:
     void addToPreview(const RPainterPath& painterPath);
 
     virtual void startEntity(bool topLevelEntity);
+    virtual void exportCurrentEntity(bool preview = false);
 
+    /**
+     * \nonscriptable
+     */
+    bool hasInstanceTransform(REntity::Id entityId) const;
+    /**
+     * \nonscriptable
+     */
+    QTransform getInstanceTransform(REntity::Id entityId) const;
+    /**
+     * \nonscriptable
+     */
+    static RBox mapBox(const QTransform& transform, const RBox& box);
 
     virtual void dump() {
         qDebug() << *this;
@@ -113,12 +134,70 @@ public:
      */
     friend QDebug operator<<(QDebug dbg, RGraphicsSceneQt& gs);
 
+protected:
+    /**
+     * \nonscriptable
+     */
+    void invalidateTiles(const QSet<REntity::Id>& entityIds);
+    /**
+     * \nonscriptable
+     */
+    void removePainterPaths(REntity::Id entityId);
+    /**
+     * \nonscriptable
+     */
+    QPen getSharedPen(const QPen& pen);
+    /**
+     * \nonscriptable
+     */
+    QBrush getSharedBrush(const QBrush& brush);
+    /**
+     * \nonscriptable
+     */
+    bool exportBlockReferenceInstance(RBlockReferenceEntity& blockRef);
+    /**
+     * \nonscriptable
+     */
+    void clearBlockInstances();
+
 private:
     RPainterPath currentPainterPath;
-    QMap<REntity::Id, QList<RPainterPath> > painterPaths;
+    /**
+     * Painter paths of all entities, indexed by entity ID.
+     */
+    QVector<QList<RPainterPath> > painterPaths;
+    static const QList<RPainterPath> noPainterPaths;
+
+    /**
+     * Pens and brushes used by painter paths, by hash of their state.
+     * Cleared when the scene is regenerated.
+     */
+    QMultiHash<uint, QPen> penTable;
+    QMultiHash<uint, QBrush> brushTable;
 
     QMap<REntity::Id, RImageData> images;
 
+    /**
+     * Painter paths of a block in block coordinates, shared by all
+     * block references that insert the block with the same attributes.
+     */
+    struct BlockInstance {
+        QList<RPainterPath> painterPaths;
+        double pixelSizeHint;
+        bool autoRegen;
+    };
+
+    /**
+     * Block instances by block ID and attributes of the block references.
+     */
+    QHash<QString, BlockInstance> blockInstances;
+
+    /**
+     * Transforms from block coordinates to drawing coordinates of block
+     * references that are painted as block instances.
+     */
+    QHash<REntity::Id, QTransform> instanceTransforms;
+
     QList<RPainterPath> previewPainterPaths;
 };
 
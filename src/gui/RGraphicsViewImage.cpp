@@ -18,6 +18,8 @@
  */
 #include <QtCore>
 #include <QPainter>
+#include <QRunnable>
+#include <QThreadPool>
 
 #include "RDebug.h"
 #include "RDocument.h"
@@ -54,6 +56,9 @@ RGraphicsViewImage::RGraphicsViewImage()
       colorCorrectionOverride(false),
       colorCorrection(false),
       colorThreshold(10),
+      selectionColor(RColor(164,70,70,128)),
+      entitySizeThreshold(1),
+      tilesInvalidated(false),
       drawingScale(1.0) {
 
     currentScale = 1.0;
@@ -66,6 +71,142 @@ RGraphicsViewImage::RGraphicsViewImage()
 RGraphicsViewImage::~RGraphicsViewImage() {
 }
 
+
+
+namespace {
+    /**
+     * Makes the given painter path independent of other copies, so
+     * that it can be painted while copies are painted in other threads.
+     * QPainterPath caches data for painting in its shared data.
+     */
+    void detachPainterPath(QPainterPath& path) {
+        if (path.elementCount()>0) {
+            QPainterPath::Element e = path.elementAt(0);
+            path.setElementPositionAt(0, e.x, e.y);
+        }
+    }
+}
+
+/**
+ * Part of a graphics view that is rendered by a worker thread into
+ * its own image. Holds the painter paths of all entities that intersect
+ * the tile, in drawing order. The transform maps drawing coordinates
+ * to the image of the tile.
+ */
+class RGraphicsViewImageTile : public QRunnable {
+public:
+    /**
+     * Painter paths of one entity. If \c shared is true, the painter
+     * paths are also painted by other tiles (or block references) and
+     * are detached before they are painted.
+     */
+    struct Entity {
+        QList<RPainterPath> painterPaths;
+        QTransform instanceTransform;
+        bool shared;
+        bool hasImage;
+        RImageData image;
+    };
+
+    RGraphicsViewImageTile(RGraphicsViewImage& view, const QRect& rect)
+        : view(view), rect(rect) {
+
+        setAutoDelete(false);
+        transform = view.transform * QTransform::fromTranslate(-rect.left(), -rect.top());
+        image = QImage(rect.size(), QImage::Format_ARGB32_Premultiplied);
+        image.fill(0);
+    }
+
+    virtual void run() {
+        QPainter painter(&image);
+        if (view.antialiasing) {
+            painter.setRenderHint(QPainter::Antialiasing);
+        }
+        painter.setWorldTransform(transform);
+
+        for (int i=0; i<entities.size(); i++) {
+            if (entities[i].hasImage) {
+                view.paintImage(&painter, entities[i].image);
+            }
+            if (entities[i].shared) {
+                detachPainterPaths(entities[i].painterPaths);
+            }
+            view.paintPainterPaths(&painter, entities[i].painterPaths, entities[i].instanceTransform);
+        }
+        painter.end();
+        detached.clear();
+    }
+
+private:
+    /**
+     * Replaces the given painter paths with copies that are only used
+     * by this tile. Painter paths that are shared by many entities
+     * (block instances) are copied only once per tile.
+     */
+    void detachPainterPaths(QList<RPainterPath>& painterPaths) {
+        for (int p=0; p<painterPaths.size(); p++) {
+            RPainterPath& path = painterPaths[p];
+            if (path.elementCount()==0) {
+                continue;
+            }
+
+            // identifies the shared data of the path:
+            const QPainterPath::Element* key = &path.elementAt(0);
+            QHash<const QPainterPath::Element*, QPair<QPainterPath, QPainterPath> >::const_iterator it =
+                detached.constFind(key);
+            if (it==detached.constEnd()) {
+                // the original is kept, so that its data cannot be
+                // reused by another path while this tile is painted:
+                QPainterPath copy = path;
+                detachPainterPath(copy);
+                it = detached.insert(key, qMakePair(QPainterPath(path), copy));
+            }
+            static_cast<QPainterPath&>(path) = it.value().second;
+        }
+    }
+
+public:
+    RGraphicsViewImage& view;
+    QRect rect;
+    QTransform transform;
+    RBox box;
+    QImage image;
+    QList<Entity> entities;
+
+private:
+    QHash<const QPainterPath::Element*, QPair<QPainterPath, QPainterPath> > detached;
+};
+
+namespace {
+    /**
+     * Minimum number of entities to paint in multiple threads.
+     */
+    const int minMultiThreadedEntities = 500;
+
+    /**
+     * Width and height of cached tiles in pixels.
+     */
+    const int tileSize = 256;
+
+    /**
+     * Maximum number of zoom levels for which tiles are cached.
+     */
+    const int maxTileCacheLevels = 3;
+
+    /**
+     * \return Column or row of the tile that contains the given pixel
+     * coordinate of the tile grid.
+     */
+    qint64 getTileIndex(double pixel) {
+        return (qint64)floor(pixel / tileSize);
+    }
+
+    QThreadPool& getRenderThreadPool() {
+        static QThreadPool pool;
+        return pool;
+    }
+}
+
 void RGraphicsViewImage::setPaintOrigin(bool val) {
     doPaintOrigin = val;
 }
@@ -85,6 +226,7 @@ void RGraphicsViewImage::setBackgroundColor(const QColor& col) {
 
 void RGraphicsViewImage::setScene(RGraphicsSceneQt* scene, bool regen) {
     sceneQt = scene;
+    clearTileCache();
     RGraphicsView::setScene(scene, regen);
 }
 
@@ -101,6 +243,14 @@ void RGraphicsViewImage::invalidate(bool force) {
 void RGraphicsViewImage::regenerate(bool force) {
     updateTransformation();
     invalidate(force);
+    if (force) {
+        // tiles of changed entities have been invalidated by the scene,
+        // otherwise the changes are not known:
+        if (!tilesInvalidated) {
+            clearTileCache();
+        }
+        tilesInvalidated = false;
+    }
     if (force && grid!=NULL) {
         grid->update(force);
     }
@@ -177,58 +327,15 @@ void RGraphicsViewImage::updateImage() {
 
         bool displayGrid = gridVisible;
 
-        // optimization for panning and scrolling:
-        if (panOptimization && lastFactor==factor) {
-            Q_ASSERT(false);
-            QImage lastBuffer = graphicsBuffer.copy();
-            RVector o = mapToView(offset) - mapToView(lastOffset);
-            int ox = RMath::mround(o.x);
-            int oy = RMath::mround(o.y);
-
-            if (ox!=0) {
-                // fill gap at the right or left side:
-                QRect rect(
-                    ox<0 ? ox+getWidth() : 0,
-                    0,
-                    abs(ox),
-                    getHeight()
-                );
-                rect.adjust(-1,-1,1,1);
-
-                paintErase(graphicsBuffer, rect);
-                if (displayGrid) {
-                    paintMetaGrid(graphicsBuffer, rect);
-                }
-                paintDocument(rect);
-                if (displayGrid) {
-                    paintGrid(graphicsBuffer, rect);
-                }
-                paintOrigin(graphicsBuffer);
-            }
-
-            if (oy!=0) {
-                // fill gap at the top or bottom:
-                QRect rect(
-                    qMax(ox, 0),
-                    oy<0 ? oy+getHeight() : 0,
-                    getWidth() - abs(ox),
-                    abs(oy)
-                );
-                rect.adjust(-1,-1,1,1);
-                paintErase(graphicsBuffer, rect);
-                if (displayGrid) {
-                    paintMetaGrid(graphicsBuffer, rect);
-                }
-                paintDocument(rect);
-                if (displayGrid) {
-                    paintGrid(graphicsBuffer, rect);
-                }
-                paintOrigin(graphicsBuffer);
+        // reuse cached tiles for panning and zooming:
+        if (isTileCacheEnabled()) {
+            paintErase(graphicsBuffer);
+            paintDocumentFromTileCache();
+            if (displayGrid) {
+                paintMetaGrid(graphicsBuffer);
+                paintGrid(graphicsBuffer);
             }
-
-            QPainter gbPainter(&graphicsBuffer);
-            gbPainter.drawImage(ox, oy, lastBuffer);
-            gbPainter.end();
+            paintOrigin(graphicsBuffer);
         }
         else {
             paintErase(graphicsBuffer);
@@ -247,7 +354,7 @@ void RGraphicsViewImage::updateImage() {
     graphicsBufferWithPreview = graphicsBuffer;
 
     // draws the current preview on top of the buffer:
-    QList<RPainterPath> preview = sceneQt->getPreviewPainterPaths();
+    const QList<RPainterPath>& preview = sceneQt->getPreviewPainterPaths();
     if (!preview.isEmpty()) {
         QPainter* painter = initPainter(graphicsBufferWithPreview, false);
         bgColorLightness = getBackgroundColor().lightness();
@@ -486,6 +593,16 @@ void RGraphicsViewImage::updateTransformation() const {
     transform.translate(0, -getHeight());
     transform.scale(getFactor(), getFactor());
     transform.translate(getOffset().x, getOffset().y);
+
+    if (isTileCacheEnabled()) {
+        // snap the view offset to whole pixels, so that entities painted
+        // on top of the cached tiles line up with the tiles exactly:
+        transform.setMatrix(
+            transform.m11(), transform.m12(), transform.m13(),
+            transform.m21(), transform.m22(), transform.m23(),
+            qRound64(transform.dx()), qRound64(transform.dy()), transform.m33()
+        );
+    }
 }
 
 /**
@@ -528,7 +645,12 @@ void RGraphicsViewImage::paintDocument(const QRect& rect) {
     RVector c2 = mapFromView(RVector(r.right()+1,r.top()-1), 1e6);
     RBox queryBox(c1, c2);
 
-    paintEntities(painter, queryBox);
+    if (RSettings::getRenderThreadCount()>1 && !isPrinting()) {
+        paintEntitiesMultiThreaded(painter, queryBox, r);
+    }
+    else {
+        paintEntities(painter, queryBox);
+    }
 
     // paint selected entities on top:
     if (!selectedIds.isEmpty()) {
@@ -543,12 +665,18 @@ void RGraphicsViewImage::paintDocument(const QRect& rect) {
     painter->end();
     delete painter;
 
-    // paint reference points of selected entities:
+    paintReferencePoints(graphicsBuffer);
+}
+
+/**
+ * Paints the reference points of selected entities.
+ */
+void RGraphicsViewImage::paintReferencePoints(QPaintDevice& device) {
     QMultiMap<REntity::Id, RVector>& referencePoints =
             scene->getReferencePoints();
     if (!referencePoints.isEmpty() && referencePoints.count()<1000) {
 
-        QPainter gbPainter(&graphicsBuffer);
+        QPainter gbPainter(&device);
 
         QMultiMap<REntity::Id, RVector>::iterator it;
         for (it = referencePoints.begin(); it != referencePoints.end(); ++it) {
@@ -562,6 +690,160 @@ void RGraphicsViewImage::paintDocument(const QRect& rect) {
     }
 }
 
+/**
+ * \return True if the document is painted with cached tiles. Printing and
+ * print previews are always painted from scratch.
+ */
+bool RGraphicsViewImage::isTileCacheEnabled() const {
+    return panOptimization && !isPrinting() && !isPrintPreview() &&
+        RSettings::getBoolValue("GraphicsView/TileCache", true);
+}
+
+/**
+ * Clears the tile cache if settings that affect the rendering of
+ * entities have changed since the cached tiles were rendered.
+ */
+void RGraphicsViewImage::updateTileCacheState() {
+    QString state = QString("%1,%2,%3,%4,%5,%6,%7")
+        .arg(RSettings::getCacheGeneration())
+        .arg((uint)getBackgroundColor().rgba())
+        .arg((int)colorMode)
+        .arg((int)antialiasing)
+        .arg((int)colorCorrectionOverride)
+        .arg(getTextHeightThresholdOverride())
+        .arg((int)(scene!=NULL && scene->getDraftMode()));
+
+    if (state!=tileCacheState) {
+        clearTileCache();
+        tileCacheState = state;
+    }
+}
+
+/**
+ * Paints the document from cached tiles. The tiles have a fixed size and
+ * are aligned to the drawing origin at the current zoom factor, so tiles
+ * that have been rendered before can be reused when panning or when
+ * returning to a previous zoom factor. Only tiles that are not cached
+ * yet are rendered. Selected entities are painted on top of the other
+ * entities of the same tile.
+ */
+void RGraphicsViewImage::paintDocumentFromTileCache() {
+    RDocument* document = getDocument();
+    if (document == NULL) {
+        return;
+    }
+
+    bgColorLightness = getBackgroundColor().lightness();
+    selectedIds.clear();
+
+    updateTileCacheState();
+
+    double f = getFactor();
+
+    // position of the origin of the tile grid in the view (whole pixels,
+    // see updateTransformation):
+    updateTransformation();
+    qint64 originX = qRound64(transform.dx());
+    qint64 originY = qRound64(transform.dy());
+
+    // visible tiles:
+    qint64 col1 = getTileIndex(-originX);
+    qint64 col2 = getTileIndex(getWidth() - 1 - originX);
+    qint64 row1 = getTileIndex(-originY);
+    qint64 row2 = getTileIndex(getHeight() - 1 - originY);
+
+    tileCacheFactors.removeAll(f);
+    tileCacheFactors.prepend(f);
+    while (tileCacheFactors.size()>maxTileCacheLevels) {
+        tileCache.remove(tileCacheFactors.takeLast());
+    }
+    QHash<QPair<qint64, qint64>, QImage>& tiles = tileCache[f];
+
+    // tile boxes are grown like in paintEntitiesMultiThreaded:
+    double margin = RUnit::convert(
+        document->getMaxLineweight()/100.0,
+        RS::Millimeter,
+        document->getUnit()
+    ) + mapDistanceFromView(1.0);
+
+    QList<RGraphicsViewImageTile*> missingTiles;
+    QList<QPair<qint64, qint64> > missingKeys;
+    RBox queryBox;
+    for (qint64 row=row1; row<=row2; row++) {
+        for (qint64 col=col1; col<=col2; col++) {
+            QPair<qint64, qint64> key(col, row);
+            if (tiles.contains(key)) {
+                continue;
+            }
+
+            RGraphicsViewImageTile* tile = new RGraphicsViewImageTile(*this, QRect(0, 0, tileSize, tileSize));
+            tile->transform = QTransform(f, 0.0, 0.0, -f, -(double)(col*tileSize), -(double)(row*tileSize));
+            tile->box = RBox(
+                RVector((double)(col*tileSize) / f, -(double)((row+1)*tileSize) / f),
+                RVector((double)((col+1)*tileSize) / f, -(double)(row*tileSize) / f)
+            );
+            tile->box.growXY(margin);
+            tile->box.c1.z = RMINDOUBLE;
+            tile->box.c2.z = RMAXDOUBLE;
+            queryBox.growToInclude(tile->box);
+            missingTiles.append(tile);
+            missingKeys.append(key);
+        }
+    }
+
+    if (!missingTiles.isEmpty()) {
+        QVector<REntity::Id> ids;
+        queryEntitiesToPaint(queryBox, ids);
+
+        // tiles are kept for panning, so they are not clipped to the view:
+        clipBox = queryBox;
+
+        QSet<REntity::Id> selected;
+        addEntitiesToTiles(ids, missingTiles, &selected);
+        if (!selected.isEmpty()) {
+            // selected entities are painted on top:
+            QList<REntity::Id> list = document->getStorage().orderBackToFront(selected);
+            addEntitiesToTiles(list.toVector(), missingTiles, NULL);
+        }
+
+        paintTiles(missingTiles, RSettings::getRenderThreadCount());
+
+        for (int t=0; t<missingTiles.size(); t++) {
+            tiles.insert(missingKeys[t], missingTiles[t]->image);
+        }
+        qDeleteAll(missingTiles);
+    }
+
+    QPainter* painter = initPainter(graphicsBuffer, false);
+    paintBackground(painter);
+    painter->resetTransform();
+    for (qint64 row=row1; row<=row2; row++) {
+        for (qint64 col=col1; col<=col2; col++) {
+            painter->drawImage(
+                QPoint((int)(col*tileSize + originX), (int)(row*tileSize + originY)),
+                tiles.value(QPair<qint64, qint64>(col, row))
+            );
+        }
+    }
+    painter->end();
+    delete painter;
+
+    // forget tiles that are more than half a view away from the view:
+    qint64 marginCols = (col2 - col1) / 2 + 1;
+    qint64 marginRows = (row2 - row1) / 2 + 1;
+    QMutableHashIterator<QPair<qint64, qint64>, QImage> it(tiles);
+    while (it.hasNext()) {
+        it.next();
+        if (it.key().first < col1 - marginCols || it.key().first > col2 + marginCols ||
+            it.key().second < row1 - marginRows || it.key().second > row2 + marginRows) {
+
+            it.remove();
+        }
+    }
+
+    paintReferencePoints(graphicsBuffer);
+}
+
 void RGraphicsViewImage::clearBackground() {
     backgroundDecoration.clear();
 }
@@ -620,6 +902,201 @@ QPainter* RGraphicsViewImage::initPainter(QPaintDevice& device, bool erase, bool
 }
 
 void RGraphicsViewImage::paintEntities(QPainter* painter, const RBox& queryBox) {
+    QVector<REntity::Id> ids;
+    queryEntitiesToPaint(queryBox, ids);
+
+    //RDebug::startTimer();
+
+    for (int i=0; i<ids.size(); i++) {
+        paintEntity(painter, ids[i]);
+    }
+
+    //RDebug::stopTimer("painting");
+}
+
+/**
+ * Paints the entities inside the given query box with multiple threads.
+ * The given rectangle of the view is split into tiles, which are painted
+ * into separate images in parallel and then drawn with the given
+ * painter. Selected entities are not painted but collected in
+ * selectedIds, like in \ref paintEntity.
+ */
+void RGraphicsViewImage::paintEntitiesMultiThreaded(QPainter* painter, const RBox& queryBox, const QRect& rect) {
+    RDocument* document = getDocument();
+    if (document==NULL) {
+        return;
+    }
+
+    QVector<REntity::Id> ids;
+    queryEntitiesToPaint(queryBox, ids);
+
+    int threadCount = RSettings::getRenderThreadCount();
+    if (ids.size()<minMultiThreadedEntities || threadCount<=1 || rect.isEmpty()) {
+        for (int i=0; i<ids.size(); i++) {
+            paintEntity(painter, ids[i]);
+        }
+        return;
+    }
+
+    // two tiles per thread for load balancing, as square as possible:
+    int tileCount = threadCount * 2;
+    int cols = qMax(1, qCeil(qSqrt(tileCount * (double)rect.width() / rect.height())));
+    int rows = qMax(1, (tileCount + cols - 1) / cols);
+    int tileWidth = (rect.width() + cols - 1) / cols;
+    int tileHeight = (rect.height() + rows - 1) / rows;
+
+    // tile boxes in drawing coordinates, grown by the maximum line weight
+    // and one pixel, so that paths which only touch a tile with their
+    // outline are painted in that tile:
+    double margin = RUnit::convert(
+        document->getMaxLineweight()/100.0,
+        RS::Millimeter,
+        document->getUnit()
+    ) + mapDistanceFromView(1.0);
+
+    QList<RGraphicsViewImageTile*> tiles;
+    for (int row=0; row<rows; row++) {
+        for (int col=0; col<cols; col++) {
+            QRect tileRect(rect.left() + col*tileWidth, rect.top() + row*tileHeight, tileWidth, tileHeight);
+            tileRect = tileRect.intersected(rect);
+            if (tileRect.isEmpty()) {
+                continue;
+            }
+            RGraphicsViewImageTile* tile = new RGraphicsViewImageTile(*this, tileRect);
+            tile->box = RBox(
+                mapFromView(RVector(tileRect.left(), tileRect.bottom()+1)),
+                mapFromView(RVector(tileRect.right()+1, tileRect.top()))
+            );
+            tile->box.growXY(margin);
+            tile->box.c1.z = RMINDOUBLE;
+            tile->box.c2.z = RMAXDOUBLE;
+            tiles.append(tile);
+        }
+    }
+
+    addEntitiesToTiles(ids, tiles, &selectedIds);
+    paintTiles(tiles, threadCount);
+
+    painter->save();
+    painter->resetTransform();
+    for (int t=0; t<tiles.size(); t++) {
+        painter->drawImage(tiles[t]->rect.topLeft(), tiles[t]->image);
+    }
+    painter->restore();
+
+    qDeleteAll(tiles);
+}
+
+/**
+ * Adds the painter paths and images of the given entities to the tiles
+ * they intersect, in the given order. Everything that might change the
+ * scene (regeneration of painter paths, loading of images) is done here,
+ * before any thread starts. If \c selected is given, selected entities
+ * are added to it instead of the tiles, otherwise their painter paths
+ * are marked as selected.
+ */
+void RGraphicsViewImage::addEntitiesToTiles(const QVector<REntity::Id>& ids, QList<RGraphicsViewImageTile*>& tiles, QSet<REntity::Id>* selected) {
+    RDocument* document = getDocument();
+    if (document==NULL) {
+        return;
+    }
+
+    for (int i=0; i<ids.size(); i++) {
+        REntity::Id id = ids[i];
+        bool entitySelected = document->isSelected(id);
+        if (selected!=NULL && entitySelected) {
+            selected->insert(id);
+            continue;
+        }
+
+        QList<RPainterPath> painterPaths = getEntityPainterPaths(id);
+        bool instance = sceneQt->hasInstanceTransform(id);
+        QTransform instanceTransform = sceneQt->getInstanceTransform(id);
+        if (entitySelected) {
+            // painted in worker threads, which cannot use isSelected:
+            for (int p=0; p<painterPaths.size(); p++) {
+                painterPaths[p].setSelected(true);
+            }
+        }
+
+        RGraphicsViewImageTile::Entity entity;
+        entity.hasImage = sceneQt->hasImageFor(id);
+        RBox imageBox;
+        if (entity.hasImage) {
+            entity.image = sceneQt->getImage(id);
+            entity.image.getImage();
+            imageBox = entity.image.getBoundingBox();
+        }
+
+        QList<RBox> pathBoxes;
+        for (int p=0; p<painterPaths.size(); p++) {
+            if (instance) {
+                pathBoxes.append(RGraphicsSceneQt::mapBox(instanceTransform, painterPaths[p].getBoundingBox()));
+            }
+            else {
+                pathBoxes.append(painterPaths[p].getBoundingBox());
+            }
+        }
+
+        // painter paths of block instances are shared with other block
+        // references, other painter paths might be shared by tiles. They
+        // are detached by the tiles when painting:
+        QList<int> entityTiles;
+        for (int t=0; t<tiles.size(); t++) {
+            RGraphicsViewImageTile* tile = tiles[t];
+            RGraphicsViewImageTile::Entity e;
+            e.instanceTransform = instanceTransform;
+            e.shared = instance;
+            e.hasImage = entity.hasImage && tile->box.intersects(imageBox);
+            if (e.hasImage) {
+                e.image = entity.image;
+            }
+            for (int p=0; p<painterPaths.size(); p++) {
+                if (tile->box.intersects(pathBoxes[p])) {
+                    e.painterPaths.append(painterPaths[p]);
+                }
+            }
+            if (e.hasImage || !e.painterPaths.isEmpty()) {
+                tile->entities.append(e);
+                entityTiles.append(t);
+            }
+        }
+        if (entityTiles.size()>1) {
+            for (int k=0; k<entityTiles.size(); k++) {
+                tiles[entityTiles[k]]->entities.last().shared = true;
+            }
+        }
+    }
+}
+
+/**
+ * Paints the given tiles, the first one in this thread and the others
+ * in the render thread pool.
+ */
+void RGraphicsViewImage::paintTiles(QList<RGraphicsViewImageTile*>& tiles, int threadCount) {
+    if (threadCount<=1) {
+        for (int t=0; t<tiles.size(); t++) {
+            tiles[t]->run();
+        }
+        return;
+    }
+
+    QThreadPool& pool = getRenderThreadPool();
+    pool.setMaxThreadCount(threadCount-1);
+    for (int t=1; t<tiles.size(); t++) {
+        pool.start(tiles[t]);
+    }
+    if (!tiles.isEmpty()) {
+        tiles[0]->run();
+    }
+    pool.waitForDone();
+}
+
+/**
+ * Queries the entities to paint inside the given query box, ordered
+ * back to front, and updates the settings used for painting them.
+ */
+void RGraphicsViewImage::queryEntitiesToPaint(const RBox& queryBox, QVector<REntity::Id>& ids) {
     RDocument* document = getDocument();
     if (document==NULL) {
         return;
@@ -627,6 +1104,8 @@ void RGraphicsViewImage::paintEntities(QPainter* painter, const RBox& queryBox)
 
     colorCorrection = RSettings::getColorCorrection();
     colorThreshold = RSettings::getColorThreshold();
+    selectionColor = RSettings::getColor("GraphicsViewColors/SelectionColor", RColor(164,70,70,128));
+    entitySizeThreshold = RSettings::getIntValue("GraphicsView/EntitySizeThreshold", 1);
 
     updateTextHeightThreshold();
 
@@ -643,9 +1122,8 @@ void RGraphicsViewImage::paintEntities(QPainter* painter, const RBox& queryBox)
 
     //RDebug::startTimer();
     mutexSi.lock();
-    QSet<REntity::Id> ids;
 
-    ids = document->queryIntersectedEntitiesXY(qb, true);
+    document->queryIntersectedEntitiesXY(ids, qb, true);
 
     //qDebug() << "RGraphicsViewImage::paintEntities: ids: " << ids.size();
 
@@ -656,11 +1134,9 @@ void RGraphicsViewImage::paintEntities(QPainter* painter, const RBox& queryBox)
     isSelected = false;
 
     //RDebug::startTimer();
-    QList<REntity::Id> list = document->getStorage().orderBackToFront(ids);
+    document->getStorage().orderBackToFront(ids);
     //RDebug::stopTimer("ordering");
 
-    //RDebug::startTimer();
-
     if (isPrinting()) {
         clipBox = RBox();
     }
@@ -674,13 +1150,6 @@ void RGraphicsViewImage::paintEntities(QPainter* painter, const RBox& queryBox)
                         )
                     );
     }
-
-    QListIterator<REntity::Id> it(list);
-    while (it.hasNext()) {
-        paintEntity(painter, it.next());
-    }
-
-    //RDebug::stopTimer("painting");
 }
 
 void RGraphicsViewImage::paintEntity(QPainter* painter, REntity::Id id) {
@@ -694,58 +1163,134 @@ void RGraphicsViewImage::paintEntity(QPainter* painter, REntity::Id id) {
 
     //sceneQt->setDraftMode(draftMode);
 
-    // TODO: PERFORMANCE: don't copy list, only get reference from scene
-
-    QList<RPainterPath> painterPaths;
+    // get image for raster image entity:
+    if (sceneQt->hasImageFor(id)) {
+        RImageData image = sceneQt->getImage(id);
+        paintImage(painter, image);
+    }
 
-    // get painter paths for vector graphics entity:
+    // painter paths are shared with the scene, not copied:
     if (id == -1) {
-        // get painter paths of the current preview:
-        painterPaths = sceneQt->getPreviewPainterPaths();
+        // painter paths of the current preview:
+        paintPainterPaths(painter, sceneQt->getPreviewPainterPaths());
     } else {
-        // get painter paths of the given entity:
-        painterPaths = sceneQt->getPainterPaths(id);
+        // painter paths of the given entity:
+        paintPainterPaths(painter, getEntityPainterPaths(id), sceneQt->getInstanceTransform(id));
+    }
+}
+
+/**
+ * \return Painter paths of the given entity. Painter paths that are too
+ * detailed or not detailed enough for the current zoom level are
+ * regenerated first. Entities that are smaller than the entity size
+ * threshold are represented by a single dot.
+ */
+QList<RPainterPath> RGraphicsViewImage::getEntityPainterPaths(REntity::Id id) {
+    QList<RPainterPath> painterPaths = sceneQt->getPainterPaths(id);
 
-        // ideal pixel size for rendering arc at current zoom:
-        double ps = mapDistanceFromView(1.0);
-        if (isPrinting()) {
-            ps = getScene()->getPixelSizeHint();
+    if (!isPrinting() && entitySizeThreshold>0 && !painterPaths.isEmpty()) {
+        RPainterPath dot = getEntityDot(painterPaths);
+        if (!dot.isEmpty()) {
+            return QList<RPainterPath>() << dot;
         }
+    }
 
-        bool regen = false;
-        for (int p=0; p<painterPaths.size(); p++) {
-            if (painterPaths[p].getAutoRegen()==true) {
-                if (painterPaths[p].getPixelSizeHint()>RS::PointTolerance &&
-                    (painterPaths[p].getPixelSizeHint()<ps/5 || painterPaths[p].getPixelSizeHint()>ps*5)) {
+    // ideal pixel size for rendering arc at current zoom:
+    double ps = mapDistanceFromView(1.0);
+    if (isPrinting()) {
+        ps = getScene()->getPixelSizeHint();
+    }
 
-                    regen = true;
-                    break;
-                }
+    bool regen = false;
+    for (int p=0; p<painterPaths.size(); p++) {
+        if (painterPaths[p].getAutoRegen()==true) {
+            if (painterPaths[p].getPixelSizeHint()>RS::PointTolerance &&
+                (painterPaths[p].getPixelSizeHint()<ps/5 || painterPaths[p].getPixelSizeHint()>ps*5)) {
+
+                regen = true;
+                break;
             }
         }
+    }
+
+    if (regen) {
+        // if at least one arc path is too detailed or not detailed enough, regen:
+        sceneQt->exportEntity(id, true);
+        painterPaths = sceneQt->getPainterPaths(id);
+    }
+
+    return painterPaths;
+}
+
+/**
+ * \return Painter path with a dot of one pixel in the middle of the
+ * given painter paths of an entity, with the pen of the first path
+ * that has a pen. An empty path is returned if the entity is not smaller
+ * than the entity size threshold or contains points, which are always
+ * shown as crosses.
+ */
+RPainterPath RGraphicsViewImage::getEntityDot(const QList<RPainterPath>& painterPaths) {
+    RBox box;
+    for (int p=0; p<painterPaths.size(); p++) {
+        if (painterPaths[p].hasPoints()) {
+            return RPainterPath();
+        }
+        box.growToInclude(painterPaths[p].getBoundingBox());
+    }
+
+    if (!box.isValid() ||
+        mapDistanceToView(box.getWidth())>=entitySizeThreshold ||
+        mapDistanceToView(box.getHeight())>=entitySizeThreshold) {
 
-        if (regen) {
-            // if at least one arc path is too detailed or not detailed enough, regen:
-            sceneQt->exportEntity(id, true);
-            painterPaths = sceneQt->getPainterPaths(id);
+        return RPainterPath();
+    }
+
+    RPainterPath dot;
+    dot.setPen(painterPaths.first().getPen());
+    for (int p=0; p<painterPaths.size(); p++) {
+        if (painterPaths[p].getPen().style()!=Qt::NoPen) {
+            dot.setPen(painterPaths[p].getPen());
+            break;
+        }
+        if (painterPaths[p].getBrush().style()!=Qt::NoBrush) {
+            dot.setPen(QPen(painterPaths[p].getBrush().color()));
+            break;
         }
     }
+    dot.setBrush(QBrush(Qt::NoBrush));
+    dot.setSelected(painterPaths.first().isSelected());
+    dot.setHighlighted(painterPaths.first().isHighlighted());
+
+    RVector center = box.getCenter();
+    double half = mapDistanceFromView(0.5);
+    dot.moveTo(center.x - half, center.y);
+    dot.lineTo(center.x + half, center.y);
+    return dot;
+}
 
-    // get image for raster image entity:
-    if (sceneQt->hasImageFor(id)) {
-        RImageData image = sceneQt->getImage(id);
-        paintImage(painter, image);
+/**
+ * Paints the given painter paths of one entity. Only reads the state
+ * of the view, so tiles can be painted in multiple threads. The painter
+ * paths of block instances are painted with the given instance transform.
+ */
+void RGraphicsViewImage::paintPainterPaths(QPainter* painter, const QList<RPainterPath>& painterPaths, const QTransform& instanceTransform) {
+    // clip box in the coordinate system of the painter paths:
+    RBox clip = clipBox;
+    bool instance = !instanceTransform.isIdentity();
+    if (instance) {
+        painter->save();
+        painter->setWorldTransform(instanceTransform, true);
+        clip = RGraphicsSceneQt::mapBox(instanceTransform.inverted(), clipBox);
     }
 
     // paint painter paths:
-    QListIterator<RPainterPath> i(painterPaths);
-    while (i.hasNext()) {
-        RPainterPath path = i.next();
+    for (int pi=0; pi<painterPaths.size(); pi++) {
+        const RPainterPath& path = painterPaths.at(pi);
         RBox pathBB = path.getBoundingBox();
 
         // additional bounding box check for painter paths that are
         // part of one block reference entity:
-        if (!isPrinting() && !clipBox.intersects(pathBB)) {
+        if (!isPrinting() && !clip.intersects(pathBB)) {
             continue;
         }
 
@@ -851,7 +1396,6 @@ void RGraphicsViewImage::paintEntity(QPainter* painter, REntity::Id id) {
         }
 
         if (!isPrinting() && (isSelected || path.isSelected())) {
-            RColor selectionColor = RSettings::getColor("GraphicsViewColors/SelectionColor", RColor(164,70,70,128));
             if (pen.style() != Qt::NoPen) {
                 pen.setColor(selectionColor);
             }
@@ -863,7 +1407,7 @@ void RGraphicsViewImage::paintEntity(QPainter* painter, REntity::Id id) {
         painter->setBrush(brush);
         painter->setPen(pen);
 
-        if (isPrinting() || clipBox.contains(pathBB)) {
+        if (isPrinting() || clip.contains(pathBB)) {
             if (brush.style() != Qt::NoBrush) {
                 painter->fillPath(path, brush);
             }
@@ -885,8 +1429,8 @@ void RGraphicsViewImage::paintEntity(QPainter* painter, REntity::Id id) {
                 qreal x2 = path.elementAt(1).x;
                 qreal y2 = path.elementAt(1).y;
                 RLine line(RVector(x1,y1), RVector(x2,y2));
-                if (!clipBox.contains(line.getBoundingBox())) {
-                    line.clipToXY(clipBox);
+                if (!clip.contains(line.getBoundingBox())) {
+                    line.clipToXY(clip);
                 }
 
                 if (line.isValid()) {
@@ -914,8 +1458,8 @@ void RGraphicsViewImage::paintEntity(QPainter* painter, REntity::Id id) {
 
                         if (el.isLineTo()) {
                             RLine line(RVector(x,y), RVector(el.x,el.y));
-                            if (!clipBox.contains(line.getBoundingBox())) {
-                                line.clipToXY(clipBox);
+                            if (!clip.contains(line.getBoundingBox())) {
+                                line.clipToXY(clip);
                             }
                             if (line.isValid()) {
                                 painter->drawLine(QPointF(line.startPoint.x, line.startPoint.y),
@@ -974,6 +1518,10 @@ void RGraphicsViewImage::paintEntity(QPainter* painter, REntity::Id id) {
             }
         }
     }
+
+    if (instance) {
+        painter->restore();
+    }
 }
 
 void RGraphicsViewImage::paintImage(QPainter* painter, RImageData& image) {
@@ -1009,7 +1557,6 @@ void RGraphicsViewImage::paintImage(QPainter* painter, RImageData& image) {
     // draw image in draft mode / selected mode (border in black or white):
     if (scene->getDraftMode() || image.isSelected()) {
         if (image.isSelected()) {
-            RColor selectionColor = RSettings::getColor("GraphicsViewColors/SelectionColor", RColor(164,70,70,128));
             painter->setPen(QPen(QBrush(selectionColor), 0));
         }
         else {
@@ -1043,14 +1590,79 @@ void RGraphicsViewImage::resizeImage(int w, int h) {
     graphicsBuffer = QImage(QSize(w,h), QImage::Format_RGB32);
 }
 
+/**
+ * Enables or disables the tile cache which speeds up panning and zooming
+ * of interactive views. Disabled by default for views that are only
+ * rendered once (e.g. bitmap export).
+ */
 void RGraphicsViewImage::setPanOptimization(bool on) {
     panOptimization = on;
+    if (!on) {
+        clearTileCache();
+    }
 }
 
 bool RGraphicsViewImage::getPanOptimization() {
     return panOptimization;
 }
 
+/**
+ * Removes all cached tiles that intersect the given box, for example
+ * because entities inside the box have changed. The next regeneration
+ * renders only those tiles again.
+ */
+void RGraphicsViewImage::invalidateTiles(const RBox& box) {
+    if (!box.isValid()) {
+        return;
+    }
+
+    tilesInvalidated = true;
+
+    double lineweight = 0.0;
+    RDocument* document = getDocument();
+    if (document!=NULL) {
+        lineweight = RUnit::convert(
+            document->getMaxLineweight()/100.0,
+            RS::Millimeter,
+            document->getUnit()
+        );
+    }
+
+    RVector minimum = box.getMinimum();
+    RVector maximum = box.getMaximum();
+
+    QMap<double, QHash<QPair<qint64, qint64>, QImage> >::iterator it;
+    for (it=tileCache.begin(); it!=tileCache.end(); it++) {
+        double f = it.key();
+
+        // tiles contain everything up to the line weight, points and
+        // antialiasing outside their borders:
+        double margin = lineweight + 2.0 / f;
+        qint64 col1 = getTileIndex((minimum.x - margin) * f);
+        qint64 col2 = getTileIndex((maximum.x + margin) * f);
+        qint64 row1 = getTileIndex(-(maximum.y + margin) * f);
+        qint64 row2 = getTileIndex(-(minimum.y - margin) * f);
+
+        QMutableHashIterator<QPair<qint64, qint64>, QImage> tileIt(it.value());
+        while (tileIt.hasNext()) {
+            tileIt.next();
+            if (tileIt.key().first >= col1 && tileIt.key().first <= col2 &&
+                tileIt.key().second >= row1 && tileIt.key().second <= row2) {
+
+                tileIt.remove();
+            }
+        }
+    }
+}
+
+/**
+ * Removes all cached tiles.
+ */
+void RGraphicsViewImage::clearTileCache() {
+    tileCache.clear();
+    tileCacheFactors.clear();
+}
+
 QImage RGraphicsViewImage::getBuffer() const {
     return graphicsBufferWithPreview;
 }
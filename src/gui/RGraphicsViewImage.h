@@ -25,11 +25,13 @@
 #include <QtCore>
 #include <QPinchGesture>
 
+#include "RColor.h"
 #include "RGraphicsView.h"
 #include "RPainterPath.h"
 
 class RAction;
 class RDocument;
+class RGraphicsViewImageTile;
 class RDocumentInterface;
 class RGraphicsSceneQt;
 class RLine;
@@ -50,6 +52,8 @@ class RSnapRestriction;
  */
 class QCADGUI_EXPORT RGraphicsViewImage : public RGraphicsView {
 
+friend class RGraphicsViewImageTile;
+
 public:
     RGraphicsViewImage();
     virtual ~RGraphicsViewImage();
@@ -229,6 +233,15 @@ public:
     void setPanOptimization(bool on);
     bool getPanOptimization();
 
+    /**
+     * \nonscriptable
+     */
+    void invalidateTiles(const RBox& box);
+    /**
+     * \nonscriptable
+     */
+    void clearTileCache();
+
     virtual void paintEntities(QPainter* painter, const RBox& queryBox);
     virtual void paintEntity(QPainter* painter, REntity::Id id);
 
@@ -269,6 +282,52 @@ protected:
     virtual void paintDocument(const QRect& rect = QRect());
     virtual void paintBackground(QPainter* painter, const QRect& rect = QRect());
 
+    /**
+     * \nonscriptable
+     */
+    void paintEntitiesMultiThreaded(QPainter* painter, const RBox& queryBox, const QRect& rect);
+    /**
+     * \nonscriptable
+     */
+    void queryEntitiesToPaint(const RBox& queryBox, QVector<REntity::Id>& ids);
+    /**
+     * \nonscriptable
+     */
+    QList<RPainterPath> getEntityPainterPaths(REntity::Id id);
+    /**
+     * \nonscriptable
+     */
+    RPainterPath getEntityDot(const QList<RPainterPath>& painterPaths);
+    /**
+     * \nonscriptable
+     */
+    void paintPainterPaths(QPainter* painter, const QList<RPainterPath>& painterPaths, const QTransform& instanceTransform = QTransform());
+    /**
+     * \nonscriptable
+     */
+    void addEntitiesToTiles(const QVector<REntity::Id>& ids, QList<RGraphicsViewImageTile*>& tiles, QSet<REntity::Id>* selected);
+    /**
+     * \nonscriptable
+     */
+    void paintTiles(QList<RGraphicsViewImageTile*>& tiles, int threadCount);
+    /**
+     * \nonscriptable
+     */
+    void paintReferencePoints(QPaintDevice& device);
+
+    /**
+     * \nonscriptable
+     */
+    bool isTileCacheEnabled() const;
+    /**
+     * \nonscriptable
+     */
+    void updateTileCacheState();
+    /**
+     * \nonscriptable
+     */
+    void paintDocumentFromTileCache();
+
     /**
      * \nonscriptable
      */
@@ -306,6 +365,22 @@ protected:
     bool colorCorrectionOverride;
     bool colorCorrection;
     int colorThreshold;
+    RColor selectionColor;
+    int entitySizeThreshold;
+
+    /**
+     * Rendered tiles by zoom factor and tile column / row.
+     */
+    QMap<double, QHash<QPair<qint64, qint64>, QImage> > tileCache;
+    /**
+     * Zoom factors of the tile cache, most recently used first.
+     */
+    QList<double> tileCacheFactors;
+    /**
+     * Settings that were used to render the cached tiles.
+     */
+    QString tileCacheState;
+    bool tilesInvalidated;
 
 //    int textHeightThresholdOverride;
 //    int textHeightThreshold;
@@ -57,6 +57,9 @@ RGraphicsViewQt::RGraphicsViewQt(QWidget* parent, bool showFocus)
 
     grabGesture(Qt::PanGesture);
     grabGesture(Qt::PinchGesture);
+
+    // cache rendered tiles for panning and zooming:
+    setPanOptimization(true);
 }
 
 
@@ -116,6 +116,7 @@ bool RDxfImporter::importFile(const QString& fileName, const QString& nameFilter
 
     if (success==false) {
         qWarning() << "Cannot open DXF file: " << fileName;
+        RImporter::endImport();
         return false;
     }
 
@@ -137,7 +138,6 @@ bool RDxfImporter::importFile(const QString& fileName, const QString& nameFilter
     RImporter::endImport();
 
     // set block reference IDs in the end to support nested blocks (FS#1016):
-    RSpatialIndex& si = document->getSpatialIndex();
     QSet<REntity::Id> ids = document->queryAllBlockReferences();
     QSet<REntity::Id>::const_iterator it;
     for (it=ids.constBegin(); it!=ids.constEnd(); it++) {
@@ -165,9 +165,18 @@ bool RDxfImporter::importFile(const QString& fileName, const QString& nameFilter
 
         blockRef->setReferencedBlockId(blockId);
 
+        if (document->isSpatialIndexDisabled()) {
+            // spatial index is loaded from the cache after the import:
+            continue;
+        }
+
+        RSpatialIndex& si = document->getSpatialIndexForBlock(blockRef->getBlockId());
         si.removeFromIndex(blockRef->getId(), bbs);
         si.addToIndex(blockRef->getId(), blockRef->getBoundingBoxes());
     }
+    if (!document->isSpatialIndexDisabled()) {
+        document->commitSpatialIndex();
+    }
 
 
     // add some variables that need to be there for DXF drawings:
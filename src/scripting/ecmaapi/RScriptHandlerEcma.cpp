@@ -157,6 +157,7 @@
 #include "REcmaMatrix.h"
 #include "REcmaMathLineEdit.h"
 #include "REcmaMdiChildQt.h"
+#include "REcmaMemoryPool.h"
 #include "REcmaMemoryStorage.h"
 #include "REcmaMixedOperation.h"
 #include "REcmaModifyObjectOperation.h"
@@ -264,6 +265,7 @@
 #include "REcmaSolidData.h"
 #include "REcmaSolidEntity.h"
 #include "REcmaSpatialIndex.h"
+#include "REcmaSpatialIndexFlat.h"
 #include "REcmaSpatialIndexNavel.h"
 #include "REcmaSpatialIndexSimple.h"
 #include "REcmaSpatialIndexVisitor.h"
@@ -452,6 +454,7 @@ RScriptHandlerEcma::RScriptHandlerEcma() : engine(NULL), debugger(NULL) {
     REcmaS::init(*engine);
     REcmaUnit::init(*engine);
     REcmaDebug::init(*engine);
+    REcmaMemoryPool::init(*engine);
     REcmaSettings::init(*engine);
     REcmaColor::init(*engine);
     REcmaLineweight::init(*engine);
@@ -506,6 +509,7 @@ RScriptHandlerEcma::RScriptHandlerEcma() : engine(NULL), debugger(NULL) {
 
     REcmaGuiAction::init(*engine);
     REcmaSpatialIndex::init(*engine);
+    REcmaSpatialIndexFlat::init(*engine);
     REcmaSpatialIndexNavel::init(*engine);
     REcmaSpatialIndexSimple::init(*engine);
     REcmaSpatialIndexVisitor::init(*engine);
@@ -7,6 +7,10 @@
 
         // forwards declarations mapped to includes
         
+                #include "RPolyline.h"
+            
+                #include <QDataStream>
+            
                 #include "RVector.h"
             
                 #include "RStorage.h"
@@ -77,6 +81,10 @@
             
             REcmaHelper::registerFunction(&engine, proto, getSpatialIndex, "getSpatialIndex");
             
+            REcmaHelper::registerFunction(&engine, proto, getSpatialIndexForBlock, "getSpatialIndexForBlock");
+            
+            REcmaHelper::registerFunction(&engine, proto, getSpatialIndexForCurrentBlock, "getSpatialIndexForCurrentBlock");
+            
             REcmaHelper::registerFunction(&engine, proto, getTransactionStack, "getTransactionStack");
             
             REcmaHelper::registerFunction(&engine, proto, clear, "clear");
@@ -109,6 +117,12 @@
             
             REcmaHelper::registerFunction(&engine, proto, queryAllBlockReferences, "queryAllBlockReferences");
             
+            REcmaHelper::registerFunction(&engine, proto, getLayerEntityCount, "getLayerEntityCount");
+            
+            REcmaHelper::registerFunction(&engine, proto, getBlockEntityCount, "getBlockEntityCount");
+            
+            REcmaHelper::registerFunction(&engine, proto, getEntityTypeCount, "getEntityTypeCount");
+            
             REcmaHelper::registerFunction(&engine, proto, queryContainedEntities, "queryContainedEntities");
             
             REcmaHelper::registerFunction(&engine, proto, queryIntersectedEntitiesXY, "queryIntersectedEntitiesXY");
@@ -179,10 +193,6 @@
             
             REcmaHelper::registerFunction(&engine, proto, blockContainsReferences, "blockContainsReferences");
             
-            REcmaHelper::registerFunction(&engine, proto, removeBlockFromSpatialIndex, "removeBlockFromSpatialIndex");
-            
-            REcmaHelper::registerFunction(&engine, proto, addBlockToSpatialIndex, "addBlockToSpatialIndex");
-            
             REcmaHelper::registerFunction(&engine, proto, removeFromSpatialIndex, "removeFromSpatialIndex");
             
             REcmaHelper::registerFunction(&engine, proto, updateAllEntities, "updateAllEntities");
@@ -665,6 +675,117 @@
             return result;
         }
          QScriptValue
+        REcmaDocument::getSpatialIndexForBlock
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaDocument::getSpatialIndexForBlock", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaDocument::getSpatialIndexForBlock";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RDocument* self = 
+                        getSelf("getSpatialIndexForBlock", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    1 && (
+            context->argument(0).isNumber()
+        ) /* type: RBlock::Id */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    RBlock::Id
+                    a0 =
+                    (RBlock::Id)
+                    (int)
+                    context->argument( 0 ).
+                    toNumber();
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'RSpatialIndex &'
+    RSpatialIndex & cppResult =
+        
+               self->getSpatialIndexForBlock(a0);
+        // return type: RSpatialIndex &
+                // reference
+                result = engine->newVariant(
+                QVariant::fromValue(&cppResult));
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RDocument.getSpatialIndexForBlock().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaDocument::getSpatialIndexForBlock", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaDocument::getSpatialIndexForCurrentBlock
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaDocument::getSpatialIndexForCurrentBlock", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaDocument::getSpatialIndexForCurrentBlock";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RDocument* self = 
+                        getSelf("getSpatialIndexForCurrentBlock", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'RSpatialIndex &'
+    RSpatialIndex & cppResult =
+        
+               self->getSpatialIndexForCurrentBlock();
+        // return type: RSpatialIndex &
+                // reference
+                result = engine->newVariant(
+                QVariant::fromValue(&cppResult));
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RDocument.getSpatialIndexForCurrentBlock().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaDocument::getSpatialIndexForCurrentBlock", context, engine);
+            return result;
+        }
+         QScriptValue
         REcmaDocument::getTransactionStack
         (QScriptContext* context, QScriptEngine* engine) 
         
@@ -1899,6 +2020,186 @@
             return result;
         }
          QScriptValue
+        REcmaDocument::getLayerEntityCount
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaDocument::getLayerEntityCount", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaDocument::getLayerEntityCount";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RDocument* self = 
+                        getSelf("getLayerEntityCount", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    1 && (
+            context->argument(0).isNumber()
+        ) /* type: RLayer::Id */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    RLayer::Id
+                    a0 =
+                    (RLayer::Id)
+                    (int)
+                    context->argument( 0 ).
+                    toNumber();
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'int'
+    int cppResult =
+        
+               self->getLayerEntityCount(a0);
+        // return type: int
+                // standard Type
+                result = QScriptValue(cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RDocument.getLayerEntityCount().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaDocument::getLayerEntityCount", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaDocument::getBlockEntityCount
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaDocument::getBlockEntityCount", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaDocument::getBlockEntityCount";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RDocument* self = 
+                        getSelf("getBlockEntityCount", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    1 && (
+            context->argument(0).isNumber()
+        ) /* type: RBlock::Id */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    RBlock::Id
+                    a0 =
+                    (RBlock::Id)
+                    (int)
+                    context->argument( 0 ).
+                    toNumber();
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'int'
+    int cppResult =
+        
+               self->getBlockEntityCount(a0);
+        // return type: int
+                // standard Type
+                result = QScriptValue(cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RDocument.getBlockEntityCount().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaDocument::getBlockEntityCount", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaDocument::getEntityTypeCount
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaDocument::getEntityTypeCount", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaDocument::getEntityTypeCount";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RDocument* self = 
+                        getSelf("getEntityTypeCount", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    1 && (
+            context->argument(0).isNumber()
+        ) /* type: RS::EntityType */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    RS::EntityType
+                    a0 =
+                    (RS::EntityType)
+                    (int)
+                    context->argument( 0 ).
+                    toNumber();
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'int'
+    int cppResult =
+        
+               self->getEntityTypeCount(a0);
+        // return type: int
+                // standard Type
+                result = QScriptValue(cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RDocument.getEntityTypeCount().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaDocument::getEntityTypeCount", context, engine);
+            return result;
+        }
+         QScriptValue
         REcmaDocument::queryContainedEntities
         (QScriptContext* context, QScriptEngine* engine) 
         
@@ -5140,134 +5441,6 @@
             return result;
         }
          QScriptValue
-        REcmaDocument::removeBlockFromSpatialIndex
-        (QScriptContext* context, QScriptEngine* engine) 
-        
-        {
-            //REcmaHelper::functionStart("REcmaDocument::removeBlockFromSpatialIndex", context, engine);
-            //qDebug() << "ECMAScript WRAPPER: REcmaDocument::removeBlockFromSpatialIndex";
-            //QCoreApplication::processEvents();
-
-            QScriptValue result = engine->undefinedValue();
-            
-                    // public function: can be called from ECMA wrapper of ECMA shell:
-                    RDocument* self = 
-                        getSelf("removeBlockFromSpatialIndex", context);
-                  
-
-                //Q_ASSERT(self!=NULL);
-                if (self==NULL) {
-                    return REcmaHelper::throwError("self is NULL", context);
-                }
-                
-    
-    if( context->argumentCount() ==
-    1 && (
-            context->argument(0).isNumber()
-        ) /* type: RBlock::Id */
-    
-    ){
-    // prepare arguments:
-    
-                    // argument isStandardType
-                    RBlock::Id
-                    a0 =
-                    (RBlock::Id)
-                    (int)
-                    context->argument( 0 ).
-                    toNumber();
-                
-    // end of arguments
-
-    // call C++ function:
-    // return type 'void'
-    
-               self->removeBlockFromSpatialIndex(a0);
-    } else
-
-
-        
-            {
-               return REcmaHelper::throwError("Wrong number/types of arguments for RDocument.removeBlockFromSpatialIndex().",
-                   context);
-            }
-            //REcmaHelper::functionEnd("REcmaDocument::removeBlockFromSpatialIndex", context, engine);
-            return result;
-        }
-         QScriptValue
-        REcmaDocument::addBlockToSpatialIndex
-        (QScriptContext* context, QScriptEngine* engine) 
-        
-        {
-            //REcmaHelper::functionStart("REcmaDocument::addBlockToSpatialIndex", context, engine);
-            //qDebug() << "ECMAScript WRAPPER: REcmaDocument::addBlockToSpatialIndex";
-            //QCoreApplication::processEvents();
-
-            QScriptValue result = engine->undefinedValue();
-            
-                    // public function: can be called from ECMA wrapper of ECMA shell:
-                    RDocument* self = 
-                        getSelf("addBlockToSpatialIndex", context);
-                  
-
-                //Q_ASSERT(self!=NULL);
-                if (self==NULL) {
-                    return REcmaHelper::throwError("self is NULL", context);
-                }
-                
-    
-    if( context->argumentCount() ==
-    2 && (
-            context->argument(0).isNumber()
-        ) /* type: RBlock::Id */
-     && (
-            context->argument(1).isNumber()
-        ) /* type: RObject::Id */
-    
-    ){
-    // prepare arguments:
-    
-                    // argument isStandardType
-                    RBlock::Id
-                    a0 =
-                    (RBlock::Id)
-                    (int)
-                    context->argument( 0 ).
-                    toNumber();
-                
-                    // argument isStandardType
-                    RObject::Id
-                    a1 =
-                    (RObject::Id)
-                    (int)
-                    context->argument( 1 ).
-                    toNumber();
-                
-    // end of arguments
-
-    // call C++ function:
-    // return type 'bool'
-    bool cppResult =
-        
-               self->addBlockToSpatialIndex(a0
-        ,
-    a1);
-        // return type: bool
-                // standard Type
-                result = QScriptValue(cppResult);
-            
-    } else
-
-
-        
-            {
-               return REcmaHelper::throwError("Wrong number/types of arguments for RDocument.addBlockToSpatialIndex().",
-                   context);
-            }
-            //REcmaHelper::functionEnd("REcmaDocument::addBlockToSpatialIndex", context, engine);
-            return result;
-        }
-         QScriptValue
         REcmaDocument::removeFromSpatialIndex
         (QScriptContext* context, QScriptEngine* engine) 
         
@@ -54,6 +54,12 @@
         getSpatialIndex
         (QScriptContext* context, QScriptEngine* engine) 
         ;static  QScriptValue
+        getSpatialIndexForBlock
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
+        getSpatialIndexForCurrentBlock
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
         getTransactionStack
         (QScriptContext* context, QScriptEngine* engine) 
         ;static  QScriptValue
@@ -102,6 +108,15 @@
         queryAllBlockReferences
         (QScriptContext* context, QScriptEngine* engine) 
         ;static  QScriptValue
+        getLayerEntityCount
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
+        getBlockEntityCount
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
+        getEntityTypeCount
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
         queryContainedEntities
         (QScriptContext* context, QScriptEngine* engine) 
         ;static  QScriptValue
@@ -207,12 +222,6 @@
         blockContainsReferences
         (QScriptContext* context, QScriptEngine* engine) 
         ;static  QScriptValue
-        removeBlockFromSpatialIndex
-        (QScriptContext* context, QScriptEngine* engine) 
-        ;static  QScriptValue
-        addBlockToSpatialIndex
-        (QScriptContext* context, QScriptEngine* engine) 
-        ;static  QScriptValue
         removeFromSpatialIndex
         (QScriptContext* context, QScriptEngine* engine) 
         ;static  QScriptValue
@@ -0,0 +1,597 @@
+// ***** AUTOGENERATED CODE, DO NOT EDIT *****
+            // ***** This class is not copyable.
+        
+        #include "REcmaMemoryPool.h"
+        #include "RMetaTypes.h"
+        #include "../REcmaHelper.h"
+
+        // forwards declarations mapped to includes
+        
+            
+        // includes for base ecma wrapper classes
+         void REcmaMemoryPool::init(QScriptEngine& engine, QScriptValue* proto 
+    
+    ) 
+    
+    {
+
+    bool protoCreated = false;
+    if(proto == NULL){
+        proto = new QScriptValue(engine.newVariant(qVariantFromValue(
+                (RMemoryPool*) 0)));
+        protoCreated = true;
+    }
+
+    
+
+    QScriptValue fun;
+
+    // toString:
+    REcmaHelper::registerFunction(&engine, proto, toString, "toString");
+    
+
+    // destroy:
+    REcmaHelper::registerFunction(&engine, proto, destroy, "destroy");
+    
+
+    // get class name
+    REcmaHelper::registerFunction(&engine, proto, getClassName, "getClassName");
+    
+
+    // conversion to all base classes (multiple inheritance):
+    REcmaHelper::registerFunction(&engine, proto, getBaseClasses, "getBaseClasses");
+    
+
+    // properties:
+    
+
+    // methods:
+    
+        engine.setDefaultPrototype(
+            qMetaTypeId<RMemoryPool*>(), *proto);
+
+        
+    
+
+    QScriptValue ctor = engine.newFunction(create, *proto, 2);
+    
+    // static methods:
+    
+            REcmaHelper::registerFunction(&engine, &ctor, setEnabled, "setEnabled");
+            
+            REcmaHelper::registerFunction(&engine, &ctor, isEnabled, "isEnabled");
+            
+            REcmaHelper::registerFunction(&engine, &ctor, release, "release");
+            
+            REcmaHelper::registerFunction(&engine, &ctor, getReservedBytes, "getReservedBytes");
+            
+            REcmaHelper::registerFunction(&engine, &ctor, getUsedBytes, "getUsedBytes");
+            
+            REcmaHelper::registerFunction(&engine, &ctor, getPeakUsedBytes, "getPeakUsedBytes");
+            
+            REcmaHelper::registerFunction(&engine, &ctor, getBlockCount, "getBlockCount");
+            
+            REcmaHelper::registerFunction(&engine, &ctor, getChunkCount, "getChunkCount");
+            
+            REcmaHelper::registerFunction(&engine, &ctor, getStatistics, "getStatistics");
+            
+
+    // static properties:
+    
+
+    // enum values:
+    
+
+    // enum conversions:
+    
+        
+    // init class:
+    engine.globalObject().setProperty("RMemoryPool",
+    ctor, QScriptValue::SkipInEnumeration);
+    
+    if( protoCreated ){
+       delete proto;
+    }
+    
+    }
+     QScriptValue REcmaMemoryPool::create(QScriptContext* context, QScriptEngine* engine) 
+    
+    {
+    if (context->thisObject().strictlyEquals(
+       engine->globalObject())) {
+       return REcmaHelper::throwError(
+       QString::fromLatin1("RMemoryPool(): Did you forget to construct with 'new'?"),
+           context);
+    }
+
+    QScriptValue result;
+    
+            // constructor without variants:
+            
+    if( context->argumentCount() ==
+        0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ constructor:
+    
+            // non-copyable class:
+            RMemoryPool
+                    * cppResult =
+                    new
+                    RMemoryPool
+                    ();
+                
+                    // TODO: triggers: Warning: QScriptEngine::newVariant(): changing class of non-QScriptObject not supported:
+                    result = engine->newVariant(context->thisObject(), qVariantFromValue(cppResult));
+                
+    } else 
+
+    {
+       return REcmaHelper::throwError(
+       QString::fromLatin1("RMemoryPool(): no matching constructor found."),
+           context);
+    }
+    
+    return result;
+    }
+    
+
+    // conversion functions for base classes:
+    
+
+    // returns class name:
+     QScriptValue REcmaMemoryPool::getClassName(QScriptContext *context, QScriptEngine *engine) 
+        
+    {
+        return qScriptValueFromValue(engine, QString("RMemoryPool"));
+    }
+    
+
+    // returns all base classes (in case of multiple inheritance):
+     QScriptValue REcmaMemoryPool::getBaseClasses(QScriptContext *context, QScriptEngine *engine) 
+        
+    {
+        QStringList list;
+        
+
+        return qScriptValueFromSequence(engine, list);
+    }
+    
+
+    // properties:
+    
+
+    // public methods:
+     QScriptValue
+        REcmaMemoryPool::setEnabled
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaMemoryPool::setEnabled", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaMemoryPool::setEnabled";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+    
+    if( context->argumentCount() ==
+    1 && (
+            context->argument(0).isBool()
+        ) /* type: bool */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    bool
+                    a0 =
+                    (bool)
+                    
+                    context->argument( 0 ).
+                    toBool();
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'void'
+    RMemoryPool::
+       setEnabled(a0);
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RMemoryPool.setEnabled().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaMemoryPool::setEnabled", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaMemoryPool::isEnabled
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaMemoryPool::isEnabled", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaMemoryPool::isEnabled";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'bool'
+    bool cppResult =
+        RMemoryPool::
+       isEnabled();
+        // return type: bool
+                // standard Type
+                result = QScriptValue(cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RMemoryPool.isEnabled().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaMemoryPool::isEnabled", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaMemoryPool::release
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaMemoryPool::release", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaMemoryPool::release";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'void'
+    RMemoryPool::
+       release();
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RMemoryPool.release().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaMemoryPool::release", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaMemoryPool::getReservedBytes
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaMemoryPool::getReservedBytes", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaMemoryPool::getReservedBytes";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'qint64'
+    qint64 cppResult =
+        RMemoryPool::
+       getReservedBytes();
+        // return type: qint64
+                // not standard type nor reference
+                result = qScriptValueFromValue(engine, cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RMemoryPool.getReservedBytes().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaMemoryPool::getReservedBytes", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaMemoryPool::getUsedBytes
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaMemoryPool::getUsedBytes", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaMemoryPool::getUsedBytes";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'qint64'
+    qint64 cppResult =
+        RMemoryPool::
+       getUsedBytes();
+        // return type: qint64
+                // not standard type nor reference
+                result = qScriptValueFromValue(engine, cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RMemoryPool.getUsedBytes().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaMemoryPool::getUsedBytes", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaMemoryPool::getPeakUsedBytes
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaMemoryPool::getPeakUsedBytes", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaMemoryPool::getPeakUsedBytes";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'qint64'
+    qint64 cppResult =
+        RMemoryPool::
+       getPeakUsedBytes();
+        // return type: qint64
+                // not standard type nor reference
+                result = qScriptValueFromValue(engine, cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RMemoryPool.getPeakUsedBytes().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaMemoryPool::getPeakUsedBytes", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaMemoryPool::getBlockCount
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaMemoryPool::getBlockCount", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaMemoryPool::getBlockCount";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'qint64'
+    qint64 cppResult =
+        RMemoryPool::
+       getBlockCount();
+        // return type: qint64
+                // not standard type nor reference
+                result = qScriptValueFromValue(engine, cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RMemoryPool.getBlockCount().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaMemoryPool::getBlockCount", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaMemoryPool::getChunkCount
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaMemoryPool::getChunkCount", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaMemoryPool::getChunkCount";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'qint64'
+    qint64 cppResult =
+        RMemoryPool::
+       getChunkCount();
+        // return type: qint64
+                // not standard type nor reference
+                result = qScriptValueFromValue(engine, cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RMemoryPool.getChunkCount().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaMemoryPool::getChunkCount", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaMemoryPool::getStatistics
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaMemoryPool::getStatistics", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaMemoryPool::getStatistics";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'QString'
+    QString cppResult =
+        RMemoryPool::
+       getStatistics();
+        // return type: QString
+                // standard Type
+                result = QScriptValue(cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RMemoryPool.getStatistics().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaMemoryPool::getStatistics", context, engine);
+            return result;
+        }
+         QScriptValue REcmaMemoryPool::toString
+    (QScriptContext *context, QScriptEngine *engine)
+    
+    {
+
+    RMemoryPool* self = getSelf("toString", context);
+    
+    QString result;
+    
+            result = QString("RMemoryPool(0x%1)").arg((unsigned long int)self, 0, 16);
+        
+    return QScriptValue(result);
+    }
+     QScriptValue REcmaMemoryPool::destroy(QScriptContext *context, QScriptEngine *engine)
+    
+    {
+
+        RMemoryPool* self = getSelf("RMemoryPool", context);
+        //Q_ASSERT(self!=NULL);
+        if (self==NULL) {
+            return REcmaHelper::throwError("self is NULL", context);
+        }
+        
+    
+        delete self;
+        context->thisObject().setData(engine->nullValue());
+        context->thisObject().prototype().setData(engine->nullValue());
+        context->thisObject().setPrototype(engine->nullValue());
+        context->thisObject().setScriptClass(NULL);
+        return engine->undefinedValue();
+    }
+    RMemoryPool* REcmaMemoryPool::getSelf(const QString& fName, QScriptContext* context)
+    
+        {
+            RMemoryPool* self = NULL;
+
+            
+                // self could be a normal object (e.g. from an UI file) or
+                // an ECMA shell object (made from an ECMA script):
+                //self = getSelfShell(fName, context);
+                
+
+            //if (self==NULL) {
+                self = REcmaHelper::scriptValueTo<RMemoryPool >(context->thisObject())
+                
+                ;
+            //}
+
+            if (self == NULL){
+                // avoid recursion (toString is used by the backtrace):
+                if (fName!="toString") {
+                    REcmaHelper::throwError(QString("RMemoryPool.%1(): "
+                        "This object is not a RMemoryPool").arg(fName),
+                        context);
+                }
+                return NULL;
+            }
+
+            return self;
+        }
+        RMemoryPool* REcmaMemoryPool::getSelfShell(const QString& fName, QScriptContext* context)
+    
+        {
+          RMemoryPool* selfBase = getSelf(fName, context);
+                RMemoryPool* self = dynamic_cast<RMemoryPool*>(selfBase);
+                //return REcmaHelper::scriptValueTo<RMemoryPool >(context->thisObject());
+            if(self == NULL){
+                REcmaHelper::throwError(QString("RMemoryPool.%1(): "
+                    "This object is not a RMemoryPool").arg(fName),
+                    context);
+            }
+
+            return self;
+            
+
+
+        }
+        
\ No newline at end of file
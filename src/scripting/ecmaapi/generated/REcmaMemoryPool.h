@@ -0,0 +1,79 @@
+// ***** AUTOGENERATED CODE, DO NOT EDIT *****
+            // ***** This class is not copyable.
+        
+        #ifndef RECMAMEMORYPOOL_H
+        #define RECMAMEMORYPOOL_H
+
+        #include "ecmaapi_global.h"
+
+        #include <QScriptEngine>
+        #include <QScriptValue>
+        #include <QScriptContextInfo>
+        #include <QDebug>
+
+        
+                #include "RMemoryPool.h"
+            
+
+        /**
+         * \ingroup scripting_ecmaapi
+         */
+        class QCADECMAAPI_EXPORT REcmaMemoryPool {
+
+        public:
+      static  void init(QScriptEngine& engine, QScriptValue* proto 
+    =NULL
+    ) 
+    ;static  QScriptValue create(QScriptContext* context, QScriptEngine* engine) 
+    ;
+
+    // conversion functions for base classes:
+    
+
+    // returns class name:
+    static  QScriptValue getClassName(QScriptContext *context, QScriptEngine *engine) 
+        ;
+
+    // returns all base classes (in case of multiple inheritance):
+    static  QScriptValue getBaseClasses(QScriptContext *context, QScriptEngine *engine) 
+        ;
+
+    // properties:
+    
+
+    // public methods:
+    static  QScriptValue
+        setEnabled
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
+        isEnabled
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
+        release
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
+        getReservedBytes
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
+        getUsedBytes
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
+        getPeakUsedBytes
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
+        getBlockCount
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
+        getChunkCount
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue
+        getStatistics
+        (QScriptContext* context, QScriptEngine* engine) 
+        ;static  QScriptValue toString
+    (QScriptContext *context, QScriptEngine *engine)
+    ;static  QScriptValue destroy(QScriptContext *context, QScriptEngine *engine)
+    ;static RMemoryPool* getSelf(const QString& fName, QScriptContext* context)
+    ;static RMemoryPool* getSelfShell(const QString& fName, QScriptContext* context)
+    ;};
+    #endif
+    
\ No newline at end of file
@@ -0,0 +1,1648 @@
+// ***** AUTOGENERATED CODE, DO NOT EDIT *****
+            // ***** This class is not copyable.
+        
+        #include "REcmaSpatialIndexFlat.h"
+        #include "RMetaTypes.h"
+        #include "../REcmaHelper.h"
+
+        // forwards declarations mapped to includes
+        
+            
+        // includes for base ecma wrapper classes
+        
+                  #include "REcmaSpatialIndex.h"
+                 void REcmaSpatialIndexFlat::init(QScriptEngine& engine, QScriptValue* proto 
+    
+    ) 
+    
+    {
+
+    bool protoCreated = false;
+    if(proto == NULL){
+        proto = new QScriptValue(engine.newVariant(qVariantFromValue(
+                (RSpatialIndexFlat*) 0)));
+        protoCreated = true;
+    }
+
+    
+        // primary base class RSpatialIndex:
+        
+            QScriptValue dpt = engine.defaultPrototype(
+                qMetaTypeId<RSpatialIndex*>());
+
+            if (dpt.isValid()) {
+                proto->setPrototype(dpt);
+            }
+          
+        /*
+        
+        */
+    
+
+    QScriptValue fun;
+
+    // toString:
+    REcmaHelper::registerFunction(&engine, proto, toString, "toString");
+    
+
+    // destroy:
+    REcmaHelper::registerFunction(&engine, proto, destroy, "destroy");
+    
+        // conversion for base class RSpatialIndex
+        REcmaHelper::registerFunction(&engine, proto, getRSpatialIndex, "getRSpatialIndex");
+        
+        // conversion for base class RRequireHeap
+        REcmaHelper::registerFunction(&engine, proto, getRRequireHeap, "getRRequireHeap");
+        
+
+    // get class name
+    REcmaHelper::registerFunction(&engine, proto, getClassName, "getClassName");
+    
+
+    // conversion to all base classes (multiple inheritance):
+    REcmaHelper::registerFunction(&engine, proto, getBaseClasses, "getBaseClasses");
+    
+
+    // properties:
+    
+
+    // methods:
+    
+            REcmaHelper::registerFunction(&engine, proto, clear, "clear");
+            
+            REcmaHelper::registerFunction(&engine, proto, addToIndex, "addToIndex");
+            
+            REcmaHelper::registerFunction(&engine, proto, removeFromIndex, "removeFromIndex");
+            
+            REcmaHelper::registerFunction(&engine, proto, queryIntersected, "queryIntersected");
+            
+            REcmaHelper::registerFunction(&engine, proto, queryContained, "queryContained");
+            
+            REcmaHelper::registerFunction(&engine, proto, queryNearestNeighbor, "queryNearestNeighbor");
+            
+            REcmaHelper::registerFunction(&engine, proto, getSize, "getSize");
+            
+            REcmaHelper::registerFunction(&engine, proto, getHeight, "getHeight");
+            
+        engine.setDefaultPrototype(
+            qMetaTypeId<RSpatialIndexFlat*>(), *proto);
+
+        
+    
+
+    QScriptValue ctor = engine.newFunction(create, *proto, 2);
+    
+    // static methods:
+    
+
+    // static properties:
+    
+
+    // enum values:
+    
+
+    // enum conversions:
+    
+        
+    // init class:
+    engine.globalObject().setProperty("RSpatialIndexFlat",
+    ctor, QScriptValue::SkipInEnumeration);
+    
+    if( protoCreated ){
+       delete proto;
+    }
+    
+    }
+     QScriptValue REcmaSpatialIndexFlat::create(QScriptContext* context, QScriptEngine* engine) 
+    
+    {
+    if (context->thisObject().strictlyEquals(
+       engine->globalObject())) {
+       return REcmaHelper::throwError(
+       QString::fromLatin1("RSpatialIndexFlat(): Did you forget to construct with 'new'?"),
+           context);
+    }
+
+    QScriptValue result;
+        
+            // generate constructor variants:
+            
+    if( context->argumentCount() ==
+        0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ constructor:
+    
+            // non-copyable class:
+            RSpatialIndexFlat
+                    * cppResult =
+                    new
+                    RSpatialIndexFlat
+                    ();
+                
+                    // TODO: triggers: Warning: QScriptEngine::newVariant(): changing class of non-QScriptObject not supported:
+                    result = engine->newVariant(context->thisObject(), qVariantFromValue(cppResult));
+                
+    } else 
+
+    {
+       return REcmaHelper::throwError(
+       QString::fromLatin1("RSpatialIndexFlat(): no matching constructor found."),
+           context);
+    }
+    
+    return result;
+    }
+    
+
+    // conversion functions for base classes:
+     QScriptValue REcmaSpatialIndexFlat::getRSpatialIndex(QScriptContext *context,
+            QScriptEngine *engine)
+        
+            {
+                RSpatialIndex* cppResult =
+                    qscriptvalue_cast<RSpatialIndexFlat*> (context->thisObject());
+                QScriptValue result = qScriptValueFromValue(engine, cppResult);
+                return result;
+            }
+             QScriptValue REcmaSpatialIndexFlat::getRRequireHeap(QScriptContext *context,
+            QScriptEngine *engine)
+        
+            {
+                RRequireHeap* cppResult =
+                    qscriptvalue_cast<RSpatialIndexFlat*> (context->thisObject());
+                QScriptValue result = qScriptValueFromValue(engine, cppResult);
+                return result;
+            }
+            
+
+    // returns class name:
+     QScriptValue REcmaSpatialIndexFlat::getClassName(QScriptContext *context, QScriptEngine *engine) 
+        
+    {
+        return qScriptValueFromValue(engine, QString("RSpatialIndexFlat"));
+    }
+    
+
+    // returns all base classes (in case of multiple inheritance):
+     QScriptValue REcmaSpatialIndexFlat::getBaseClasses(QScriptContext *context, QScriptEngine *engine) 
+        
+    {
+        QStringList list;
+        
+        list.append("RSpatialIndex");
+    
+        list.append("RRequireHeap");
+    
+
+        return qScriptValueFromSequence(engine, list);
+    }
+    
+
+    // properties:
+    
+
+    // public methods:
+     QScriptValue
+        REcmaSpatialIndexFlat::clear
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaSpatialIndexFlat::clear", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaSpatialIndexFlat::clear";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RSpatialIndexFlat* self = 
+                        getSelf("clear", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'void'
+    
+               self->clear();
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RSpatialIndexFlat.clear().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaSpatialIndexFlat::clear", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaSpatialIndexFlat::addToIndex
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaSpatialIndexFlat::addToIndex", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaSpatialIndexFlat::addToIndex";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RSpatialIndexFlat* self = 
+                        getSelf("addToIndex", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    8 && (
+            context->argument(0).isNumber()
+        ) /* type: int */
+     && (
+            context->argument(1).isNumber()
+        ) /* type: int */
+     && (
+            context->argument(2).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(3).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(4).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(5).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(6).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(7).isNumber()
+        ) /* type: double */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    int
+                    a0 =
+                    (int)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    int
+                    a1 =
+                    (int)
+                    
+                    context->argument( 1 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a2 =
+                    (double)
+                    
+                    context->argument( 2 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a3 =
+                    (double)
+                    
+                    context->argument( 3 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a4 =
+                    (double)
+                    
+                    context->argument( 4 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a5 =
+                    (double)
+                    
+                    context->argument( 5 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a6 =
+                    (double)
+                    
+                    context->argument( 6 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a7 =
+                    (double)
+                    
+                    context->argument( 7 ).
+                    toNumber();
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'void'
+    
+               self->addToIndex(a0
+        ,
+    a1
+        ,
+    a2
+        ,
+    a3
+        ,
+    a4
+        ,
+    a5
+        ,
+    a6
+        ,
+    a7);
+    } else
+
+
+        
+    
+    if( context->argumentCount() ==
+    3 && (
+            context->argument(0).isNumber()
+        ) /* type: int */
+     && (
+            context->argument(1).isNumber()
+        ) /* type: int */
+     && (
+            context->argument(2).isVariant() || 
+            context->argument(2).isQObject() || 
+            context->argument(2).isNull()
+        ) /* type: RBox */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    int
+                    a0 =
+                    (int)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    int
+                    a1 =
+                    (int)
+                    
+                    context->argument( 1 ).
+                    toNumber();
+                
+                    // argument isCopyable and has default constructor and isSimpleClass 
+                    RBox*
+                    ap2 =
+                    qscriptvalue_cast<
+                    RBox*
+                        >(
+                        context->argument(
+                        2
+                        )
+                    );
+                    if (ap2 == NULL) {
+                           return REcmaHelper::throwError("RSpatialIndexFlat: Argument 2 is not of type RBox.",
+                               context);                    
+                    }
+                    RBox 
+                    a2 = 
+                    *ap2;
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'void'
+    
+               self->addToIndex(a0
+        ,
+    a1
+        ,
+    a2);
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RSpatialIndexFlat.addToIndex().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaSpatialIndexFlat::addToIndex", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaSpatialIndexFlat::removeFromIndex
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaSpatialIndexFlat::removeFromIndex", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaSpatialIndexFlat::removeFromIndex";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RSpatialIndexFlat* self = 
+                        getSelf("removeFromIndex", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    2 && (
+            context->argument(0).isNumber()
+        ) /* type: int */
+     && (
+            context->argument(1).isArray()
+        ) /* type: QList < RBox > */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    int
+                    a0 =
+                    (int)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isArray
+                    QList < RBox >
+                    a1;
+                    REcmaHelper::fromScriptValue(
+                        engine,
+                        context->argument(1),
+                        a1
+                    );
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'bool'
+    bool cppResult =
+        
+               self->removeFromIndex(a0
+        ,
+    a1);
+        // return type: bool
+                // standard Type
+                result = QScriptValue(cppResult);
+            
+    } else
+
+
+        
+    
+    if( context->argumentCount() ==
+    3 && (
+            context->argument(0).isNumber()
+        ) /* type: int */
+     && (
+            context->argument(1).isNumber()
+        ) /* type: int */
+     && (
+            context->argument(2).isVariant() || 
+            context->argument(2).isQObject() || 
+            context->argument(2).isNull()
+        ) /* type: RBox */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    int
+                    a0 =
+                    (int)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    int
+                    a1 =
+                    (int)
+                    
+                    context->argument( 1 ).
+                    toNumber();
+                
+                    // argument isCopyable and has default constructor and isSimpleClass 
+                    RBox*
+                    ap2 =
+                    qscriptvalue_cast<
+                    RBox*
+                        >(
+                        context->argument(
+                        2
+                        )
+                    );
+                    if (ap2 == NULL) {
+                           return REcmaHelper::throwError("RSpatialIndexFlat: Argument 2 is not of type RBox.",
+                               context);                    
+                    }
+                    RBox 
+                    a2 = 
+                    *ap2;
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'bool'
+    bool cppResult =
+        
+               self->removeFromIndex(a0
+        ,
+    a1
+        ,
+    a2);
+        // return type: bool
+                // standard Type
+                result = QScriptValue(cppResult);
+            
+    } else
+
+
+        
+    
+    if( context->argumentCount() ==
+    8 && (
+            context->argument(0).isNumber()
+        ) /* type: int */
+     && (
+            context->argument(1).isNumber()
+        ) /* type: int */
+     && (
+            context->argument(2).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(3).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(4).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(5).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(6).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(7).isNumber()
+        ) /* type: double */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    int
+                    a0 =
+                    (int)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    int
+                    a1 =
+                    (int)
+                    
+                    context->argument( 1 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a2 =
+                    (double)
+                    
+                    context->argument( 2 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a3 =
+                    (double)
+                    
+                    context->argument( 3 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a4 =
+                    (double)
+                    
+                    context->argument( 4 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a5 =
+                    (double)
+                    
+                    context->argument( 5 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a6 =
+                    (double)
+                    
+                    context->argument( 6 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a7 =
+                    (double)
+                    
+                    context->argument( 7 ).
+                    toNumber();
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'bool'
+    bool cppResult =
+        
+               self->removeFromIndex(a0
+        ,
+    a1
+        ,
+    a2
+        ,
+    a3
+        ,
+    a4
+        ,
+    a5
+        ,
+    a6
+        ,
+    a7);
+        // return type: bool
+                // standard Type
+                result = QScriptValue(cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RSpatialIndexFlat.removeFromIndex().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaSpatialIndexFlat::removeFromIndex", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaSpatialIndexFlat::queryIntersected
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaSpatialIndexFlat::queryIntersected", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaSpatialIndexFlat::queryIntersected";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RSpatialIndexFlat* self = 
+                        getSelf("queryIntersected", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    6 && (
+            context->argument(0).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(1).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(2).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(3).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(4).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(5).isNumber()
+        ) /* type: double */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    double
+                    a0 =
+                    (double)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a1 =
+                    (double)
+                    
+                    context->argument( 1 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a2 =
+                    (double)
+                    
+                    context->argument( 2 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a3 =
+                    (double)
+                    
+                    context->argument( 3 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a4 =
+                    (double)
+                    
+                    context->argument( 4 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a5 =
+                    (double)
+                    
+                    context->argument( 5 ).
+                    toNumber();
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'QMap < int , QSet < int > >'
+    QMap < int , QSet < int > > cppResult =
+        
+               self->queryIntersected(a0
+        ,
+    a1
+        ,
+    a2
+        ,
+    a3
+        ,
+    a4
+        ,
+    a5);
+        // return type: QMap < int , QSet < int > >
+                // not standard type nor reference
+                result = qScriptValueFromValue(engine, cppResult);
+            
+    } else
+
+
+        
+    
+    if( context->argumentCount() ==
+    7 && (
+            context->argument(0).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(1).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(2).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(3).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(4).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(5).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(6).isVariant() || 
+            context->argument(6).isQObject() || 
+            context->argument(6).isNull()
+        ) /* type: RSpatialIndexVisitor * */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    double
+                    a0 =
+                    (double)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a1 =
+                    (double)
+                    
+                    context->argument( 1 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a2 =
+                    (double)
+                    
+                    context->argument( 2 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a3 =
+                    (double)
+                    
+                    context->argument( 3 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a4 =
+                    (double)
+                    
+                    context->argument( 4 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a5 =
+                    (double)
+                    
+                    context->argument( 5 ).
+                    toNumber();
+                
+                    // argument is pointer
+                    RSpatialIndexVisitor * a6 = NULL;
+
+                    a6 = 
+                        REcmaHelper::scriptValueTo<RSpatialIndexVisitor >(
+                            context->argument(6)
+                        );
+                    
+                    if (a6==NULL && 
+                        !context->argument(6).isNull()) {
+                        return REcmaHelper::throwError("RSpatialIndexFlat: Argument 6 is not of type RSpatialIndexVisitor *RSpatialIndexVisitor *.", context);                    
+                    }
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'QMap < int , QSet < int > >'
+    QMap < int , QSet < int > > cppResult =
+        
+               self->queryIntersected(a0
+        ,
+    a1
+        ,
+    a2
+        ,
+    a3
+        ,
+    a4
+        ,
+    a5
+        ,
+    a6);
+        // return type: QMap < int , QSet < int > >
+                // not standard type nor reference
+                result = qScriptValueFromValue(engine, cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RSpatialIndexFlat.queryIntersected().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaSpatialIndexFlat::queryIntersected", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaSpatialIndexFlat::queryContained
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaSpatialIndexFlat::queryContained", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaSpatialIndexFlat::queryContained";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RSpatialIndexFlat* self = 
+                        getSelf("queryContained", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    6 && (
+            context->argument(0).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(1).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(2).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(3).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(4).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(5).isNumber()
+        ) /* type: double */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    double
+                    a0 =
+                    (double)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a1 =
+                    (double)
+                    
+                    context->argument( 1 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a2 =
+                    (double)
+                    
+                    context->argument( 2 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a3 =
+                    (double)
+                    
+                    context->argument( 3 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a4 =
+                    (double)
+                    
+                    context->argument( 4 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a5 =
+                    (double)
+                    
+                    context->argument( 5 ).
+                    toNumber();
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'QMap < int , QSet < int > >'
+    QMap < int , QSet < int > > cppResult =
+        
+               self->queryContained(a0
+        ,
+    a1
+        ,
+    a2
+        ,
+    a3
+        ,
+    a4
+        ,
+    a5);
+        // return type: QMap < int , QSet < int > >
+                // not standard type nor reference
+                result = qScriptValueFromValue(engine, cppResult);
+            
+    } else
+
+
+        
+    
+    if( context->argumentCount() ==
+    7 && (
+            context->argument(0).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(1).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(2).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(3).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(4).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(5).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(6).isVariant() || 
+            context->argument(6).isQObject() || 
+            context->argument(6).isNull()
+        ) /* type: RSpatialIndexVisitor * */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    double
+                    a0 =
+                    (double)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a1 =
+                    (double)
+                    
+                    context->argument( 1 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a2 =
+                    (double)
+                    
+                    context->argument( 2 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a3 =
+                    (double)
+                    
+                    context->argument( 3 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a4 =
+                    (double)
+                    
+                    context->argument( 4 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a5 =
+                    (double)
+                    
+                    context->argument( 5 ).
+                    toNumber();
+                
+                    // argument is pointer
+                    RSpatialIndexVisitor * a6 = NULL;
+
+                    a6 = 
+                        REcmaHelper::scriptValueTo<RSpatialIndexVisitor >(
+                            context->argument(6)
+                        );
+                    
+                    if (a6==NULL && 
+                        !context->argument(6).isNull()) {
+                        return REcmaHelper::throwError("RSpatialIndexFlat: Argument 6 is not of type RSpatialIndexVisitor *RSpatialIndexVisitor *.", context);                    
+                    }
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'QMap < int , QSet < int > >'
+    QMap < int , QSet < int > > cppResult =
+        
+               self->queryContained(a0
+        ,
+    a1
+        ,
+    a2
+        ,
+    a3
+        ,
+    a4
+        ,
+    a5
+        ,
+    a6);
+        // return type: QMap < int , QSet < int > >
+                // not standard type nor reference
+                result = qScriptValueFromValue(engine, cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RSpatialIndexFlat.queryContained().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaSpatialIndexFlat::queryContained", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaSpatialIndexFlat::queryNearestNeighbor
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaSpatialIndexFlat::queryNearestNeighbor", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaSpatialIndexFlat::queryNearestNeighbor";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RSpatialIndexFlat* self = 
+                        getSelf("queryNearestNeighbor", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    4 && (
+            context->argument(0).isNumber()
+        ) /* type: int */
+     && (
+            context->argument(1).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(2).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(3).isNumber()
+        ) /* type: double */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    int
+                    a0 =
+                    (int)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a1 =
+                    (double)
+                    
+                    context->argument( 1 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a2 =
+                    (double)
+                    
+                    context->argument( 2 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a3 =
+                    (double)
+                    
+                    context->argument( 3 ).
+                    toNumber();
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'QMap < int , QSet < int > >'
+    QMap < int , QSet < int > > cppResult =
+        
+               self->queryNearestNeighbor(a0
+        ,
+    a1
+        ,
+    a2
+        ,
+    a3);
+        // return type: QMap < int , QSet < int > >
+                // not standard type nor reference
+                result = qScriptValueFromValue(engine, cppResult);
+            
+    } else
+
+
+        
+    
+    if( context->argumentCount() ==
+    5 && (
+            context->argument(0).isNumber()
+        ) /* type: int */
+     && (
+            context->argument(1).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(2).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(3).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(4).isVariant() || 
+            context->argument(4).isQObject() || 
+            context->argument(4).isNull()
+        ) /* type: RSpatialIndexVisitor * */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    int
+                    a0 =
+                    (int)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a1 =
+                    (double)
+                    
+                    context->argument( 1 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a2 =
+                    (double)
+                    
+                    context->argument( 2 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a3 =
+                    (double)
+                    
+                    context->argument( 3 ).
+                    toNumber();
+                
+                    // argument is pointer
+                    RSpatialIndexVisitor * a4 = NULL;
+
+                    a4 = 
+                        REcmaHelper::scriptValueTo<RSpatialIndexVisitor >(
+                            context->argument(4)
+                        );
+                    
+                    if (a4==NULL && 
+                        !context->argument(4).isNull()) {
+                        return REcmaHelper::throwError("RSpatialIndexFlat: Argument 4 is not of type RSpatialIndexVisitor *RSpatialIndexVisitor *.", context);                    
+                    }
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'QMap < int , QSet < int > >'
+    QMap < int , QSet < int > > cppResult =
+        
+               self->queryNearestNeighbor(a0
+        ,
+    a1
+        ,
+    a2
+        ,
+    a3
+        ,
+    a4);
+        // return type: QMap < int , QSet < int > >
+                // not standard type nor reference
+                result = qScriptValueFromValue(engine, cppResult);
+            
+    } else
+
+
+        
+    
+    if( context->argumentCount() ==
+    3 && (
+            context->argument(0).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(1).isNumber()
+        ) /* type: double */
+     && (
+            context->argument(2).isNumber()
+        ) /* type: double */
+    
+    ){
+    // prepare arguments:
+    
+                    // argument isStandardType
+                    double
+                    a0 =
+                    (double)
+                    
+                    context->argument( 0 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a1 =
+                    (double)
+                    
+                    context->argument( 1 ).
+                    toNumber();
+                
+                    // argument isStandardType
+                    double
+                    a2 =
+                    (double)
+                    
+                    context->argument( 2 ).
+                    toNumber();
+                
+    // end of arguments
+
+    // call C++ function:
+    // return type 'QPair < int , int >'
+    QPair < int , int > cppResult =
+        
+               self->queryNearestNeighbor(a0
+        ,
+    a1
+        ,
+    a2);
+        // return type: QPair < int , int >
+                // Pair of ...:
+                //result = REcmaHelper::pairToScriptValue(engine, cppResult);
+                QVariantList vl;
+                QVariant v;
+                
+                     v.setValue(cppResult.first);
+                  
+
+                vl.append(v);
+                v.setValue(cppResult.second);
+                vl.append(v);
+                result = qScriptValueFromValue(engine, vl);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RSpatialIndexFlat.queryNearestNeighbor().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaSpatialIndexFlat::queryNearestNeighbor", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaSpatialIndexFlat::getSize
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaSpatialIndexFlat::getSize", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaSpatialIndexFlat::getSize";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RSpatialIndexFlat* self = 
+                        getSelf("getSize", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'int'
+    int cppResult =
+        
+               self->getSize();
+        // return type: int
+                // standard Type
+                result = QScriptValue(cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RSpatialIndexFlat.getSize().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaSpatialIndexFlat::getSize", context, engine);
+            return result;
+        }
+         QScriptValue
+        REcmaSpatialIndexFlat::getHeight
+        (QScriptContext* context, QScriptEngine* engine) 
+        
+        {
+            //REcmaHelper::functionStart("REcmaSpatialIndexFlat::getHeight", context, engine);
+            //qDebug() << "ECMAScript WRAPPER: REcmaSpatialIndexFlat::getHeight";
+            //QCoreApplication::processEvents();
+
+            QScriptValue result = engine->undefinedValue();
+            
+                    // public function: can be called from ECMA wrapper of ECMA shell:
+                    RSpatialIndexFlat* self = 
+                        getSelf("getHeight", context);
+                  
+
+                //Q_ASSERT(self!=NULL);
+                if (self==NULL) {
+                    return REcmaHelper::throwError("self is NULL", context);
+                }
+                
+    
+    if( context->argumentCount() ==
+    0
+    ){
+    // prepare arguments:
+    
+    // end of arguments
+
+    // call C++ function:
+    // return type 'int'
+    int cppResult =
+        
+               self->getHeight();
+        // return type: int
+                // standard Type
+                result = QScriptValue(cppResult);
+            
+    } else
+
+
+        
+            {
+               return REcmaHelper::throwError("Wrong number/types of arguments for RSpatialIndexFlat.getHeight().",
+                   context);
+            }
+            //REcmaHelper::functionEnd("REcmaSpatialIndexFlat::getHeight", context, engine);
+            return result;
+        }
+         QScriptValue REcmaSpatialIndexFlat::toString
+    (QScriptContext *context, QScriptEngine *engine)
+    
+    {
+
+    RSpatialIndexFlat* self = getSelf("toString", context);
+    
+    QString result;
+    
+            result = QString("RSpatialIndexFlat(0x%1)").arg((unsigned long int)self, 0, 16);
+        
+    return QScriptValue(result);
+    }
+     QScriptValue REcmaSpatialIndexFlat::destroy(QScriptContext *context, QScriptEngine *engine)
+    
+    {
+
+        RSpatialIndexFlat* self = getSelf("RSpatialIndexFlat", context);
+        //Q_ASSERT(self!=NULL);
+        if (self==NULL) {
+            return REcmaHelper::throwError("self is NULL", context);
+        }
+        
+    
+        delete self;
+        context->thisObject().setData(engine->nullValue());
+        context->thisObject().prototype().setData(engine->nullValue());
+        context->thisObject().setPrototype(engine->nullValue());
+        context->thisObject().setScriptClass(NULL);
+        return engine->undefinedValue();
+    }
+    RSpatialIndexFlat* REcmaSpatialIndexFlat::getSelf(const QString& fName, QScriptContext* context)
+    
+        {
+            RSpatialIndexFlat* self = NULL;
+
+            
+                // self could be a normal object (e.g. from an UI file) or
+                // an ECMA shell object (made from an ECMA script):
+                //self = getSelfShell(fName, context);
+                
+
+            //if (self==NULL) {
+                self = REcmaHelper::scriptValueTo<RSpatialIndexFlat >(context->thisObject())
+                
+                ;
+            //}
+
+            if (self == NULL){
+                // avoid recursion (toString is used by the backtrace):
+                if (fName!="toString") {
+                    REcmaHelper::throwError(QString("RSpatialIndexFlat.%1(): "
+                        "This object is not a RSpatialIndexFlat").arg(fName),
+                        context);
+                }
+                return NULL;
+            }
+
+            return self;
+        }
+        RSpatialIndexFlat* REcmaSpatialIndexFlat::getSelfShell(const QString& fName, QScriptContext* context)
+    
+        {
+          RSpatialIndexFlat* selfBase = getSelf(fName, context);
+                RSpatialIndexFlat* self = dynamic_cast<RSpatialIndexFlat*>(selfBase);
+                //return REcmaHelper::scriptValueTo<RSpatialIndexFlat >(context->thisObject());
+            if(self == NULL){
+                REcmaHelper::throwError(QString("RSpatialIndexFlat.%1(): "
+                    "This object is not a RSpatialIndexFlat").arg(fName),
+                    context);
+            }
+
+            return self;
+            
+
+
+        }
+        
\ No newline at end of file
@@ -122,6 +122,7 @@ HEADERS += \
     $$PWD/REcmaMathLineEdit.h \
     $$PWD/REcmaMatrix.h \
     $$PWD/REcmaMdiChildQt.h \
+    $$PWD/REcmaMemoryPool.h \
     $$PWD/REcmaMemoryStorage.h \
     $$PWD/REcmaMessageHandler.h \
     $$PWD/REcmaMixedOperation.h \
@@ -262,6 +263,7 @@ HEADERS += \
     $$PWD/REcmaSolidData.h \
     $$PWD/REcmaSolidEntity.h \
     $$PWD/REcmaSpatialIndex.h \
+    $$PWD/REcmaSpatialIndexFlat.h \
     $$PWD/REcmaSpatialIndexNavel.h \
     $$PWD/REcmaSpatialIndexSimple.h \
     $$PWD/REcmaSpatialIndexVisitor.h \
@@ -423,6 +425,7 @@ SOURCES += \
     $$PWD/REcmaMathLineEdit.cpp \
     $$PWD/REcmaMatrix.cpp \
     $$PWD/REcmaMdiChildQt.cpp \
+    $$PWD/REcmaMemoryPool.cpp \
     $$PWD/REcmaMemoryStorage.cpp \
     $$PWD/REcmaMessageHandler.cpp \
     $$PWD/REcmaMixedOperation.cpp \
@@ -563,6 +566,7 @@ SOURCES += \
     $$PWD/REcmaSolidData.cpp \
     $$PWD/REcmaSolidEntity.cpp \
     $$PWD/REcmaSpatialIndex.cpp \
+    $$PWD/REcmaSpatialIndexFlat.cpp \
     $$PWD/REcmaSpatialIndexNavel.cpp \
     $$PWD/REcmaSpatialIndexSimple.cpp \
     $$PWD/REcmaSpatialIndexVisitor.cpp \
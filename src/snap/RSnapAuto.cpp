@@ -64,7 +64,7 @@ RVector RSnapAuto::snap(const RVector& position, RGraphicsView& view, double ran
     }
 
     // matching ids per query range:
-    QList<QSet<REntity::Id> > idsList;
+    QList<QVector<REntity::Id> > idsList;
     QList<RBox> queryBoxList;
     bool foundEntities = false;
 
@@ -72,10 +72,11 @@ RVector RSnapAuto::snap(const RVector& position, RGraphicsView& view, double ran
         RBox queryBox(position, r);
         queryBoxList.append(queryBox);
 
-        QMap<REntity::Id, QSet<int> > ids = document->queryIntersectedShapesXY(
-                queryBox, true, true, RBlock::INVALID_ID,
+        QVector<REntity::Id> ids;
+        document->queryIntersectedEntitiesXY(
+                ids, queryBox, true, true, RBlock::INVALID_ID,
                     QList<RS::EntityType>() << RS::EntityHatch);
-        idsList.append(ids.keys().toSet());
+        idsList.append(ids);
 
         if (ids.isEmpty()) {
             continue;
@@ -101,7 +102,7 @@ RVector RSnapAuto::snap(const RVector& position, RGraphicsView& view, double ran
         for (int k=0; k<idsList.size() && k<queryBoxList.size(); k++) {
             // query box and matching IDs cached from intersection snap:
             RBox queryBox = queryBoxList.at(k);
-            QSet<REntity::Id> ids = idsList.at(k);
+            const QVector<REntity::Id>& ids = idsList.at(k);
 
             RSnapEnd snapEnd;
             lastSnap = snapEnd.snap(position, view, ids, queryBox);
@@ -119,7 +120,7 @@ RVector RSnapAuto::snap(const RVector& position, RGraphicsView& view, double ran
         for (int k=0; k<idsList.size() && k<queryBoxList.size(); k++) {
             // query box and matching IDs cached from intersection snap:
             RBox queryBox = queryBoxList.at(k);
-            QSet<REntity::Id> ids = idsList.at(k);
+            const QVector<REntity::Id>& ids = idsList.at(k);
 
             RSnapMiddle snapMiddle;
             lastSnap = snapMiddle.snap(position, view, ids, queryBox);
@@ -137,7 +138,7 @@ RVector RSnapAuto::snap(const RVector& position, RGraphicsView& view, double ran
         for (int k=0; k<idsList.size() && k<queryBoxList.size(); k++) {
             // query box and matching IDs cached from intersection snap:
             RBox queryBox = queryBoxList.at(k);
-            QSet<REntity::Id> ids = idsList.at(k);
+            const QVector<REntity::Id>& ids = idsList.at(k);
 
             RSnapCenter snapCenter;
             lastSnap = snapCenter.snap(position, view, ids, queryBox);
@@ -155,7 +156,7 @@ RVector RSnapAuto::snap(const RVector& position, RGraphicsView& view, double ran
         for (int k=0; k<idsList.size() && k<queryBoxList.size(); k++) {
             // query box and matching IDs cached from intersection snap:
             RBox queryBox = queryBoxList.at(k);
-            QSet<REntity::Id> ids = idsList.at(k);
+            const QVector<REntity::Id>& ids = idsList.at(k);
 
             RSnapPerpendicular snapPerpendicular;
             lastSnap = snapPerpendicular.snap(position, view, ids, queryBox);
@@ -173,7 +174,7 @@ RVector RSnapAuto::snap(const RVector& position, RGraphicsView& view, double ran
         for (int k=0; k<idsList.size() && k<queryBoxList.size(); k++) {
             // query box and matching IDs cached from intersection snap:
             RBox queryBox = queryBoxList.at(k);
-            QSet<REntity::Id> ids = idsList.at(k);
+            const QVector<REntity::Id>& ids = idsList.at(k);
 
             RSnapReference snapReference;
             lastSnap = snapReference.snap(position, view, ids, queryBox);
@@ -202,7 +203,7 @@ RVector RSnapAuto::snap(const RVector& position, RGraphicsView& view, double ran
         for (int k=0; k<idsList.size() && k<queryBoxList.size(); k++) {
             // query box and matching IDs cached from intersection snap:
             RBox queryBox = queryBoxList.at(k);
-            QSet<REntity::Id> ids = idsList.at(k);
+            const QVector<REntity::Id>& ids = idsList.at(k);
 
             // on entity
             RSnapOnEntity snapOnEntity;
@@ -48,13 +48,13 @@ RVector RSnapEntityBase::snap(
 
     RBox queryBox(position, range);
 
-    QSet<REntity::Id> ids =
-            document->queryIntersectedEntitiesXY(
-                queryBox, true, true, RBlock::INVALID_ID
-                // 20130527: don't ignore hatches to snap to reference
-                // points of hatches:
-                //QList<RS::EntityType>() << RS::EntityHatch
-                );
+    QVector<REntity::Id> ids;
+    document->queryIntersectedEntitiesXY(
+        ids, queryBox, true, true, RBlock::INVALID_ID
+        // 20130527: don't ignore hatches to snap to reference
+        // points of hatches:
+        //QList<RS::EntityType>() << RS::EntityHatch
+        );
 
     return snap(position, view, ids, queryBox);
 }
@@ -65,6 +65,15 @@ RVector RSnapEntityBase::snap(
         const QSet<REntity::Id>& candidates,
         const RBox& queryBox) {
 
+    return snap(position, view, candidates.toList().toVector(), queryBox);
+}
+
+RVector RSnapEntityBase::snap(
+        const RVector& position,
+        RGraphicsView& view,
+        const QVector<REntity::Id>& candidates,
+        const RBox& queryBox) {
+
     RDocument* document = view.getDocument();
     if (document==NULL) {
         return lastSnap;
@@ -75,11 +84,10 @@ RVector RSnapEntityBase::snap(
     double dist;
 
     //RDebug::startTimer(3);
-    QSet<REntity::Id>::const_iterator it;
-    for (it=candidates.begin(); it!=candidates.end(); it++) {
+    for (int i=0; i<candidates.size(); i++) {
         // 20111112: query direct:
-        //QSharedPointer<REntity> e = document->queryEntityDirect(*it);
-        QSharedPointer<REntity> e = document->queryEntity(*it);
+        //QSharedPointer<REntity> e = document->queryEntityDirect(candidates[i]);
+        QSharedPointer<REntity> e = document->queryEntity(candidates[i]);
         if (e.isNull()) {
             continue;
         }
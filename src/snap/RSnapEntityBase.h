@@ -22,6 +22,8 @@
 
 #include "snap_global.h"
 
+#include <QVector>
+
 #include "RSnap.h"
 #include "RGraphicsView.h"
 
@@ -49,6 +51,15 @@ public:
             const QSet<REntity::Id>& candidates,
             const RBox& queryBox);
 
+    /**
+     * \nonscriptable
+     */
+    virtual RVector snap(
+            const RVector& position,
+            RGraphicsView& view,
+            const QVector<REntity::Id>& candidates,
+            const RBox& queryBox);
+
 protected:
     virtual QList<RVector> snapEntity(
             QSharedPointer<REntity> entity,
@@ -45,10 +45,10 @@ RVector RSnapIntersection::snap(
 
     RBox queryBox(position, range);
 
-    QMap<REntity::Id, QSet<int> > ids =
-        document->queryIntersectedShapesXY(
-            queryBox, true /*false?*/, true, RBlock::INVALID_ID,
-                QList<RS::EntityType>() << RS::EntityHatch);
+    QVector<REntity::Id> ids;
+    document->queryIntersectedEntitiesXY(
+        ids, queryBox, true /*false?*/, true, RBlock::INVALID_ID,
+            QList<RS::EntityType>() << RS::EntityHatch);
     
     return snap(position, view, ids, queryBox);
 }
@@ -59,6 +59,15 @@ RVector RSnapIntersection::snap(
         const QMap<REntity::Id, QSet<int> >& candidates,
         const RBox& queryBox) {
 
+    return snap(position, view, candidates.keys().toVector(), queryBox);
+}
+
+RVector RSnapIntersection::snap(
+        const RVector& position,
+        RGraphicsView& view,
+        const QVector<REntity::Id>& candidates,
+        const RBox& queryBox) {
+
     RDocument* document = view.getDocument();
     if (document==NULL) {
         return lastSnap;
@@ -70,9 +79,8 @@ RVector RSnapIntersection::snap(
     double minDist = RMAXDOUBLE;
     double dist;
 
-    QMap<REntity::Id, QSet<int> >::const_iterator it1;
-    for (it1=candidates.begin(); it1!=candidates.end(); it1++) {
-        QSharedPointer<REntity> e1 = document->queryEntity(it1.key());
+    for (int i1=0; i1<candidates.size(); i1++) {
+        QSharedPointer<const REntity> e1 = document->queryEntityConst(candidates[i1]);
         if (e1.isNull()) {
             continue;
         }
@@ -83,9 +91,8 @@ RVector RSnapIntersection::snap(
             continue;
         }
 
-        QMap<REntity::Id, QSet<int> >::const_iterator it2;
-        for (it2=it1; it2!=candidates.end(); it2++) {
-            QSharedPointer<REntity> e2 = document->queryEntity(it2.key());
+        for (int i2=i1; i2<candidates.size(); i2++) {
+            QSharedPointer<const REntity> e2 = document->queryEntityConst(candidates[i2]);
             if (e2.isNull()) {
                 continue;
             }
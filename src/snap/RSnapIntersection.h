@@ -22,6 +22,8 @@
 
 #include "snap_global.h"
 
+#include <QVector>
+
 #include "RSnap.h"
 #include "REntity.h"
 
@@ -50,6 +52,15 @@ public:
             RGraphicsView& view,
             const QMap<REntity::Id, QSet<int> >& candidates,
             const RBox& queryBox);
+
+    /**
+     * \nonscriptable
+     */
+    virtual RVector snap(
+            const RVector& position,
+            RGraphicsView& view,
+            const QVector<REntity::Id>& candidates,
+            const RBox& queryBox);
 };
 
 Q_DECLARE_METATYPE(RSnapIntersection*)
@@ -0,0 +1,976 @@
+/**
+ * Copyright (c) 2011-2013 by Andrew Mustun. All rights reserved.
+ * 
+ * This file is part of the QCAD project.
+ *
+ * QCAD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QCAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QCAD.
+ */
+#include <cmath>
+#include <queue>
+#include <vector>
+
+#include <QDataStream>
+#include <QIODevice>
+#include <QtAlgorithms>
+#include <QVarLengthArray>
+
+#include "RSpatialIndexFlat.h"
+#include "RDebug.h"
+#include "RMath.h"
+
+namespace {
+
+/**
+ * Internal.
+ * Node entry with its distance to the query point of a nearest neighbor
+ * query, ordered by ascending distance in the priority queue. The
+ * distance is exact if \c exact is true and the distance of the
+ * bounding box of the entry otherwise.
+ */
+struct RSiCandidate {
+    RSiCandidate(double dist, int node, int slot, bool exact = false) :
+        dist(dist), node(node), slot(slot), exact(exact) {}
+
+    bool operator<(const RSiCandidate& other) const {
+        return dist > other.dist;
+    }
+
+    double dist;
+    int node;
+    int slot;
+    bool exact;
+};
+
+inline double minDist2(double x, double y, double x1, double y1, double x2, double y2) {
+    double dx = x<x1 ? x1-x : (x>x2 ? x-x2 : 0.0);
+    double dy = y<y1 ? y1-y : (y>y2 ? y-y2 : 0.0);
+    return dx*dx + dy*dy;
+}
+
+}
+
+
+
+RSpatialIndexFlat::RSpatialIndexFlat() :
+    root(-1) {
+
+    clear();
+}
+
+RSpatialIndexFlat::~RSpatialIndexFlat() {
+}
+
+RSpatialIndex* RSpatialIndexFlat::create() {
+    return new RSpatialIndexFlat();
+}
+
+void RSpatialIndexFlat::clear() {
+    nodes.clear();
+    items.clear();
+    freeNodes.clear();
+    freeItems.clear();
+    itemMap.clear();
+    root = newNode(0, -1);
+}
+
+/**
+ * \return Number of entries in the index.
+ */
+int RSpatialIndexFlat::getSize() const {
+    return itemMap.size();
+}
+
+/**
+ * \return Height of the tree (1 for a tree that consists of the root only).
+ */
+int RSpatialIndexFlat::getHeight() const {
+    return nodes[root].level + 1;
+}
+
+void RSpatialIndexFlat::addToIndex(
+    int id, int pos,
+    double x1, double y1, double z1,
+    double x2, double y2, double z2) {
+
+    qint64 siid = RSpatialIndex::getSIId(id, pos);
+
+    // an entry with the same ID and position is replaced:
+    QHash<qint64, int>::const_iterator it = itemMap.constFind(siid);
+    if (it!=itemMap.constEnd()) {
+        removeItem(it.value());
+    }
+
+    int i = newItem();
+    Item& item = items[i];
+    item.id = id;
+    item.pos = pos;
+    item.z1 = qMin(z1, z2);
+    item.z2 = qMax(z1, z2);
+
+    Entry e = { qMin(x1, x2), qMin(y1, y2), qMax(x1, x2), qMax(y1, y2), i };
+    insertEntry(chooseLeaf(e), e);
+
+    itemMap.insert(siid, i);
+}
+
+void RSpatialIndexFlat::addToIndex(int id, int pos, const RBox& bb) {
+    RSpatialIndex::addToIndex(id, pos, bb);
+}
+
+/**
+ * Replaces the contents of this index with the given entries, packed
+ * with sort-tile-recursive (STR) bulk loading.
+ */
+void RSpatialIndexFlat::bulkLoad(const QList<int>& ids, const QList<QList<RBox> >& bbs) {
+    clear();
+
+    QVector<Entry> entries;
+    for (int k = 0; k < ids.size() && k < bbs.size(); ++k) {
+        const QList<RBox>& boxes = bbs[k];
+        for (int pos = 0; pos < boxes.size(); ++pos) {
+            const RBox& bb = boxes[pos];
+            int i = newItem();
+            Item& item = items[i];
+            item.id = ids[k];
+            item.pos = pos;
+            item.z1 = qMin(bb.c1.z, bb.c2.z);
+            item.z2 = qMax(bb.c1.z, bb.c2.z);
+            itemMap.insert(RSpatialIndex::getSIId(ids[k], pos), i);
+
+            Entry e = {
+                qMin(bb.c1.x, bb.c2.x), qMin(bb.c1.y, bb.c2.y),
+                qMax(bb.c1.x, bb.c2.x), qMax(bb.c1.y, bb.c2.y),
+                i
+            };
+            entries.append(e);
+        }
+    }
+
+    if (entries.isEmpty()) {
+        return;
+    }
+
+    // leave room for later inserts:
+    const int fill = capacity * 3 / 4;
+    int emptyRoot = root;
+
+    for (int level = 0; ; ++level) {
+        int count = entries.size();
+        int numNodes = (count + fill - 1) / fill;
+        int numSlabs = (int)ceil(sqrt((double)numNodes));
+        int slabSize = numSlabs * fill;
+
+        qSort(entries.begin(), entries.end(), lessX);
+
+        QVector<Entry> parents;
+        parents.reserve(numNodes);
+        for (int s = 0; s < count; s += slabSize) {
+            int slabEnd = qMin(s + slabSize, count);
+            qSort(entries.begin() + s, entries.begin() + slabEnd, lessY);
+
+            for (int c = s; c < slabEnd; c += fill) {
+                int n = newNode(level, -1);
+                int chunkEnd = qMin(c + fill, slabEnd);
+                for (int k = c; k < chunkEnd; ++k) {
+                    setChild(n, k - c, entries[k]);
+                }
+                nodes[n].count = chunkEnd - c;
+                parents.append(getBounds(n));
+            }
+        }
+
+        if (parents.size()==1) {
+            root = parents[0].ref;
+            break;
+        }
+        entries = parents;
+    }
+
+    freeNode(emptyRoot);
+}
+
+bool RSpatialIndexFlat::removeFromIndex(int id, const QList<RBox>& bb) {
+    bool ok = true;
+    for (int pos = 0; pos < bb.size(); ++pos) {
+        ok = removeFromIndex(id, pos, bb[pos]) && ok;
+    }
+    return ok;
+}
+
+bool RSpatialIndexFlat::removeFromIndex(int id, int pos, const RBox& bb) {
+    return RSpatialIndex::removeFromIndex(id, pos, bb);
+}
+
+/**
+ * Removes the entry with the given ID and position. The entry is looked
+ * up by ID and position, the box is only used for reporting.
+ */
+bool RSpatialIndexFlat::removeFromIndex(
+        int id, int pos,
+        double x1, double y1, double z1,
+        double x2, double y2, double z2) {
+
+    QHash<qint64, int>::const_iterator it = itemMap.constFind(RSpatialIndex::getSIId(id, pos));
+    if (it==itemMap.constEnd()) {
+        qWarning() << QString(
+                          "RSpatialIndexFlat::removeFromIndex: "
+                          "entry not found, id: %1, pos: %2, %3,%4,%5 / %6,%7,%8")
+                      .arg(id).arg(pos)
+                      .arg(x1) .arg(y1) .arg(z1)
+                      .arg(x2) .arg(y2) .arg(z2);
+        return false;
+    }
+
+    removeItem(it.value());
+    return true;
+}
+
+QMap<int, QSet<int> > RSpatialIndexFlat::queryIntersected(
+    double x1, double y1, double z1,
+    double x2, double y2, double z2,
+    RSpatialIndexVisitor* dataVisitor) {
+
+    QMap<int, QSet<int> > result;
+    query(false, x1, y1, z1, x2, y2, z2, &result, NULL, dataVisitor);
+    return result;
+}
+
+QMap<int, QSet<int> > RSpatialIndexFlat::queryContained(
+    double x1, double y1, double z1,
+    double x2, double y2, double z2,
+    RSpatialIndexVisitor* dataVisitor) {
+
+    QMap<int, QSet<int> > result;
+    query(true, x1, y1, z1, x2, y2, z2, &result, NULL, dataVisitor);
+    return result;
+}
+
+void RSpatialIndexFlat::queryIntersected(
+    double x1, double y1, double z1,
+    double x2, double y2, double z2,
+    QVector<QPair<int, int> >& result) {
+
+    query(false, x1, y1, z1, x2, y2, z2, NULL, &result, NULL);
+}
+
+void RSpatialIndexFlat::queryContained(
+    double x1, double y1, double z1,
+    double x2, double y2, double z2,
+    QVector<QPair<int, int> >& result) {
+
+    query(true, x1, y1, z1, x2, y2, z2, NULL, &result, NULL);
+}
+
+/**
+ * Best-first search for the k entries closest (in XY) to the given point.
+ */
+QMap<int, QSet<int> > RSpatialIndexFlat::queryNearestNeighbor(
+    unsigned int k,
+    double x, double y, double z,
+    RSpatialIndexVisitor* dataVisitor) {
+
+    Q_UNUSED(z)
+
+    QMap<int, QSet<int> > result;
+    if (k==0) {
+        return result;
+    }
+
+    nearestNeighbor(k, x, y, result, dataVisitor);
+    return result;
+}
+
+QPair<int, int> RSpatialIndexFlat::queryNearestNeighbor(double x, double y, double z) {
+    return RSpatialIndex::queryNearestNeighbor(x, y, z);
+}
+
+/**
+ * Best-first search for the closest item in XY with exact distances.
+ */
+QPair<int, int> RSpatialIndexFlat::queryNearestNeighborXY(
+    double x, double y, double maxDistance,
+    RSpatialIndexDistanceFunction& distanceFunction) {
+
+    return nearestNeighborXY(x, y, maxDistance, distanceFunction);
+}
+
+/**
+ * Writes the tree as it is (nodes, items and free lists), so that
+ * \ref load does not have to rebuild it.
+ */
+bool RSpatialIndexFlat::save(QDataStream& stream) {
+    stream << (qint32)nodes.size() << (qint32)items.size() << (qint32)root;
+
+    for (int n=0; n<nodes.size(); n++) {
+        const Node& node = nodes[n];
+        stream << (qint32)node.count << (qint32)node.level << (qint32)node.parent;
+        for (int k=0; k<node.count; k++) {
+            stream << node.x1[k] << node.y1[k] << node.x2[k] << node.y2[k]
+                   << (qint32)node.child[k];
+        }
+    }
+
+    for (int i=0; i<items.size(); i++) {
+        const Item& item = items[i];
+        stream << (qint32)item.id << (qint32)item.pos
+               << item.z1 << item.z2 << (qint32)item.leaf;
+    }
+
+    stream << freeNodes << freeItems;
+
+    return stream.status()==QDataStream::Ok;
+}
+
+/**
+ * Reads a tree written by \ref save. All counts and node / item
+ * references are checked, so that a corrupt or truncated cache file
+ * is rejected instead of producing a broken tree.
+ *
+ * \return False if the data is not a valid tree. The index is empty
+ * in that case.
+ */
+bool RSpatialIndexFlat::load(QDataStream& stream) {
+    clear();
+
+    qint32 nodeCount, itemCount, treeRoot;
+    stream >> nodeCount >> itemCount >> treeRoot;
+    if (stream.status()!=QDataStream::Ok ||
+        nodeCount<1 || itemCount<0 || treeRoot<0 || treeRoot>=nodeCount) {
+        clear();
+        return false;
+    }
+
+    // every node needs at least 12 bytes and every item 28 bytes,
+    // reject counts the remaining data cannot hold:
+    QIODevice* device = stream.device();
+    if (device!=NULL && !device->isSequential() &&
+        (qint64)nodeCount*12 + (qint64)itemCount*28 > device->bytesAvailable()) {
+        clear();
+        return false;
+    }
+
+    nodes.clear();
+    nodes.resize(nodeCount);
+    for (int n=0; n<nodeCount; n++) {
+        Node& node = nodes[n];
+        qint32 count, level, parent;
+        stream >> count >> level >> parent;
+        if (stream.status()!=QDataStream::Ok ||
+            count<0 || count>capacity || level<0 ||
+            parent<-1 || parent>=nodeCount) {
+            clear();
+            return false;
+        }
+        node.count = count;
+        node.level = level;
+        node.parent = parent;
+        for (int k=0; k<count; k++) {
+            qint32 child;
+            stream >> node.x1[k] >> node.y1[k] >> node.x2[k] >> node.y2[k] >> child;
+            if (child<0 || child>=(level==0 ? itemCount : nodeCount)) {
+                clear();
+                return false;
+            }
+            node.child[k] = child;
+        }
+    }
+
+    items.resize(itemCount);
+    for (int i=0; i<itemCount; i++) {
+        Item& item = items[i];
+        qint32 id, pos, leaf;
+        stream >> id >> pos >> item.z1 >> item.z2 >> leaf;
+        if (stream.status()!=QDataStream::Ok ||
+            leaf<-1 || leaf>=nodeCount || (leaf!=-1 && nodes[leaf].level!=0)) {
+            clear();
+            return false;
+        }
+        item.id = id;
+        item.pos = pos;
+        item.leaf = leaf;
+        if (leaf!=-1) {
+            itemMap.insert(RSpatialIndex::getSIId(id, pos), i);
+        }
+    }
+
+    stream >> freeNodes >> freeItems;
+    if (stream.status()!=QDataStream::Ok) {
+        clear();
+        return false;
+    }
+
+    // child nodes must be one level below their parent and items
+    // must be in the leaf that refers to them:
+    for (int n=0; n<nodeCount; n++) {
+        const Node& node = nodes[n];
+        for (int k=0; k<node.count; k++) {
+            int c = node.child[k];
+            if ((node.level==0 && items[c].leaf!=n) ||
+                (node.level>0 && (nodes[c].level!=node.level-1 || nodes[c].parent!=n))) {
+                clear();
+                return false;
+            }
+        }
+    }
+
+    for (int i=0; i<freeNodes.size(); i++) {
+        if (freeNodes[i]<0 || freeNodes[i]>=nodeCount || freeNodes[i]==treeRoot) {
+            clear();
+            return false;
+        }
+    }
+    for (int i=0; i<freeItems.size(); i++) {
+        if (freeItems[i]<0 || freeItems[i]>=itemCount || items[freeItems[i]].leaf!=-1) {
+            clear();
+            return false;
+        }
+    }
+
+    root = treeRoot;
+    return true;
+}
+
+int RSpatialIndexFlat::newNode(int level, int parent) {
+    int n;
+    if (!freeNodes.isEmpty()) {
+        n = freeNodes.last();
+        freeNodes.resize(freeNodes.size()-1);
+    }
+    else {
+        n = nodes.size();
+        nodes.resize(n+1);
+    }
+
+    Node& node = nodes[n];
+    node.count = 0;
+    node.level = level;
+    node.parent = parent;
+    return n;
+}
+
+void RSpatialIndexFlat::freeNode(int n) {
+    nodes[n].count = 0;
+    nodes[n].parent = -1;
+    freeNodes.append(n);
+}
+
+int RSpatialIndexFlat::newItem() {
+    if (!freeItems.isEmpty()) {
+        int i = freeItems.last();
+        freeItems.resize(freeItems.size()-1);
+        return i;
+    }
+
+    items.resize(items.size()+1);
+    return items.size()-1;
+}
+
+void RSpatialIndexFlat::freeItem(int i) {
+    items[i].leaf = -1;
+    freeItems.append(i);
+}
+
+/**
+ * \return Leaf that needs the least enlargement to include the given entry.
+ */
+int RSpatialIndexFlat::chooseLeaf(const Entry& e) const {
+    int n = root;
+    while (nodes[n].level > 0) {
+        const Node& node = nodes[n];
+        int best = 0;
+        double bestEnlargement = 0.0;
+        double bestArea = 0.0;
+        for (int k = 0; k < node.count; ++k) {
+            double area = (node.x2[k]-node.x1[k]) * (node.y2[k]-node.y1[k]);
+            double enlarged =
+                (qMax(node.x2[k], e.x2) - qMin(node.x1[k], e.x1)) *
+                (qMax(node.y2[k], e.y2) - qMin(node.y1[k], e.y1));
+            double enlargement = enlarged - area;
+            if (k==0 || enlargement < bestEnlargement ||
+                (enlargement==bestEnlargement && area < bestArea)) {
+                best = k;
+                bestEnlargement = enlargement;
+                bestArea = area;
+            }
+        }
+        n = node.child[best];
+    }
+    return n;
+}
+
+/**
+ * \return Slot of the given child in node n or -1.
+ */
+int RSpatialIndexFlat::findSlot(int n, int child) const {
+    const Node& node = nodes[n];
+    for (int k = 0; k < node.count; ++k) {
+        if (node.child[k]==child) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Sets the entry at the given slot of node n and the back reference of
+ * the referenced item or child node.
+ */
+void RSpatialIndexFlat::setChild(int n, int slot, const Entry& e) {
+    Node& node = nodes[n];
+    node.x1[slot] = e.x1;
+    node.y1[slot] = e.y1;
+    node.x2[slot] = e.x2;
+    node.y2[slot] = e.y2;
+    node.child[slot] = e.ref;
+    if (node.level==0) {
+        items[e.ref].leaf = n;
+    }
+    else {
+        nodes[e.ref].parent = n;
+    }
+}
+
+void RSpatialIndexFlat::insertEntry(int n, const Entry& e) {
+    if (nodes[n].count < capacity) {
+        setChild(n, nodes[n].count, e);
+        nodes[n].count++;
+        growParents(n, e);
+    }
+    else {
+        splitNode(n, e);
+    }
+}
+
+/**
+ * Splits the full node n into two nodes to insert the given entry
+ * (quadratic split).
+ */
+void RSpatialIndexFlat::splitNode(int n, const Entry& e) {
+    const int total = capacity + 1;
+    const int minFill = capacity / 3;
+
+    Entry all[total];
+    {
+        const Node& node = nodes[n];
+        for (int k = 0; k < capacity; ++k) {
+            Entry ek = { node.x1[k], node.y1[k], node.x2[k], node.y2[k], node.child[k] };
+            all[k] = ek;
+        }
+        all[capacity] = e;
+    }
+
+    // pick the two seeds that waste the most area together:
+    int seedA = 0;
+    int seedB = 1;
+    double maxWaste = -RMAXDOUBLE;
+    for (int i = 0; i < total; ++i) {
+        double areaI = (all[i].x2-all[i].x1) * (all[i].y2-all[i].y1);
+        for (int j = i+1; j < total; ++j) {
+            double areaJ = (all[j].x2-all[j].x1) * (all[j].y2-all[j].y1);
+            double waste =
+                (qMax(all[i].x2, all[j].x2) - qMin(all[i].x1, all[j].x1)) *
+                (qMax(all[i].y2, all[j].y2) - qMin(all[i].y1, all[j].y1)) -
+                areaI - areaJ;
+            if (waste > maxWaste) {
+                maxWaste = waste;
+                seedA = i;
+                seedB = j;
+            }
+        }
+    }
+
+    Entry boundsA = all[seedA];
+    Entry boundsB = all[seedB];
+    int group[total];
+    int countA = 1;
+    int countB = 1;
+    for (int i = 0; i < total; ++i) {
+        group[i] = -1;
+    }
+    group[seedA] = 0;
+    group[seedB] = 1;
+
+    for (int i = 0; i < total; ++i) {
+        if (group[i]!=-1) {
+            continue;
+        }
+        int remaining = total - countA - countB;
+        if (countA + remaining <= minFill) {
+            group[i] = 0;
+        }
+        else if (countB + remaining <= minFill) {
+            group[i] = 1;
+        }
+        else {
+            double areaA = (boundsA.x2-boundsA.x1) * (boundsA.y2-boundsA.y1);
+            double areaB = (boundsB.x2-boundsB.x1) * (boundsB.y2-boundsB.y1);
+            double enlA =
+                (qMax(boundsA.x2, all[i].x2) - qMin(boundsA.x1, all[i].x1)) *
+                (qMax(boundsA.y2, all[i].y2) - qMin(boundsA.y1, all[i].y1)) - areaA;
+            double enlB =
+                (qMax(boundsB.x2, all[i].x2) - qMin(boundsB.x1, all[i].x1)) *
+                (qMax(boundsB.y2, all[i].y2) - qMin(boundsB.y1, all[i].y1)) - areaB;
+            if (enlA < enlB || (enlA==enlB && (areaA < areaB || (areaA==areaB && countA <= countB)))) {
+                group[i] = 0;
+            }
+            else {
+                group[i] = 1;
+            }
+        }
+
+        Entry& b = group[i]==0 ? boundsA : boundsB;
+        b.x1 = qMin(b.x1, all[i].x1);
+        b.y1 = qMin(b.y1, all[i].y1);
+        b.x2 = qMax(b.x2, all[i].x2);
+        b.y2 = qMax(b.y2, all[i].y2);
+        if (group[i]==0) {
+            countA++;
+        }
+        else {
+            countB++;
+        }
+    }
+
+    int level = nodes[n].level;
+    int parent = nodes[n].parent;
+    int nn = newNode(level, parent);
+
+    nodes[n].count = 0;
+    for (int i = 0; i < total; ++i) {
+        int target = group[i]==0 ? n : nn;
+        setChild(target, nodes[target].count, all[i]);
+        nodes[target].count++;
+    }
+
+    if (n==root) {
+        int r = newNode(level+1, -1);
+        setChild(r, 0, getBounds(n));
+        setChild(r, 1, getBounds(nn));
+        nodes[r].count = 2;
+        root = r;
+        return;
+    }
+
+    Entry bn = getBounds(n);
+    int slot = findSlot(parent, n);
+    setChild(parent, slot, bn);
+    growParents(parent, bn);
+    insertEntry(parent, getBounds(nn));
+}
+
+/**
+ * Grows the entries of all ancestors of node n to include the given entry.
+ */
+void RSpatialIndexFlat::growParents(int n, const Entry& e) {
+    int c = n;
+    int p = nodes[c].parent;
+    while (p!=-1) {
+        Node& pn = nodes[p];
+        int s = findSlot(p, c);
+        bool changed = false;
+        if (e.x1 < pn.x1[s]) { pn.x1[s] = e.x1; changed = true; }
+        if (e.y1 < pn.y1[s]) { pn.y1[s] = e.y1; changed = true; }
+        if (e.x2 > pn.x2[s]) { pn.x2[s] = e.x2; changed = true; }
+        if (e.y2 > pn.y2[s]) { pn.y2[s] = e.y2; changed = true; }
+        if (!changed) {
+            // ancestors already cover the entry:
+            break;
+        }
+        c = p;
+        p = pn.parent;
+    }
+}
+
+/**
+ * Shrinks the entries of all ancestors of node n to the exact bounds of
+ * their children.
+ */
+void RSpatialIndexFlat::tightenParents(int n) {
+    int c = n;
+    int p = nodes[c].parent;
+    while (p!=-1) {
+        Entry b = getBounds(c);
+        int s = findSlot(p, c);
+        Node& pn = nodes[p];
+        pn.x1[s] = b.x1;
+        pn.y1[s] = b.y1;
+        pn.x2[s] = b.x2;
+        pn.y2[s] = b.y2;
+        c = p;
+        p = pn.parent;
+    }
+}
+
+/**
+ * \return Bounds of all entries of node n, referencing n.
+ */
+RSpatialIndexFlat::Entry RSpatialIndexFlat::getBounds(int n) const {
+    const Node& node = nodes[n];
+    Entry ret = { RMAXDOUBLE, RMAXDOUBLE, -RMAXDOUBLE, -RMAXDOUBLE, n };
+    for (int k = 0; k < node.count; ++k) {
+        ret.x1 = qMin(ret.x1, node.x1[k]);
+        ret.y1 = qMin(ret.y1, node.y1[k]);
+        ret.x2 = qMax(ret.x2, node.x2[k]);
+        ret.y2 = qMax(ret.y2, node.y2[k]);
+    }
+    return ret;
+}
+
+/**
+ * Removes the given item from its leaf and the item map.
+ */
+void RSpatialIndexFlat::removeItem(int i) {
+    int leaf = items[i].leaf;
+    int slot = findSlot(leaf, i);
+    if (slot==-1) {
+        qWarning() << "RSpatialIndexFlat::removeItem: item not found in leaf: " << i;
+    }
+    else {
+        Node& node = nodes[leaf];
+        int last = node.count-1;
+        node.x1[slot] = node.x1[last];
+        node.y1[slot] = node.y1[last];
+        node.x2[slot] = node.x2[last];
+        node.y2[slot] = node.y2[last];
+        node.child[slot] = node.child[last];
+        node.count--;
+    }
+
+    itemMap.remove(RSpatialIndex::getSIId(items[i].id, items[i].pos));
+    freeItem(i);
+
+    if (slot!=-1) {
+        condense(leaf);
+    }
+}
+
+/**
+ * Removes empty nodes on the path from node n to the root and shrinks
+ * the entries of the remaining ancestors. Underfull nodes are kept.
+ */
+void RSpatialIndexFlat::condense(int n) {
+    while (n!=root && nodes[n].count==0) {
+        int p = nodes[n].parent;
+        int slot = findSlot(p, n);
+        Node& pn = nodes[p];
+        int last = pn.count-1;
+        pn.x1[slot] = pn.x1[last];
+        pn.y1[slot] = pn.y1[last];
+        pn.x2[slot] = pn.x2[last];
+        pn.y2[slot] = pn.y2[last];
+        pn.child[slot] = pn.child[last];
+        pn.count--;
+        freeNode(n);
+        n = p;
+    }
+
+    tightenParents(n);
+
+    // shorten the tree:
+    while (nodes[root].level > 0 && nodes[root].count==1) {
+        int c = nodes[root].child[0];
+        freeNode(root);
+        root = c;
+        nodes[root].parent = -1;
+    }
+    if (nodes[root].count==0) {
+        nodes[root].level = 0;
+    }
+}
+
+/**
+ * Internal. Finds all items that intersect with (or
+ * are contained in if \c contained is true) the given box. Matches are
+ * added to \c result and / or \c resultVector if given.
+ */
+void RSpatialIndexFlat::query(bool contained,
+    double x1, double y1, double z1,
+    double x2, double y2, double z2,
+    QMap<int, QSet<int> >* result,
+    QVector<QPair<int, int> >* resultVector,
+    RSpatialIndexVisitor* dataVisitor) const {
+
+    double qx1 = qMin(x1, x2);
+    double qy1 = qMin(y1, y2);
+    double qz1 = qMin(z1, z2);
+    double qx2 = qMax(x1, x2);
+    double qy2 = qMax(y1, y2);
+    double qz2 = qMax(z1, z2);
+
+    QVarLengthArray<int, 64> stack;
+    stack.append(root);
+    while (!stack.isEmpty()) {
+        int n = stack[stack.size()-1];
+        stack.resize(stack.size()-1);
+        const Node& node = nodes[n];
+        bool leaf = (node.level==0);
+
+        // box tests over the coordinate arrays, without branches:
+        bool hit[capacity];
+        if (leaf && contained) {
+            for (int k = 0; k < node.count; ++k) {
+                hit[k] = (node.x1[k] >= qx1) & (node.x2[k] <= qx2) &
+                         (node.y1[k] >= qy1) & (node.y2[k] <= qy2);
+            }
+        }
+        else {
+            for (int k = 0; k < node.count; ++k) {
+                hit[k] = (node.x1[k] <= qx2) & (node.x2[k] >= qx1) &
+                         (node.y1[k] <= qy2) & (node.y2[k] >= qy1);
+            }
+        }
+
+        for (int k = 0; k < node.count; ++k) {
+            if (!hit[k]) {
+                continue;
+            }
+            if (leaf) {
+                const Item& item = items[node.child[k]];
+                if (contained) {
+                    if (item.z1 < qz1 || item.z2 > qz2) {
+                        continue;
+                    }
+                }
+                else {
+                    if (item.z1 > qz2 || item.z2 < qz1) {
+                        continue;
+                    }
+                }
+                visitItem(node, item, k, result, resultVector, dataVisitor);
+            }
+            else {
+                if (dataVisitor!=NULL) {
+                    dataVisitor->visitNode(node.x1[k], node.y1[k], 0.0,
+                                           node.x2[k], node.y2[k], 0.0);
+                }
+                stack.append(node.child[k]);
+            }
+        }
+    }
+}
+
+/**
+ * Internal. Best-first search for the k closest entries.
+ */
+void RSpatialIndexFlat::nearestNeighbor(
+    unsigned int k,
+    double x, double y,
+    QMap<int, QSet<int> >& result,
+    RSpatialIndexVisitor* dataVisitor) const {
+
+    std::priority_queue<RSiCandidate> queue;
+    const Node& r = nodes[root];
+    for (int s = 0; s < r.count; ++s) {
+        queue.push(RSiCandidate(minDist2(x, y, r.x1[s], r.y1[s], r.x2[s], r.y2[s]), root, s));
+    }
+
+    unsigned int found = 0;
+    while (!queue.empty() && found < k) {
+        RSiCandidate c = queue.top();
+        queue.pop();
+
+        const Node& node = nodes[c.node];
+        if (node.level==0) {
+            visitItem(node, items[node.child[c.slot]], c.slot, &result, NULL, dataVisitor);
+            found++;
+            continue;
+        }
+
+        int n = node.child[c.slot];
+        const Node& child = nodes[n];
+        for (int s = 0; s < child.count; ++s) {
+            queue.push(RSiCandidate(minDist2(x, y, child.x1[s], child.y1[s], child.x2[s], child.y2[s]), n, s));
+        }
+    }
+}
+
+/**
+ * Internal. Best-first search for the closest item. Entries are queued by
+ * the distance of their bounding boxes. Items are queued again with
+ * their exact distance once it is known, so the first item that comes
+ * out of the queue with its exact distance is the closest one. Exact
+ * distances are only computed for items whose box is closer than that.
+ */
+QPair<int, int> RSpatialIndexFlat::nearestNeighborXY(
+    double x, double y, double maxDistance,
+    RSpatialIndexDistanceFunction& distanceFunction) const {
+
+    double maxDist2 = maxDistance*maxDistance;
+
+    std::priority_queue<RSiCandidate> queue;
+    const Node& r = nodes[root];
+    for (int s = 0; s < r.count; ++s) {
+        double d2 = minDist2(x, y, r.x1[s], r.y1[s], r.x2[s], r.y2[s]);
+        if (d2 <= maxDist2) {
+            queue.push(RSiCandidate(sqrt(d2), root, s));
+        }
+    }
+
+    while (!queue.empty()) {
+        RSiCandidate c = queue.top();
+        queue.pop();
+
+        const Node& node = nodes[c.node];
+        if (node.level==0) {
+            const Item& item = items[node.child[c.slot]];
+            if (c.exact) {
+                return qMakePair(item.id, item.pos);
+            }
+
+            double dist = distanceFunction.getDistance(item.id, item.pos);
+            if (!RMath::isNaN(dist) && dist <= maxDistance) {
+                queue.push(RSiCandidate(dist, c.node, c.slot, true));
+            }
+            continue;
+        }
+
+        int n = node.child[c.slot];
+        const Node& child = nodes[n];
+        for (int s = 0; s < child.count; ++s) {
+            double d2 = minDist2(x, y, child.x1[s], child.y1[s], child.x2[s], child.y2[s]);
+            if (d2 <= maxDist2) {
+                queue.push(RSiCandidate(sqrt(d2), n, s));
+            }
+        }
+    }
+
+    return qMakePair(-1, -1);
+}
+
+void RSpatialIndexFlat::visitItem(const Node& node, const Item& item, int slot,
+    QMap<int, QSet<int> >* result,
+    QVector<QPair<int, int> >* resultVector,
+    RSpatialIndexVisitor* dataVisitor) {
+
+    if (result!=NULL) {
+        (*result)[item.id].insert(item.pos);
+    }
+    if (resultVector!=NULL) {
+        resultVector->append(qMakePair(item.id, item.pos));
+    }
+
+    if (dataVisitor!=NULL) {
+        dataVisitor->visitData(item.id, item.pos,
+            node.x1[slot], node.y1[slot], item.z1,
+            node.x2[slot], node.y2[slot], item.z2);
+    }
+}
+
+bool RSpatialIndexFlat::lessX(const Entry& a, const Entry& b) {
+    return a.x1 + a.x2 < b.x1 + b.x2;
+}
+
+bool RSpatialIndexFlat::lessY(const Entry& a, const Entry& b) {
+    return a.y1 + a.y2 < b.y1 + b.y2;
+}
@@ -0,0 +1,231 @@
+/**
+ * Copyright (c) 2011-2013 by Andrew Mustun. All rights reserved.
+ * 
+ * This file is part of the QCAD project.
+ *
+ * QCAD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QCAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QCAD.
+ */
+
+#ifndef RSPATIALINDEXFLAT_H
+#define RSPATIALINDEXFLAT_H
+
+#include "spatialindex_global.h"
+
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QVector>
+
+#include "RSpatialIndex.h"
+
+/**
+ * \brief Native two dimensional R-tree spatial index.
+ *
+ * Nodes are stored in one contiguous array and referenced by index.
+ * The boxes of the entries of a node are stored as separate coordinate
+ * arrays (structure of arrays), so that overlap tests run over
+ * contiguous memory. Entries are indexed in two dimensions, the z range
+ * of every entry is checked at the leaf level only.
+ *
+ * Entries are found by ID and position through a hash, so removing an
+ * entry does not require a tree search.
+ *
+ * \ingroup spatialindex
+ * \scriptable
+ */
+class QCADSPATIALINDEX_EXPORT RSpatialIndexFlat: public RSpatialIndex {
+public:
+    RSpatialIndexFlat();
+    virtual ~RSpatialIndexFlat();
+
+    /**
+     * \nonscriptable
+     */
+    virtual RSpatialIndex* create();
+
+    virtual void clear();
+
+    virtual void addToIndex(int id, int pos,
+                    double x1, double y1, double z1,
+                    double x2, double y2, double z2);
+
+    virtual void addToIndex(int id, int pos,
+        const RBox& bb);
+
+    /**
+     * \nonscriptable
+     */
+    virtual void bulkLoad(const QList<int>& ids, const QList<QList<RBox> >& bbs);
+
+    virtual bool removeFromIndex(int id, const QList<RBox>& bb);
+    virtual bool removeFromIndex(int id, int pos, const RBox& bb);
+    virtual bool removeFromIndex(
+            int id,
+            int pos,
+            double x1, double y1, double z1,
+            double x2, double y2, double z2);
+
+    virtual QMap<int, QSet<int> > queryIntersected(
+            double x1, double y1, double z1,
+            double x2, double y2, double z2,
+            RSpatialIndexVisitor* dataVisitor = NULL);
+    virtual QMap<int, QSet<int> > queryContained(
+            double x1, double y1, double z1,
+            double x2, double y2, double z2,
+            RSpatialIndexVisitor* dataVisitor = NULL);
+
+    /**
+     * \nonscriptable
+     */
+    virtual void queryIntersected(
+            double x1, double y1, double z1,
+            double x2, double y2, double z2,
+            QVector<QPair<int, int> >& result);
+    /**
+     * \nonscriptable
+     */
+    virtual void queryContained(
+            double x1, double y1, double z1,
+            double x2, double y2, double z2,
+            QVector<QPair<int, int> >& result);
+
+    virtual QMap<int, QSet<int> > queryNearestNeighbor(
+            unsigned int k,
+            double x, double y, double z,
+            RSpatialIndexVisitor* dataVisitor = NULL);
+
+    virtual QPair<int, int> queryNearestNeighbor(double x, double y, double z);
+
+    /**
+     * \nonscriptable
+     */
+    virtual QPair<int, int> queryNearestNeighborXY(
+            double x, double y, double maxDistance,
+            RSpatialIndexDistanceFunction& distanceFunction);
+
+    /**
+     * \nonscriptable
+     */
+    virtual bool save(QDataStream& stream);
+    /**
+     * \nonscriptable
+     */
+    virtual bool load(QDataStream& stream);
+
+    int getSize() const;
+    int getHeight() const;
+
+protected:
+    /**
+     * Maximum number of entries per node.
+     */
+    static const int capacity = 16;
+
+    /**
+     * Node with the boxes of its entries stored as coordinate arrays.
+     * Entries of leaves (level 0) refer to items, entries of other nodes
+     * refer to child nodes.
+     *
+     * \nonscriptable
+     */
+    struct Node {
+        double x1[capacity];
+        double y1[capacity];
+        double x2[capacity];
+        double y2[capacity];
+        int child[capacity];
+        int count;
+        int level;
+        int parent;
+    };
+
+    /**
+     * Indexed entry (ID, position), its z range and the leaf it is in.
+     *
+     * \nonscriptable
+     */
+    struct Item {
+        int id;
+        int pos;
+        double z1;
+        double z2;
+        int leaf;
+    };
+
+    /**
+     * Entry box with reference, used for building and splitting nodes.
+     *
+     * \nonscriptable
+     */
+    struct Entry {
+        double x1;
+        double y1;
+        double x2;
+        double y2;
+        int ref;
+    };
+
+protected:
+    int newNode(int level, int parent);
+    void freeNode(int n);
+    int newItem();
+    void freeItem(int i);
+
+    int chooseLeaf(const Entry& e) const;
+    int findSlot(int n, int child) const;
+    void insertEntry(int n, const Entry& e);
+    void splitNode(int n, const Entry& e);
+    void setChild(int n, int slot, const Entry& e);
+    void growParents(int n, const Entry& e);
+    void tightenParents(int n);
+    Entry getBounds(int n) const;
+    void condense(int n);
+    void removeItem(int i);
+
+    void query(bool contained,
+               double x1, double y1, double z1,
+               double x2, double y2, double z2,
+               QMap<int, QSet<int> >* result,
+               QVector<QPair<int, int> >* resultVector,
+               RSpatialIndexVisitor* dataVisitor) const;
+    void nearestNeighbor(unsigned int k,
+               double x, double y,
+               QMap<int, QSet<int> >& result,
+               RSpatialIndexVisitor* dataVisitor) const;
+    QPair<int, int> nearestNeighborXY(
+               double x, double y, double maxDistance,
+               RSpatialIndexDistanceFunction& distanceFunction) const;
+    static void visitItem(const Node& node, const Item& item, int slot,
+                   QMap<int, QSet<int> >* result,
+                   QVector<QPair<int, int> >* resultVector,
+                   RSpatialIndexVisitor* dataVisitor);
+
+    static bool lessX(const Entry& a, const Entry& b);
+    static bool lessY(const Entry& a, const Entry& b);
+
+protected:
+    QVector<Node> nodes;
+    QVector<Item> items;
+    QVector<int> freeNodes;
+    QVector<int> freeItems;
+    /**
+     * Spatial index ID (see \ref getSIId) -> item index.
+     */
+    QHash<qint64, int> itemMap;
+    int root;
+};
+
+Q_DECLARE_METATYPE(RSpatialIndexFlat*)
+
+#endif
@@ -28,6 +28,85 @@
 #define RSIMINDOUBLE -std::numeric_limits<double>::max()
 #endif
 
+// 0.7: results in much slower deletes
+// 0.1: crashes randomly with 'InvalidPageException: Unknown page id ...'
+// 0.2: seems to work reasonably well
+static const double minimumLoad = 0.2;
+// 100: slower for inserts
+static const size_t indexCapacity = 50;
+// 100: slower for inserts
+static const size_t leafCapacity = 50;
+// node fill for bulk loading, leaves room for later inserts:
+static const double bulkLoadFill = 0.7;
+
+
+
+/**
+ * Internal.
+ * Stream of index entries for bulk loading.
+ */
+class RSiDataStream : public SpatialIndex::IDataStream {
+public:
+    RSiDataStream(const QList<int>& ids, const QList<QList<RBox> >& bbs) :
+        ids(ids), bbs(bbs), i(0), pos(0), count(0) {
+
+        for (int k = 0; k < ids.size() && k < bbs.size(); ++k) {
+            count += bbs[k].size();
+        }
+        skipEmpty();
+    }
+
+    virtual SpatialIndex::IData* getNext() {
+        if (!hasNext()) {
+            return NULL;
+        }
+
+        const RBox& bb = bbs[i][pos];
+        double p1[] = {
+            qMin(bb.c1.x, bb.c2.x), qMin(bb.c1.y, bb.c2.y), qMin(bb.c1.z, bb.c2.z)
+        };
+        double p2[] = {
+            qMax(bb.c1.x, bb.c2.x), qMax(bb.c1.y, bb.c2.y), qMax(bb.c1.z, bb.c2.z)
+        };
+        SpatialIndex::Region region(p1, p2, 3);
+        SpatialIndex::IData* ret = new SpatialIndex::RTree::Data(
+            0, NULL, region, RSpatialIndex::getSIId(ids[i], pos));
+
+        pos++;
+        skipEmpty();
+        return ret;
+    }
+
+    virtual bool hasNext() {
+        return i < ids.size() && i < bbs.size();
+    }
+
+    virtual size_t size() {
+        return count;
+    }
+
+    virtual void rewind() {
+        i = 0;
+        pos = 0;
+        skipEmpty();
+    }
+
+private:
+    void skipEmpty() {
+        while (hasNext() && pos >= bbs[i].size()) {
+            i++;
+            pos = 0;
+        }
+    }
+
+private:
+    const QList<int>& ids;
+    const QList<QList<RBox> >& bbs;
+    int i;
+    int pos;
+    size_t count;
+};
+
 
 
 /**
@@ -104,14 +183,6 @@ void RSpatialIndexNavel::init() {
     SpatialIndex::id_type indexIdentifier;
     int dimension = 3;
 
-    // 0.7: results in much slower deletes
-    // 0.1: crashes randomly with 'InvalidPageException: Unknown page id ...'
-    // 0.2: seems to work reasonably well
-    double minimumLoad = 0.2;
-    // 100: slower for inserts
-    size_t indexCapacity = 50;
-    // 100: slower for inserts
-    size_t leafCapacity = 50;
     tree = SpatialIndex::RTree::createNewRTree(
         *buff,
         minimumLoad,
@@ -135,10 +206,63 @@ void RSpatialIndexNavel::uninit() {
 }
 
 
+RSpatialIndex* RSpatialIndexNavel::create() {
+    return new RSpatialIndexNavel();
+}
+
 void RSpatialIndexNavel::clear() {
     uninit();
     init();
 }
+
+
+
+/**
+ * Replaces the contents of this index with the given entries, using
+ * sort-tile-recursive (STR) bulk loading instead of inserting the entries
+ * one by one. If bulk loading fails, the entries are inserted one by one
+ * instead, so that the index always reflects the given entries.
+ */
+void RSpatialIndexNavel::bulkLoad(const QList<int>& ids, const QList<QList<RBox> >& bbs) {
+    RSiDataStream stream(ids, bbs);
+    if (!stream.hasNext()) {
+        clear();
+        return;
+    }
+
+    SpatialIndex::IStorageManager* newBuff =
+        SpatialIndex::StorageManager::createNewMemoryStorageManager();
+    SpatialIndex::ISpatialIndex* newTree = NULL;
+
+    SpatialIndex::id_type indexIdentifier;
+    try {
+        newTree = SpatialIndex::RTree::createAndBulkLoadNewRTree(
+            SpatialIndex::RTree::BLM_STR,
+            stream,
+            *newBuff,
+            minimumLoad,
+            bulkLoadFill,
+            indexCapacity,
+            leafCapacity,
+            3,
+            SpatialIndex::RTree::RV_RSTAR,
+            indexIdentifier
+        );
+    } catch (Tools::Exception& e) {
+        qWarning() << "RSpatialIndexNavel::bulkLoad: bulk load failed, inserting entries one by one: "
+                   << e.what().c_str();
+        delete newBuff;
+        RSpatialIndex::bulkLoad(ids, bbs);
+        return;
+    } catch (...) {
+        delete newBuff;
+        throw;
+    }
+
+    uninit();
+    tree = newTree;
+    buff = newBuff;
+}
     
     
 /**
@@ -387,6 +511,29 @@ QMap<int, QSet<int> > RSpatialIndexNavel::queryContained(
 }
 
 
+void RSpatialIndexNavel::queryIntersected(
+    double x1, double y1, double z1,
+    double x2, double y2, double z2,
+    QVector<QPair<int, int> >& result) {
+
+    RSpatialIndexNavel::VectorVisitor visitor(result);
+    tree->intersectsWithQuery(
+        RSpatialIndexNavel::RSiRegion(x1, y1, z1, x2, y2, z2), visitor);
+}
+
+
+
+void RSpatialIndexNavel::queryContained(
+    double x1, double y1, double z1,
+    double x2, double y2, double z2,
+    QVector<QPair<int, int> >& result) {
+
+    RSpatialIndexNavel::VectorVisitor visitor(result);
+    tree->containsWhatQuery(
+        RSpatialIndexNavel::RSiRegion(x1, y1, z1, x2, y2, z2), visitor);
+}
+
+
 QMap<int, QSet<int> > RSpatialIndexNavel::queryNearestNeighbor(
     unsigned int k,
     double x, double y, double z,
@@ -197,6 +197,39 @@ protected:
         RSpatialIndexVisitor* dataVisitor;
     };
 
+    /**
+     * \brief Internal data visitor that appends (ID, position) pairs
+     * to a vector.
+     * Depends on the external spatial index library.
+     *
+     * \ingroup spatialindex
+     */
+    class VectorVisitor: public SpatialIndex::IVisitor {
+    public:
+        VectorVisitor(QVector<QPair<int, int> >& result) :
+            result(result) {
+        }
+
+        void visitNode(const SpatialIndex::INode& n) {
+            Q_UNUSED(n)
+        }
+
+        void visitData(const SpatialIndex::IData& d) {
+            qint64 siid = d.getIdentifier();
+            result.append(qMakePair(RSpatialIndex::getId(siid), RSpatialIndex::getPos(siid)));
+        }
+
+        void visitData(std::vector<const SpatialIndex::IData*>& v) {
+            std::vector<const SpatialIndex::IData*>::iterator it;
+            for (it = v.begin(); it != v.end(); it++) {
+                visitData(**it);
+            }
+        }
+
+    private:
+        QVector<QPair<int, int> >& result;
+    };
+
 public:
     RSpatialIndexNavel();
     ~RSpatialIndexNavel();
@@ -204,6 +237,11 @@ public:
     //static int dataToInt(const uint8_t* data);
     //static void intToData(int i, uint8_t* data);
 
+    /**
+     * \nonscriptable
+     */
+    virtual RSpatialIndex* create();
+
     virtual void clear();
 
     virtual void addToIndex(int id, int pos,
@@ -213,6 +251,11 @@ public:
     virtual void addToIndex(int id, int pos,
         const RBox& bb);
 
+    /**
+     * \nonscriptable
+     */
+    virtual void bulkLoad(const QList<int>& ids, const QList<QList<RBox> >& bbs);
+
     //void removeFromIndex(int id);
     virtual bool removeFromIndex(int id, const QList<RBox>& bb);
     virtual bool removeFromIndex(int id, int pos, const RBox& bb);
@@ -231,6 +274,21 @@ public:
             double x2, double y2, double z2,
             RSpatialIndexVisitor* dataVisitor = NULL);
 
+    /**
+     * \nonscriptable
+     */
+    virtual void queryIntersected(
+            double x1, double y1, double z1,
+            double x2, double y2, double z2,
+            QVector<QPair<int, int> >& result);
+    /**
+     * \nonscriptable
+     */
+    virtual void queryContained(
+            double x1, double y1, double z1,
+            double x2, double y2, double z2,
+            QVector<QPair<int, int> >& result);
+
     virtual QMap<int, QSet<int> > queryNearestNeighbor(
             unsigned int k,
             double x, double y, double z,
@@ -1,9 +1,11 @@
 include( ../../shared.pri )
 
 HEADERS = \
+    RSpatialIndexFlat.h \
     RSpatialIndexNavel.h
 
 SOURCES = \
+    RSpatialIndexFlat.cpp \
     RSpatialIndexNavel.cpp
 
 TEMPLATE = lib
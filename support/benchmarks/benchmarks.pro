@@ -0,0 +1,4 @@
+include (../../shared.pri)
+TEMPLATE = subdirs
+SUBDIRS = \
+    spatialindex
@@ -0,0 +1,717 @@
+/**
+ * Benchmark and cross-check of the spatial index implementations.
+ *
+ * Builds every RSpatialIndex implementation from the same synthetic and
+ * real (DXF) datasets and reports build time, memory use, latency of
+ * window, point and nearest neighbor queries and update throughput.
+ * All implementations must return identical results for the same
+ * randomized queries, before and after a sequence of updates. The
+ * program exits with 1 if any results differ.
+ *
+ * Usage:
+ *   spatialindex_benchmark [options] [file or directory ...]
+ *
+ * Options:
+ *   -count N       number of items of synthetic datasets (100000)
+ *   -queries N     number of queries of each type (1000)
+ *   -updates N     number of updates (10000)
+ *   -seed N        seed for random numbers (1)
+ *   -no-synthetic  skip synthetic datasets
+ *   -check-only    only cross-check results, no timing
+ *
+ * Every given file or directory (searched recursively for DXF files) is
+ * one real dataset. Without arguments, support/data/tests and
+ * libraries/default are used if they exist in the current directory.
+ */
+#include <QApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+#include <cmath>
+#include <cstdlib>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+#include "RDocument.h"
+#include "RDocumentInterface.h"
+#include "RFontList.h"
+#include "RMath.h"
+#include "RMemoryStorage.h"
+#include "RPatternListImperial.h"
+#include "RPatternListMetric.h"
+#include "RPluginLoader.h"
+#include "RSettings.h"
+#include "RSpatialIndexDistanceFunction.h"
+#include "RSpatialIndexFlat.h"
+#include "RSpatialIndexNavel.h"
+#include "RSpatialIndexSimple.h"
+
+namespace {
+
+QTextStream out(stdout);
+
+/**
+ * Items to index: IDs and for every ID a list of boxes.
+ */
+struct Dataset {
+    QString name;
+    QList<int> ids;
+    QList<QList<RBox> > bbs;
+    RBox extent;
+
+    int countBoxes() const {
+        int ret = 0;
+        for (int i=0; i<bbs.size(); i++) {
+            ret += bbs[i].size();
+        }
+        return ret;
+    }
+
+    void append(const QList<RBox>& boxes) {
+        ids.append(ids.size()+1);
+        bbs.append(boxes);
+        for (int i=0; i<boxes.size(); i++) {
+            extent.growToInclude(boxes[i]);
+        }
+    }
+};
+
+struct Implementation {
+    QString name;
+    RSpatialIndex* (*create)();
+};
+
+RSpatialIndex* createSimple() {
+    return new RSpatialIndexSimple();
+}
+
+RSpatialIndex* createNavel() {
+    return new RSpatialIndexNavel();
+}
+
+RSpatialIndex* createFlat() {
+    return new RSpatialIndexFlat();
+}
+
+/**
+ * Randomized queries for one dataset. The same queries are used for
+ * all implementations.
+ */
+struct Queries {
+    QList<RBox> windows;
+    QList<RBox> points;
+    QList<RVector> nearest;
+    double maxDistance;
+};
+
+/**
+ * A random update: the boxes of item \c index are moved by \c offset.
+ */
+struct Update {
+    int index;
+    RVector offset;
+};
+
+/**
+ * Results of all queries of one implementation, used for the
+ * cross-check.
+ */
+struct Results {
+    QList<QVector<QPair<int, int> > > windows;
+    QList<QVector<QPair<int, int> > > contained;
+    QList<QVector<QPair<int, int> > > points;
+    QList<double> nearest;
+};
+
+double randomValue() {
+    return qrand() / (double)RAND_MAX;
+}
+
+double randomValue(double min, double max) {
+    return min + randomValue() * (max-min);
+}
+
+RBox randomBox(const RVector& center, double width, double height) {
+    return RBox(center - RVector(width/2, height/2), center + RVector(width/2, height/2));
+}
+
+/**
+ * \return Resident memory of this process in KB or -1 if unknown.
+ */
+qint64 getResidentMemory() {
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/statm");
+    if (file.open(QIODevice::ReadOnly)) {
+        QStringList fields = QString(file.readAll()).split(' ');
+        if (fields.size()>1) {
+            return fields[1].toLongLong() * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+    }
+#endif
+    return -1;
+}
+
+/**
+ * Small boxes, uniformly distributed (e.g. texts, points, short lines).
+ */
+Dataset createUniform(int count) {
+    Dataset ret;
+    ret.name = "uniform";
+    for (int i=0; i<count; i++) {
+        RVector c(randomValue(0, 1000), randomValue(0, 1000));
+        ret.append(QList<RBox>() << randomBox(c, randomValue(0, 2), randomValue(0, 2)));
+    }
+    return ret;
+}
+
+/**
+ * Small boxes in dense clusters (e.g. details in a large plan).
+ */
+Dataset createClustered(int count) {
+    Dataset ret;
+    ret.name = "clustered";
+    QList<RVector> centers;
+    for (int i=0; i<50; i++) {
+        centers.append(RVector(randomValue(0, 1000), randomValue(0, 1000)));
+    }
+    for (int i=0; i<count; i++) {
+        RVector c = centers[qrand() % centers.size()];
+        // approximately normal distribution around the cluster center:
+        double dx = randomValue() + randomValue() + randomValue() - 1.5;
+        double dy = randomValue() + randomValue() + randomValue() - 1.5;
+        c += RVector(dx * 10, dy * 10);
+        ret.append(QList<RBox>() << randomBox(c, randomValue(0, 0.5), randomValue(0, 0.5)));
+    }
+    return ret;
+}
+
+/**
+ * Long, thin boxes which overlap many others (e.g. axis lines, walls).
+ */
+Dataset createLines(int count) {
+    Dataset ret;
+    ret.name = "lines";
+    for (int i=0; i<count; i++) {
+        RVector c(randomValue(0, 1000), randomValue(0, 1000));
+        double length = randomValue(0, 100);
+        if (qrand()%2==0) {
+            ret.append(QList<RBox>() << randomBox(c, length, randomValue(0, 1)));
+        }
+        else {
+            ret.append(QList<RBox>() << randomBox(c, randomValue(0, 1), length));
+        }
+    }
+    return ret;
+}
+
+/**
+ * Items with many boxes each (e.g. segments of polylines).
+ */
+Dataset createPolylines(int count) {
+    Dataset ret;
+    ret.name = "polylines";
+    int items = qMax(count / 20, 1);
+    for (int i=0; i<items; i++) {
+        QList<RBox> boxes;
+        RVector p(randomValue(0, 1000), randomValue(0, 1000));
+        for (int k=0; k<20; k++) {
+            RVector next = p + RVector(randomValue(-5, 5), randomValue(-5, 5));
+            boxes.append(RBox(p, next));
+            p = next;
+        }
+        ret.append(boxes);
+    }
+    return ret;
+}
+
+/**
+ * \return All DXF files in the given directory (recursively) or the
+ * given file.
+ */
+QStringList getDrawingFiles(const QString& path) {
+    QStringList ret;
+    QFileInfo fi(path);
+    if (fi.isFile()) {
+        ret.append(fi.absoluteFilePath());
+        return ret;
+    }
+
+    QDirIterator it(path, QStringList() << "*.dxf" << "*.DXF",
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        ret.append(it.next());
+    }
+    ret.sort();
+    return ret;
+}
+
+/**
+ * Imports all drawings found at the given path into one dataset. Every
+ * entity of every block is one item with the boxes it would add to the
+ * spatial index of the document.
+ */
+Dataset loadDrawings(const QString& path) {
+    Dataset ret;
+    ret.name = QFileInfo(path).fileName();
+
+    QStringList files = getDrawingFiles(path);
+    for (int i=0; i<files.size(); i++) {
+        RMemoryStorage* storage = new RMemoryStorage();
+        RSpatialIndexSimple* spatialIndex = new RSpatialIndexSimple();
+        RDocument* document = new RDocument(*storage, *spatialIndex);
+        RDocumentInterface* documentInterface = new RDocumentInterface(*document);
+
+        if (documentInterface->importFile(files[i], "", false)!=RDocumentInterface::IoErrorNoError) {
+            qWarning() << "cannot import " << files[i];
+            delete documentInterface;
+            continue;
+        }
+
+        QSet<REntity::Id> ids = document->queryAllEntities(false, true);
+        QList<REntity::Id> sortedIds = ids.toList();
+        qSort(sortedIds);
+        for (int k=0; k<sortedIds.size(); k++) {
+            QSharedPointer<REntity> entity = document->queryEntityDirect(sortedIds[k]);
+            if (entity.isNull()) {
+                continue;
+            }
+            QList<RBox> boxes = entity->getBoundingBoxes();
+            QList<RBox> validBoxes;
+            for (int b=0; b<boxes.size(); b++) {
+                if (boxes[b].isValid()) {
+                    validBoxes.append(boxes[b]);
+                }
+            }
+            if (!validBoxes.isEmpty()) {
+                ret.append(validBoxes);
+            }
+        }
+
+        delete documentInterface;
+    }
+
+    return ret;
+}
+
+Queries createQueries(const Dataset& dataset, int count) {
+    Queries ret;
+
+    RVector min = dataset.extent.getMinimum();
+    RVector size = dataset.extent.getSize();
+    RVector windowSize = size * 0.05;
+
+    for (int i=0; i<count; i++) {
+        RVector c(randomValue(min.x, min.x+size.x), randomValue(min.y, min.y+size.y));
+        RBox w = randomBox(c, windowSize.x, windowSize.y);
+        w.c1.z = RMINDOUBLE;
+        w.c2.z = RMAXDOUBLE;
+        ret.windows.append(w);
+
+        c = RVector(randomValue(min.x, min.x+size.x), randomValue(min.y, min.y+size.y));
+        ret.points.append(RBox(RVector(c.x, c.y, RMINDOUBLE), RVector(c.x, c.y, RMAXDOUBLE)));
+
+        ret.nearest.append(RVector(randomValue(min.x, min.x+size.x), randomValue(min.y, min.y+size.y)));
+    }
+
+    ret.maxDistance = size.getMagnitude2d() * 0.05;
+    return ret;
+}
+
+QList<Update> createUpdates(const Dataset& dataset, int count) {
+    QList<Update> ret;
+    if (dataset.ids.isEmpty()) {
+        return ret;
+    }
+    RVector size = dataset.extent.getSize();
+    for (int i=0; i<count; i++) {
+        Update u;
+        u.index = qrand() % dataset.ids.size();
+        u.offset = RVector(randomValue(-0.01, 0.01) * size.x, randomValue(-0.01, 0.01) * size.y);
+        ret.append(u);
+    }
+    return ret;
+}
+
+/**
+ * Exact 2d distance between the query position and the box of an item.
+ */
+class BoxDistance : public RSpatialIndexDistanceFunction {
+public:
+    BoxDistance(const QList<QList<RBox> >& bbs, const RVector& position)
+        : bbs(bbs), position(position) {}
+
+    virtual double getDistance(int id, int pos) {
+        // IDs are index+1, see Dataset::append:
+        const RBox& box = bbs[id-1][pos];
+        double dx = qMax(qMax(box.c1.x - position.x, position.x - box.c2.x), 0.0);
+        double dy = qMax(qMax(box.c1.y - position.y, position.y - box.c2.y), 0.0);
+        return sqrt(dx*dx + dy*dy);
+    }
+
+private:
+    const QList<QList<RBox> >& bbs;
+    RVector position;
+};
+
+/**
+ * Moves the boxes of one item in the index and in the given list of
+ * boxes.
+ */
+void applyUpdate(RSpatialIndex& si, QList<QList<RBox> >& bbs, const Update& u) {
+    int id = u.index + 1;
+    si.removeFromIndex(id, bbs[u.index]);
+    for (int i=0; i<bbs[u.index].size(); i++) {
+        bbs[u.index][i].c1 += u.offset;
+        bbs[u.index][i].c2 += u.offset;
+    }
+    si.addToIndex(id, bbs[u.index]);
+}
+
+double getNearestDistance(RSpatialIndex& si, const QList<QList<RBox> >& bbs,
+                          const RVector& p, double maxDistance) {
+    BoxDistance distance(bbs, p);
+    QPair<int, int> n = si.queryNearestNeighborXY(p.x, p.y, maxDistance, distance);
+    if (n.first<=0) {
+        return RMAXDOUBLE;
+    }
+    return distance.getDistance(n.first, n.second);
+}
+
+Results query(RSpatialIndex& si, const QList<QList<RBox> >& bbs, const Queries& queries) {
+    Results ret;
+    for (int i=0; i<queries.windows.size(); i++) {
+        QVector<QPair<int, int> > r;
+        si.queryIntersected(queries.windows[i], r);
+        qSort(r);
+        ret.windows.append(r);
+
+        r.clear();
+        si.queryContained(queries.windows[i], r);
+        qSort(r);
+        ret.contained.append(r);
+    }
+    for (int i=0; i<queries.points.size(); i++) {
+        QVector<QPair<int, int> > r;
+        si.queryIntersected(queries.points[i], r);
+        qSort(r);
+        ret.points.append(r);
+    }
+    for (int i=0; i<queries.nearest.size(); i++) {
+        ret.nearest.append(getNearestDistance(si, bbs, queries.nearest[i], queries.maxDistance));
+    }
+    return ret;
+}
+
+/**
+ * \return Number of queries with different results.
+ */
+int compare(const QString& label, const Results& expected, const Results& actual) {
+    int ret = 0;
+    for (int i=0; i<expected.windows.size(); i++) {
+        if (expected.windows[i]!=actual.windows[i]) {
+            if (ret==0) {
+                out << "    " << label << ": window query " << i << ": "
+                    << expected.windows[i].size() << " / " << actual.windows[i].size() << " results\n";
+            }
+            ret++;
+        }
+        if (expected.contained[i]!=actual.contained[i]) {
+            if (ret==0) {
+                out << "    " << label << ": contained query " << i << ": "
+                    << expected.contained[i].size() << " / " << actual.contained[i].size() << " results\n";
+            }
+            ret++;
+        }
+    }
+    for (int i=0; i<expected.points.size(); i++) {
+        if (expected.points[i]!=actual.points[i]) {
+            if (ret==0) {
+                out << "    " << label << ": point query " << i << ": "
+                    << expected.points[i].size() << " / " << actual.points[i].size() << " results\n";
+            }
+            ret++;
+        }
+    }
+    for (int i=0; i<expected.nearest.size(); i++) {
+        if (!RMath::fuzzyCompare(expected.nearest[i], actual.nearest[i], 1.0e-9)) {
+            if (ret==0) {
+                out << "    " << label << ": nearest neighbor query " << i << ": distance "
+                    << expected.nearest[i] << " / " << actual.nearest[i] << "\n";
+            }
+            ret++;
+        }
+    }
+    return ret;
+}
+
+QString formatTime(qint64 nsecs, int count) {
+    if (count==0) {
+        return "-";
+    }
+    return QString::number(nsecs / 1000.0 / count, 'f', 1);
+}
+
+/**
+ * Benchmarks one implementation with the given dataset.
+ */
+void benchmark(const Implementation& impl, const Dataset& dataset,
+               const Queries& queries, const QList<Update>& updates) {
+
+    QElapsedTimer timer;
+
+    // incremental build:
+    RSpatialIndex* si = impl.create();
+    timer.start();
+    for (int i=0; i<dataset.ids.size(); i++) {
+        si->addToIndex(dataset.ids[i], dataset.bbs[i]);
+    }
+    qint64 addTime = timer.nsecsElapsed();
+    delete si;
+
+    // bulk load:
+    qint64 memory = getResidentMemory();
+    si = impl.create();
+    timer.start();
+    si->bulkLoad(dataset.ids, dataset.bbs);
+    qint64 buildTime = timer.nsecsElapsed();
+    if (memory!=-1) {
+        memory = getResidentMemory() - memory;
+    }
+
+    qint64 windowTime = 0;
+    qint64 pointTime = 0;
+    qint64 nearestTime = 0;
+    int results = 0;
+    QVector<QPair<int, int> > r;
+
+    timer.start();
+    for (int i=0; i<queries.windows.size(); i++) {
+        r.clear();
+        si->queryIntersected(queries.windows[i], r);
+        results += r.size();
+    }
+    windowTime = timer.nsecsElapsed();
+
+    timer.start();
+    for (int i=0; i<queries.points.size(); i++) {
+        r.clear();
+        si->queryIntersected(queries.points[i], r);
+        results += r.size();
+    }
+    pointTime = timer.nsecsElapsed();
+
+    timer.start();
+    for (int i=0; i<queries.nearest.size(); i++) {
+        BoxDistance distance(dataset.bbs, queries.nearest[i]);
+        results += si->queryNearestNeighborXY(
+            queries.nearest[i].x, queries.nearest[i].y, queries.maxDistance, distance).first;
+    }
+    nearestTime = timer.nsecsElapsed();
+
+    QList<QList<RBox> > bbs = dataset.bbs;
+    timer.start();
+    for (int i=0; i<updates.size(); i++) {
+        applyUpdate(*si, bbs, updates[i]);
+    }
+    qint64 updateTime = timer.nsecsElapsed();
+
+    delete si;
+
+    out << QString("  %1 %2 %3 %4 %5 %6 %7 %8\n")
+           .arg(impl.name, -8)
+           .arg(QString::number(buildTime / 1.0e6, 'f', 1), 10)
+           .arg(QString::number(addTime / 1.0e6, 'f', 1), 10)
+           .arg(memory==-1 ? QString("-") : QString::number(memory), 10)
+           .arg(formatTime(windowTime, queries.windows.size()), 10)
+           .arg(formatTime(pointTime, queries.points.size()), 10)
+           .arg(formatTime(nearestTime, queries.nearest.size()), 10)
+           .arg(updateTime==0 ? QString("-") : QString::number(updates.size() / (updateTime / 1.0e9), 'f', 0), 12);
+    out.flush();
+
+    // keep the compiler from optimizing the queries away:
+    if (results==-1) {
+        out << results;
+    }
+}
+
+/**
+ * Runs the same queries against all implementations before and after
+ * the same updates and compares the results with those of the first
+ * implementation.
+ *
+ * \return Number of queries with different results.
+ */
+int crossCheck(const QList<Implementation>& impls, const Dataset& dataset,
+               const Queries& queries, const QList<Update>& updates) {
+
+    Results expected;
+    Results expectedUpdated;
+    int ret = 0;
+
+    for (int i=0; i<impls.size(); i++) {
+        RSpatialIndex* si = impls[i].create();
+        si->bulkLoad(dataset.ids, dataset.bbs);
+        Results results = query(*si, dataset.bbs, queries);
+
+        QList<QList<RBox> > bbs = dataset.bbs;
+        for (int k=0; k<updates.size(); k++) {
+            applyUpdate(*si, bbs, updates[k]);
+        }
+        Results resultsUpdated = query(*si, bbs, queries);
+
+        delete si;
+
+        if (i==0) {
+            expected = results;
+            expectedUpdated = resultsUpdated;
+            continue;
+        }
+
+        int diff = compare(impls[i].name, expected, results);
+        diff += compare(impls[i].name + " (updated)", expectedUpdated, resultsUpdated);
+        if (diff>0) {
+            out << "    " << impls[i].name << " differs from " << impls[0].name
+                << " in " << diff << " queries\n";
+        }
+        ret += diff;
+    }
+
+    out << "  cross-check: " << (ret==0 ? "ok" : "FAILED") << "\n";
+    out.flush();
+    return ret;
+}
+
+}
+
+int main(int argc, char **argv) {
+    QApplication* app = new QApplication(argc, argv);
+
+    int count = 100000;
+    int queryCount = 1000;
+    int updateCount = 10000;
+    int seed = 1;
+    bool synthetic = true;
+    bool checkOnly = false;
+    QStringList paths;
+
+    QStringList args = app->arguments();
+    for (int i=1; i<args.size(); i++) {
+        if (args[i]=="-count" && i+1<args.size()) {
+            count = args[++i].toInt();
+        }
+        else if (args[i]=="-queries" && i+1<args.size()) {
+            queryCount = args[++i].toInt();
+        }
+        else if (args[i]=="-updates" && i+1<args.size()) {
+            updateCount = args[++i].toInt();
+        }
+        else if (args[i]=="-seed" && i+1<args.size()) {
+            seed = args[++i].toInt();
+        }
+        else if (args[i]=="-no-synthetic") {
+            synthetic = false;
+        }
+        else if (args[i]=="-check-only") {
+            checkOnly = true;
+        }
+        else {
+            paths.append(args[i]);
+        }
+    }
+
+    if (paths.isEmpty()) {
+        if (QDir("support/data/tests").exists()) {
+            paths.append("support/data/tests");
+        }
+        if (QDir("libraries/default").exists()) {
+            paths.append("libraries/default");
+        }
+    }
+
+    QList<Implementation> impls;
+    Implementation impl;
+    impl.name = "Simple";
+    impl.create = createSimple;
+    impls.append(impl);
+    impl.name = "Navel";
+    impl.create = createNavel;
+    impls.append(impl);
+    impl.name = "Flat";
+    impl.create = createFlat;
+    impls.append(impl);
+
+    qsrand(seed);
+
+    QList<Dataset> datasets;
+    if (synthetic) {
+        datasets.append(createUniform(count));
+        datasets.append(createClustered(count));
+        datasets.append(createLines(count));
+        datasets.append(createPolylines(count));
+    }
+
+    if (!paths.isEmpty()) {
+        // initialization needed to import drawings:
+        app->setLibraryPaths(QStringList() << RSettings::getPluginPath());
+        RFontList::init();
+        RPatternListMetric::init();
+        RPatternListImperial::init();
+        RPluginLoader::loadPlugins(true);
+
+        for (int i=0; i<paths.size(); i++) {
+            datasets.append(loadDrawings(paths[i]));
+        }
+    }
+
+    int failed = 0;
+    for (int i=0; i<datasets.size(); i++) {
+        const Dataset& dataset = datasets[i];
+        if (dataset.ids.isEmpty()) {
+            out << "dataset " << dataset.name << ": empty\n";
+            continue;
+        }
+
+        Queries queries = createQueries(dataset, queryCount);
+        QList<Update> updates = createUpdates(dataset, updateCount);
+
+        out << "dataset " << dataset.name << ": "
+            << dataset.ids.size() << " items, "
+            << dataset.countBoxes() << " boxes\n";
+
+        if (!checkOnly) {
+            out << QString("  %1 %2 %3 %4 %5 %6 %7 %8\n")
+                   .arg("index", -8)
+                   .arg("bulk ms", 10)
+                   .arg("add ms", 10)
+                   .arg("mem KB", 10)
+                   .arg("window us", 10)
+                   .arg("point us", 10)
+                   .arg("nearest us", 10)
+                   .arg("updates/s", 12);
+
+            for (int k=0; k<impls.size(); k++) {
+                benchmark(impls[k], dataset, queries, updates);
+            }
+        }
+
+        failed += crossCheck(impls, dataset, queries, updates);
+    }
+
+    if (!paths.isEmpty()) {
+        RFontList::uninit();
+        RPatternListMetric::uninit();
+        RPatternListImperial::uninit();
+    }
+
+    delete app;
+
+    return failed==0 ? 0 : 1;
+}
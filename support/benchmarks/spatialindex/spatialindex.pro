@@ -0,0 +1,9 @@
+include(../../../shared_app.pri)
+
+TEMPLATE = app
+TARGET = spatialindex_benchmark
+CONFIG += console
+CONFIG -= app_bundle
+DEPENDPATH += .
+
+SOURCES += main.cpp
@@ -1,4 +1,5 @@
 include (../shared.pri)
 TEMPLATE = subdirs
 SUBDIRS = \
+    benchmarks \
     examples